@@ -0,0 +1,121 @@
+#include "analytical_approximation.h"
+#include "distribution.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace QS = QueueingSystem;
+
+namespace
+{
+    struct Moments
+    {
+        double mean{};
+        double squaredVariation{};
+    };
+
+    Moments getMoments(const QS::Distribution& distribution)
+    {
+        double mean{ distribution.getMean() };
+        return Moments{ mean, mean > 0.0 ? distribution.getVariance() / (mean * mean) : 1.0 };
+    }
+
+    // Sum of ratio^k over k = 0..count for a real count
+    double getGeometricSum(double ratio, double count)
+    {
+        if (std::abs(ratio - 1.0) < 1e-9)
+            return count + 1.0;
+        return -std::expm1((count + 1.0) * std::log(ratio)) / (1.0 - ratio);
+    }
+
+    // Merged stream of the sources: the rate adds up, the variability follows
+    // Whitt's hybrid of the asymptotic and the Poisson values
+    Moments getArrivalMoments(const QS::SystemConfiguration& conf, double serviceMean)
+    {
+        if (conf.trace)
+        {
+            double duration{};
+            for (int sourceId{}; sourceId < conf.trace->getSourcesCount(); ++sourceId)
+                if (auto count{ conf.trace->getSourceRecordsCount(sourceId) })
+                    duration = std::max(duration, conf.trace->getArrivalTime(sourceId, count - 1));
+
+            auto recordsCount{ conf.trace->getRecordsCount() };
+            return Moments{ recordsCount && duration > 0.0 ? duration / recordsCount :
+                std::numeric_limits<double>::infinity(), 1.0 };
+        }
+
+        auto source{ conf.arrivalDistribution ? getMoments(*conf.arrivalDistribution) :
+            getMoments(QS::UniformDistribution{ 0.0, conf.distrRange }) };
+
+        double mean{ source.mean / conf.sourcesCount };
+        double utilization{ std::min(serviceMean / (mean * conf.devicesCount), 1.0) };
+        double weight{ 1.0 / (1.0 + 4.0 * (1.0 - utilization) * (1.0 - utilization) * (conf.sourcesCount - 1)) };
+
+        return Moments{ mean, weight * source.squaredVariation + 1.0 - weight };
+    }
+}
+
+double QS::getMmckRejectionProbability(int devicesCount, double capacity, double offeredLoad)
+{
+    if (offeredLoad <= 0.0)
+        return 0.0;
+
+    // Erlang B recursion gives p_0..p_c-1 relative to p_c without overflow
+    double erlangB{ 1.0 };
+    for (int n{ 1 }; n <= devicesCount; ++n)
+        erlangB = offeredLoad * erlangB / (n + offeredLoad * erlangB);
+
+    double utilization{ offeredLoad / devicesCount };
+    double belowQueue{ 1.0 / erlangB - 1.0 };
+
+    // p_(c+k) = p_c * utilization^k, divided through by the largest term
+    if (utilization <= 1.0)
+        return std::pow(utilization, capacity) / (belowQueue + getGeometricSum(utilization, capacity));
+    return 1.0 / (belowQueue * std::pow(utilization, -capacity) + getGeometricSum(1.0 / utilization, capacity));
+}
+
+QS::ApproximateStats QS::approximateSystem(const SystemConfiguration& conf)
+{
+    auto service{ conf.serviceDistribution ? getMoments(*conf.serviceDistribution) :
+        getMoments(ShiftedExponentialDistribution{ MIN_PROCESSING_TIME, conf.lambda }) };
+    auto arrival{ getArrivalMoments(conf, service.mean) };
+
+    double offeredLoad{ service.mean / arrival.mean };
+    double utilization{ offeredLoad / conf.devicesCount };
+    double variability{ (arrival.squaredVariation + service.squaredVariation) / 2.0 };
+    double capacity{ variability > 0.0 ? conf.bufferSize / variability : std::numeric_limits<double>::infinity() };
+
+    double rejectionProbability{};
+    if (std::isinf(capacity))
+        rejectionProbability = std::max(0.0, 1.0 - 1.0 / utilization);
+    else
+        rejectionProbability = getMmckRejectionProbability(conf.devicesCount, capacity, offeredLoad);
+
+    // A run of requestsLimit arrivals starts empty: the buffer first fills
+    // with the drift of the excess arrivals and the spread of both streams,
+    // no rejections are made meanwhile
+    double arrivalRate{ 1.0 / arrival.mean };
+    double horizon{ QS::getConfRequestsLimit(conf) * arrival.mean };
+    double drift{ std::max(arrivalRate * (1.0 - 1.0 / utilization), 0.0) };
+    double spread{ arrivalRate * 2.0 * variability };
+    double fillTime{ conf.bufferSize / (drift + spread / std::max(conf.bufferSize, 1)) };
+    rejectionProbability *= 1.0 - std::min(fillTime / horizon, 1.0);
+
+    // The run lasts until the buffer left at the last arrival is served and
+    // the last of the busy devices is done
+    double endQueue{ std::min(drift * horizon, static_cast<double>(conf.bufferSize)) };
+    double lastDevices{ std::min(static_cast<double>(conf.devicesCount), offeredLoad) };
+    double harmonic{};
+    for (int n{ 1 }; n <= static_cast<int>(std::ceil(lastDevices)); ++n)
+        harmonic += 1.0 / n;
+    double drainTime{ endQueue * service.mean / conf.devicesCount +
+        service.mean + std::sqrt(service.squaredVariation) * service.mean * (harmonic - 1.0) };
+
+    double busyTime{ utilization * (1.0 - rejectionProbability) * horizon };
+    return ApproximateStats{
+        rejectionProbability,
+        std::min(busyTime / (horizon + drainTime), 1.0),
+        utilization
+    };
+}
@@ -0,0 +1,28 @@
+#ifndef ANALYTICAL_APPROXIMATION_H
+#define ANALYTICAL_APPROXIMATION_H
+
+#include "queueing_system.h"
+
+namespace QueueingSystem
+{
+    struct ApproximateStats
+    {
+        double rejectionProbability{};
+        double workload{};
+        // Offered load per device, arrival rate times mean service time over devicesCount
+        double utilization{};
+    };
+
+    // Probability that the last of capacity waiting places is taken in
+    // M/M/devicesCount/(devicesCount + capacity) with offered load (arrival rate
+    // times mean service time); capacity need not be whole.
+    double getMmckRejectionProbability(int devicesCount, double capacity, double offeredLoad);
+
+    // M/G/c/K approximation of the system in microseconds: the sources merge
+    // into one stream with Whitt's hybrid variability, and the buffer is scaled
+    // by 2 / (ca^2 + cs^2), as the heavy-traffic queue length grows with the
+    // squared coefficients of variation of arrivals and service.
+    ApproximateStats approximateSystem(const SystemConfiguration& conf);
+}
+
+#endif
@@ -0,0 +1,395 @@
+#ifndef BASIC_QUEUEING_SYSTEM_H
+#define BASIC_QUEUEING_SYSTEM_H
+
+#include "queueing_system.h"
+#include "engine_policies.h"
+#include "output_analysis.h"
+#include "engine_observer.h"
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <cstdint>
+
+namespace QueueingSystem
+{
+    // Event loop of QueueingSystem with the model fixed at compile time. Entities
+    // are kept as plain arrays so that a batch run is a single inlined loop;
+    // idle devices have NO_EVENT_TIME as their end time. The next service end
+    // is found by a scan, or by a binary heap for any conf.eventSet other than
+    // linear. The observer gets the events of every request, see NullObserver.
+    template <class ArrivalPolicy, class ServicePolicy, class BufferPolicy, class DispatchPolicy,
+        class Observer = NullObserver>
+    class BasicQueueingSystem
+    {
+    public:
+        explicit BasicQueueingSystem(const SystemConfiguration& conf, Observer observer = {}):
+            observer_(std::move(observer))
+        {
+            reset(conf);
+        }
+
+        Observer& getObserver()
+        {
+            return observer_;
+        }
+
+        const Observer& getObserver() const
+        {
+            return observer_;
+        }
+
+        SystemFinalStats getSystemFinalStats() const
+        {
+            double rejectionProbability{ static_cast<double>(rejectionsCount_) / requestsCount_ };
+
+            SystemFinalStats finalStats{};
+            for (const auto& sourceStats : sourcesStats_)
+                finalStats.sourcesFinalStats.push_back(getSourceFinalStats(getCurrent(sourceStats)));
+
+            double workload{};
+            for (const auto& stats : devicesStats_)
+            {
+                const auto& deviceStats{ getCurrent(stats) };
+                auto deviceFinalStats{ std::make_unique<DeviceFinalStats>() };
+                deviceFinalStats->requestsCount = deviceStats.requestsCount;
+                deviceFinalStats->averageServiceTime = deviceStats.serviceTime / deviceStats.requestsCount;
+                deviceFinalStats->utilizationFactor = deviceStats.serviceTime / implTime_;
+                workload += deviceFinalStats->utilizationFactor;
+                finalStats.deviceFinalStats.push_back(std::move(deviceFinalStats));
+            }
+
+            finalStats.rejectionProbability = rejectionProbability;
+            finalStats.workload = workload / devicesStats_.size();
+            finalStats.requiredRequestsCount = static_cast<int>((1.643 * 1.643 * (1 - rejectionProbability)) /
+                (rejectionProbability * 0.1 * 0.1));
+            finalStats.rejectionEstimate = rejectionSeries_.getEstimate();
+            finalStats.waitingTimeEstimate = waitingTimeSeries_.getEstimate();
+            for (const auto& sourceFinalStats : finalStats.sourcesFinalStats)
+            {
+                finalStats.waitingTimeHistogram.merge(sourceFinalStats->waitingTimeHistogram);
+                finalStats.sojournTimeHistogram.merge(sourceFinalStats->sojournTimeHistogram);
+            }
+
+            return finalStats;
+        }
+
+        int getRequestsLimit() const
+        {
+            return requestsLimit_;
+        }
+
+        int getRequestsCount() const
+        {
+            return requestsCount_;
+        }
+
+        long long getRejectionsCount() const
+        {
+            return rejectionsCount_;
+        }
+
+        // Mean utilization of the devices up to the last event
+        double getWorkload() const
+        {
+            if (implTime_ <= 0.0)
+                return 0.0;
+
+            double serviceTime{};
+            for (const auto& stats : devicesStats_)
+                serviceTime += getCurrent(stats).serviceTime;
+            return serviceTime / (implTime_ * devicesStats_.size());
+        }
+
+        int getBufferOccupancy() const
+        {
+            return buffer_.getOccupancy();
+        }
+
+        // A copy of a running system continues with the same random streams,
+        // reseeding makes it an independent continuation of the same state
+        void reseed(std::mt19937& seeder)
+        {
+            arrival_.reseed(seeder);
+            service_.reseed(seeder);
+        }
+
+        void reset()
+        {
+            reset(conf_);
+        }
+
+        // Touches only what the new configuration changes: a finished run
+        // leaves every device idle, processing times are written before they
+        // are read and the entity stats are cleared lazily by epoch
+        void reset(const SystemConfiguration& conf)
+        {
+            conf_ = conf;
+            requestsLimit_ = conf.requestsLimit;
+            requestsCount_ = 0;
+            rejectionsCount_ = 0;
+            implTime_ = 0.0;
+            precisionReached_ = false;
+
+            arrival_.reset(conf);
+            service_.reset(conf);
+            buffer_.reset(conf);
+            dispatch_.reset(conf);
+
+            if (!drained_)
+                std::fill(devicesEndTime_.begin(), devicesEndTime_.end(), NO_EVENT_TIME);
+            devicesEndTime_.resize(conf.devicesCount, NO_EVENT_TIME);
+            deviceHeap_ = conf.eventSet != EventSetType::linear;
+            if (deviceHeap_)
+                deviceEvents_.resize(conf.devicesCount);
+            devicesProcessingTime_.resize(conf.devicesCount);
+            devicesSourceId_.resize(conf.devicesCount);
+            if constexpr (needsCompletedRequest<Observer>)
+                devicesRequest_.resize(conf.devicesCount);
+            drained_ = false;
+
+            ++epoch_;
+            sourcesStats_.resize(conf.sourcesCount);
+            devicesStats_.resize(conf.devicesCount);
+            rejectionSeries_.reset();
+            waitingTimeSeries_.reset();
+        }
+
+        // Capacity for the largest configuration a sweep is going to reach
+        void reserve(const SystemConfiguration& conf)
+        {
+            devicesEndTime_.reserve(conf.devicesCount);
+            devicesProcessingTime_.reserve(conf.devicesCount);
+            devicesSourceId_.reserve(conf.devicesCount);
+            if constexpr (needsCompletedRequest<Observer>)
+                devicesRequest_.reserve(conf.devicesCount);
+            sourcesStats_.reserve(conf.sourcesCount);
+            devicesStats_.reserve(conf.devicesCount);
+        }
+
+        bool makeStep()
+        {
+            int nextDevice{ deviceHeap_ ? deviceEvents_.getNextIndex() :
+                static_cast<int>(std::min_element(devicesEndTime_.cbegin(), devicesEndTime_.cend()) -
+                    devicesEndTime_.cbegin()) };
+            double nextDeviceTime{ nextDevice == NO_EVENT ? NO_EVENT_TIME : devicesEndTime_[nextDevice] };
+
+            if (requestsCount_ >= requestsLimit_ || precisionReached_)
+            {
+                if (nextDeviceTime == NO_EVENT_TIME)
+                {
+                    drained_ = true;
+                    return false;
+                }
+
+                implTime_ = nextDeviceTime;
+                processDeviceEvent(nextDevice, nextDeviceTime);
+            }
+            else
+            {
+                int nextSource{ arrival_.getNextSource() };
+                double nextSourceTime{ arrival_.getNextGenerationTime(nextSource) };
+
+                if (nextSourceTime < nextDeviceTime)
+                {
+                    implTime_ = nextSourceTime;
+                    processSourceEvent(nextSource, nextSourceTime);
+                }
+                else
+                {
+                    implTime_ = nextDeviceTime;
+                    processDeviceEvent(nextDevice, nextDeviceTime);
+                }
+            }
+            return true;
+        }
+
+        void run()
+        {
+            while (makeStep());
+        }
+
+    private:
+        // Stats with another epoch belong to an earlier run
+        struct SourceStats
+        {
+            std::uint64_t epoch{};
+            int requestsCount{};
+            int rejectionsCount{};
+            TimeStats bufferTime{};
+            TimeStats serviceTime{};
+            LatencyHistogram waitingTime{};
+            LatencyHistogram sojournTime{};
+        };
+
+        struct DeviceStats
+        {
+            std::uint64_t epoch{};
+            int requestsCount{};
+            double serviceTime{};
+        };
+
+        template <class Stats>
+        Stats& getCurrent(Stats& stats)
+        {
+            if (stats.epoch != epoch_)
+                stats = Stats{ epoch_ };
+            return stats;
+        }
+
+        template <class Stats>
+        const Stats& getCurrent(const Stats& stats) const
+        {
+            static const Stats cleared{};
+            return stats.epoch == epoch_ ? stats : cleared;
+        }
+
+        void processSourceEvent(int sourceId, double time)
+        {
+            auto& sourceStats{ getCurrent(sourcesStats_[sourceId]) };
+            Request request{ RequestId{ sourceId, sourceStats.requestsCount++ }, arrival_.generate(sourceId) };
+
+            ++requestsCount_;
+            observer_.onArrival(request, time);
+
+            Request rejectedRequest{};
+            bool placed{ buffer_.placeRequest(request, rejectedRequest) };
+            if (!placed)
+            {
+                ++getCurrent(sourcesStats_[rejectedRequest.id.sourceId]).rejectionsCount;
+                ++rejectionsCount_;
+                observer_.onEviction(rejectedRequest, time);
+            }
+            // A full buffer may reject the new request itself
+            if (placed || rejectedRequest.id.sourceId != request.id.sourceId ||
+                rejectedRequest.id.serialNumber != request.id.serialNumber)
+                observer_.onBufferInsert(request, time);
+            rejectionSeries_.add(placed ? 0.0 : 1.0);
+
+            if (conf_.targetPrecision > 0.0 && requestsCount_ % PRECISION_CHECK_PERIOD == 0)
+                precisionReached_ = isPrecise(rejectionSeries_.getEstimate(), conf_.targetPrecision);
+
+            tryProcessRequest(time);
+        }
+
+        void processDeviceEvent(int deviceId, double time)
+        {
+            double processingTime{ devicesProcessingTime_[deviceId] };
+
+            auto& deviceStats{ getCurrent(devicesStats_[deviceId]) };
+            ++deviceStats.requestsCount;
+            deviceStats.serviceTime += processingTime;
+            getCurrent(sourcesStats_[devicesSourceId_[deviceId]]).serviceTime.add(processingTime);
+            if constexpr (needsCompletedRequest<Observer>)
+                observer_.onServiceCompletion(devicesRequest_[deviceId], deviceId, time - processingTime, time);
+
+            setDeviceEndTime(deviceId, NO_EVENT_TIME);
+
+            if (!buffer_.isEmpty())
+                tryProcessRequest(time);
+        }
+
+        void tryProcessRequest(double startTime)
+        {
+            if (int freeDeviceIndex{ dispatch_.selectDevice(devicesEndTime_) };
+                freeDeviceIndex != static_cast<int>(devicesEndTime_.size()))
+            {
+                auto request{ buffer_.selectRequest() };
+                auto& sourceStats{ getCurrent(sourcesStats_[request.id.sourceId]) };
+
+                if (startTime != request.generationTime)
+                    sourceStats.bufferTime.add(startTime - request.generationTime);
+                waitingTimeSeries_.add(startTime - request.generationTime);
+                sourceStats.waitingTime.record(startTime - request.generationTime);
+
+                // Every service started ends before the run does, so the
+                // sojourn time is known already
+                double processingTime{ service_.getProcessingTime(freeDeviceIndex) };
+                sourceStats.sojournTime.record(startTime + processingTime - request.generationTime);
+                devicesProcessingTime_[freeDeviceIndex] = processingTime;
+                setDeviceEndTime(freeDeviceIndex, startTime + processingTime);
+                devicesSourceId_[freeDeviceIndex] = request.id.sourceId;
+                if constexpr (needsCompletedRequest<Observer>)
+                    devicesRequest_[freeDeviceIndex] = request;
+                observer_.onDispatch(request, freeDeviceIndex, startTime, startTime + processingTime);
+            }
+        }
+
+        void setDeviceEndTime(int deviceId, double time)
+        {
+            devicesEndTime_[deviceId] = time;
+            if (deviceHeap_)
+                deviceEvents_.update(deviceId, time);
+        }
+
+        USourceFinalStats getSourceFinalStats(const SourceStats& sourceStats) const
+        {
+            auto sourceFinalStats{ std::make_unique<SourceFinalStats>() };
+            int servedCount{ sourceStats.requestsCount - sourceStats.rejectionsCount };
+
+            sourceFinalStats->requestsCount = sourceStats.requestsCount;
+            sourceFinalStats->rejectionProbability = static_cast<double>(sourceStats.rejectionsCount) /
+                sourceStats.requestsCount;
+            sourceFinalStats->averageBufferTime = sourceStats.bufferTime.sum / servedCount;
+            sourceFinalStats->averageServiceTime = sourceStats.serviceTime.sum / servedCount;
+            sourceFinalStats->averageProcessingTime = sourceFinalStats->averageBufferTime +
+                sourceFinalStats->averageServiceTime;
+            sourceFinalStats->bufferTimeDispersion = sourceStats.bufferTime.getDispersion(
+                sourceFinalStats->averageBufferTime);
+            sourceFinalStats->serviceTimeDispersion = sourceStats.serviceTime.getDispersion(
+                sourceFinalStats->averageServiceTime);
+            sourceFinalStats->waitingTimeHistogram = sourceStats.waitingTime;
+            sourceFinalStats->sojournTimeHistogram = sourceStats.sojournTime;
+
+            return sourceFinalStats;
+        }
+
+        SystemConfiguration conf_{};
+        // Takes no space when empty, MSVC only honours its own spelling
+#ifdef _MSC_VER
+        [[msvc::no_unique_address]]
+#else
+        [[no_unique_address]]
+#endif
+        Observer observer_;
+        ArrivalPolicy arrival_{};
+        ServicePolicy service_{};
+        BufferPolicy buffer_{};
+        DispatchPolicy dispatch_{};
+
+        std::vector<double> devicesEndTime_;
+        // Thousands of devices are better found in a heap than by a scan
+        BinaryHeapEventSet deviceEvents_{ 0 };
+        bool deviceHeap_{};
+        std::vector<double> devicesProcessingTime_;
+        std::vector<int> devicesSourceId_;
+        // Left empty unless the observer needs the completed requests
+        std::vector<Request> devicesRequest_;
+
+        std::vector<SourceStats> sourcesStats_;
+        std::vector<DeviceStats> devicesStats_;
+        BatchedSeries rejectionSeries_{};
+        BatchedSeries waitingTimeSeries_{};
+
+        int requestsCount_{};
+        long long rejectionsCount_{};
+        int requestsLimit_{};
+        double implTime_{};
+        bool precisionReached_{};
+        bool drained_{};
+        std::uint64_t epoch_{};
+    };
+
+    using DefaultQueueingSystem = BasicQueueingSystem<UniformArrivalPolicy,
+        ShiftedExponentialServicePolicy, SourcePriorityBufferPolicy, RoundRobinDispatchPolicy>;
+
+    using DistributionQueueingSystem = BasicQueueingSystem<DistributionArrivalPolicy,
+        DistributionServicePolicy, SourcePriorityBufferPolicy, RoundRobinDispatchPolicy>;
+
+    using EntityStreamQueueingSystem = BasicQueueingSystem<EntityStreamArrivalPolicy,
+        EntityStreamServicePolicy, SourcePriorityBufferPolicy, RoundRobinDispatchPolicy>;
+}
+
+#endif
@@ -67,17 +67,55 @@ bool QS::Buffer::isRequestsBufferEmpty() const
     return !bufferIndex_;
 }
 
+int QS::Buffer::getOccupancy() const
+{
+    return bufferIndex_;
+}
+
 void QS::Buffer::reset()
 {
+    // Requests occupy the positions before bufferIndex_, selection rotates
+    // the emptied position past them
+    for (int i{}; i < bufferIndex_; ++i)
+        requestsBuffer_[i].reset();
     bufferIndex_ = 0;
-    for (auto& position : requestsBuffer_)
-        position.reset();
     lastRejectedRequest_.reset();
 }
 
 void QS::Buffer::reset(int newSize)
 {
+    reset();
     bufferSize_ = newSize;
     requestsBuffer_.resize(newSize);
-    reset();
+}
+
+void QS::Buffer::reserve(int capacity)
+{
+    requestsBuffer_.reserve(capacity);
+}
+
+std::vector<QS::Request> QS::Buffer::getState() const
+{
+    std::vector<Request> requests{};
+    requests.reserve(bufferIndex_);
+    for (int i{}; i < bufferIndex_; ++i)
+        requests.push_back(*requestsBuffer_[i]);
+    return requests;
+}
+
+void QS::Buffer::restore(const std::vector<Request>& requests)
+{
+    int requestsCount{ static_cast<int>(requests.size()) };
+    for (int i{ requestsCount }; i < bufferIndex_; ++i)
+        requestsBuffer_[i].reset();
+
+    for (int i{}; i < requestsCount; ++i)
+    {
+        if (requestsBuffer_[i])
+            *requestsBuffer_[i] = requests[i];
+        else
+            requestsBuffer_[i] = std::make_unique<Request>(requests[i]);
+    }
+    bufferIndex_ = requestsCount;
+    lastRejectedRequest_.reset();
 }
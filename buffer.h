@@ -20,9 +20,16 @@ namespace QueueingSystem
 
         URequest getLastRejectedRequest();
         bool isRequestsBufferEmpty() const;
+        int getOccupancy() const;
 
+        // Only the occupied positions are cleared, the rest stay empty
         void reset();
         void reset(int newSize);
+        void reserve(int capacity);
+
+        // Requests in their positions, the size is the same on restore
+        std::vector<Request> getState() const;
+        void restore(const std::vector<Request>& requests);
 
     private:
         int bufferSize_;
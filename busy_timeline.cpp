@@ -0,0 +1,179 @@
+#include "busy_timeline.h"
+
+#include <algorithm>
+
+namespace QS = QueueingSystem;
+
+void QS::BusyTimeline::reset(int devicesCount)
+{
+    busyPeriods_.resize(devicesCount);
+    for (auto& periods : busyPeriods_)
+        periods.clear();
+
+    occupancyChanges_.clear();
+    occupancyChanges_.push_back(OccupancyChange{});
+    levels_.clear();
+    periodsCount_ = 0;
+    endTime_ = 0.0;
+}
+
+void QS::BusyTimeline::addBusyPeriod(int deviceId, double start, double end)
+{
+    BusyPeriod period{ start, end };
+    busyPeriods_[deviceId].push_back(period);
+    ++periodsCount_;
+    endTime_ = std::max(endTime_, end);
+
+    if (!levels_.empty())
+        addToLevels(deviceId, period);
+    else if (periodsCount_ == BUSY_TIMELINE_SAMPLE_SIZE)
+        buildLevels();
+}
+
+void QS::BusyTimeline::addBufferOccupancy(double time, int occupancy)
+{
+    int previousOccupancy{ occupancyChanges_.back().occupancy };
+    if (occupancy == previousOccupancy)
+        return;
+
+    OccupancyChange change{ time, occupancy };
+    occupancyChanges_.push_back(change);
+    endTime_ = std::max(endTime_, time);
+
+    if (!levels_.empty())
+        addToLevels(change, previousOccupancy);
+}
+
+int QS::BusyTimeline::getDevicesCount() const
+{
+    return static_cast<int>(busyPeriods_.size());
+}
+
+double QS::BusyTimeline::getEndTime() const
+{
+    return endTime_;
+}
+
+int QS::BusyTimeline::getLevel(double maxWidth) const
+{
+    for (int level{ static_cast<int>(levels_.size()) - 1 }; level >= 0; --level)
+        if (levels_[level].bucketWidth <= maxWidth)
+            return level;
+    return -1;
+}
+
+double QS::BusyTimeline::getBucketWidth(int level) const
+{
+    return levels_[level].bucketWidth;
+}
+
+int QS::BusyTimeline::getBucketsCount(int level) const
+{
+    return static_cast<int>(endTime_ / levels_[level].bucketWidth) + 1;
+}
+
+const std::vector<float>& QS::BusyTimeline::getBusyFractions(int level, int deviceId) const
+{
+    return levels_[level].busyFractions[deviceId];
+}
+
+const std::vector<QS::BusyTimeline::OccupancyRange>& QS::BusyTimeline::getOccupancyRanges(int level) const
+{
+    return levels_[level].occupancyRanges;
+}
+
+std::pair<const QS::BusyTimeline::BusyPeriod*, const QS::BusyTimeline::BusyPeriod*>
+QS::BusyTimeline::getBusyPeriods(int deviceId, double from, double to) const
+{
+    // Periods of a device do not overlap, so the ends are in order as well
+    const auto& periods{ busyPeriods_[deviceId] };
+    auto first{ std::partition_point(periods.cbegin(), periods.cend(),
+        [from](const BusyPeriod& period)
+        {
+            return period.end <= from;
+        }) };
+    auto last{ std::partition_point(first, periods.cend(),
+        [to](const BusyPeriod& period)
+        {
+            return period.start < to;
+        }) };
+    return { periods.data() + (first - periods.cbegin()), periods.data() + (last - periods.cbegin()) };
+}
+
+std::pair<const QS::BusyTimeline::OccupancyChange*, const QS::BusyTimeline::OccupancyChange*>
+QS::BusyTimeline::getOccupancyChanges(double from, double to) const
+{
+    auto first{ std::partition_point(occupancyChanges_.cbegin() + 1, occupancyChanges_.cend(),
+        [from](const OccupancyChange& change)
+        {
+            return change.time <= from;
+        }) - 1 };
+    auto last{ std::partition_point(first + 1, occupancyChanges_.cend(),
+        [to](const OccupancyChange& change)
+        {
+            return change.time < to;
+        }) };
+    return { occupancyChanges_.data() + (first - occupancyChanges_.cbegin()),
+        occupancyChanges_.data() + (last - occupancyChanges_.cbegin()) };
+}
+
+void QS::BusyTimeline::buildLevels()
+{
+    // The finest buckets hold a few busy periods of the first ones seen
+    double busyTime{};
+    for (const auto& periods : busyPeriods_)
+        for (const auto& period : periods)
+            busyTime += period.end - period.start;
+    double bucketWidth{ busyTime > 0.0 ?
+        busyTime / periodsCount_ * BUSY_TIMELINE_PERIODS_PER_BUCKET : 1.0 };
+
+    levels_.resize(BUSY_TIMELINE_LEVELS_COUNT);
+    for (auto& level : levels_)
+    {
+        level.bucketWidth = bucketWidth;
+        level.busyFractions.assign(busyPeriods_.size(), std::vector<float>{});
+        bucketWidth *= BUSY_TIMELINE_FANOUT;
+    }
+
+    for (std::size_t deviceId{ 0 }; deviceId < busyPeriods_.size(); ++deviceId)
+        for (const auto& period : busyPeriods_[deviceId])
+            addToLevels(static_cast<int>(deviceId), period);
+
+    for (std::size_t i{ 1 }; i < occupancyChanges_.size(); ++i)
+        addToLevels(occupancyChanges_[i], occupancyChanges_[i - 1].occupancy);
+}
+
+void QS::BusyTimeline::addToLevels(int deviceId, const BusyPeriod& period)
+{
+    for (auto& level : levels_)
+    {
+        auto& fractions{ level.busyFractions[deviceId] };
+        double width{ level.bucketWidth };
+        auto first{ static_cast<std::size_t>(period.start / width) };
+        auto last{ static_cast<std::size_t>(period.end / width) };
+        if (fractions.size() <= last)
+            fractions.resize(last + 1);
+
+        for (auto bucket{ first }; bucket <= last; ++bucket)
+        {
+            double overlap{ std::min(period.end, (bucket + 1) * width) -
+                std::max(period.start, bucket * width) };
+            fractions[bucket] += static_cast<float>(overlap / width);
+        }
+    }
+}
+
+void QS::BusyTimeline::addToLevels(const OccupancyChange& change, int previousOccupancy)
+{
+    for (auto& level : levels_)
+    {
+        // The buckets up to the change had the previous occupancy throughout
+        auto& ranges{ level.occupancyRanges };
+        auto bucket{ static_cast<std::size_t>(change.time / level.bucketWidth) };
+        while (ranges.size() <= bucket)
+            ranges.push_back(OccupancyRange{ previousOccupancy, previousOccupancy });
+
+        ranges[bucket].min = std::min(ranges[bucket].min, change.occupancy);
+        ranges[bucket].max = std::max(ranges[bucket].max, change.occupancy);
+    }
+}
@@ -0,0 +1,88 @@
+#ifndef BUSY_TIMELINE_H
+#define BUSY_TIMELINE_H
+
+#include <vector>
+#include <utility>
+
+namespace QueueingSystem
+{
+    inline constexpr int BUSY_TIMELINE_LEVELS_COUNT{ 8 };
+    // Buckets of a level merged into one of the next
+    inline constexpr int BUSY_TIMELINE_FANOUT{ 8 };
+    // Busy periods looked at before the bucket width is chosen
+    inline constexpr int BUSY_TIMELINE_SAMPLE_SIZE{ 64 };
+    // Mean busy periods per bucket of the finest level
+    inline constexpr double BUSY_TIMELINE_PERIODS_PER_BUCKET{ 4.0 };
+
+    // Busy periods of the devices and occupancy of the buffer over the model
+    // time, filled as the run goes. Next to the periods themselves it keeps a
+    // pyramid of time buckets: the busy fraction of every device and the
+    // occupancy range in a bucket, the buckets of every level FANOUT times
+    // wider than those of the one below. A view takes the level whose buckets
+    // are about a pixel wide, so drawing costs the same at any run length.
+    class BusyTimeline
+    {
+    public:
+        struct BusyPeriod
+        {
+            double start{};
+            double end{};
+        };
+
+        struct OccupancyChange
+        {
+            double time{};
+            int occupancy{};
+        };
+
+        struct OccupancyRange
+        {
+            int min{};
+            int max{};
+        };
+
+        void reset(int devicesCount);
+
+        // A device serves one request at a time, so its periods come in order
+        void addBusyPeriod(int deviceId, double start, double end);
+        void addBufferOccupancy(double time, int occupancy);
+
+        int getDevicesCount() const;
+        double getEndTime() const;
+
+        // Coarsest level with buckets not wider than maxWidth, -1 when even
+        // the finest ones are wider and the periods have to be drawn as they are
+        int getLevel(double maxWidth) const;
+        double getBucketWidth(int level) const;
+        int getBucketsCount(int level) const;
+
+        // Share of the bucket the device was busy for
+        const std::vector<float>& getBusyFractions(int level, int deviceId) const;
+        const std::vector<OccupancyRange>& getOccupancyRanges(int level) const;
+
+        // Periods overlapping [from, to)
+        std::pair<const BusyPeriod*, const BusyPeriod*> getBusyPeriods(int deviceId, double from, double to) const;
+        // Changes in [from, to) and the one in force at from
+        std::pair<const OccupancyChange*, const OccupancyChange*> getOccupancyChanges(double from, double to) const;
+
+    private:
+        struct Level
+        {
+            double bucketWidth{};
+            std::vector<std::vector<float>> busyFractions{};
+            std::vector<OccupancyRange> occupancyRanges{};
+        };
+
+        void buildLevels();
+        void addToLevels(int deviceId, const BusyPeriod& period);
+        void addToLevels(const OccupancyChange& change, int previousOccupancy);
+
+        std::vector<std::vector<BusyPeriod>> busyPeriods_;
+        std::vector<OccupancyChange> occupancyChanges_;
+        std::vector<Level> levels_;
+        int periodsCount_{};
+        double endTime_{};
+    };
+}
+
+#endif
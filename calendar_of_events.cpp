@@ -5,39 +5,26 @@
 namespace QS = QueueingSystem;
 
 QS::CalendarOfEvents::CalendarOfEvents(const std::vector<USource>& sources,
-    const std::vector<UDevice>& devices):
-    sourcesEventTime_(sources.size()),
-    devicesEventTime_(devices.size())
+    const std::vector<UDevice>& devices, EventSetType eventSetType):
+    sourcesEvents_(makeEventSet(eventSetType, static_cast<int>(sources.size()))),
+    devicesEvents_(makeEventSet(eventSetType, static_cast<int>(devices.size())))
 {
-    for (int i{}; i < sources.size(); ++i)
-        sourcesEventTime_[i] = sources[i]->getNextGenerationTimePtr();
-
-    for (int i{}; i < devices.size(); ++i)
-        devicesEventTime_[i] = devices[i]->getProcessingEndTimePtr();
+    resize(sources, devices);
+    reset();
 }
 
-QS::EventConstIter QS::CalendarOfEvents::getNextEvent(EventType eventType) const
+QS::EventConstIter QS::CalendarOfEvents::getNextEvent(EventType eventType)
 {
     if (eventType == EventType::sourceEvent)
-        return std::min_element(
-            sourcesEventTime_.cbegin(), sourcesEventTime_.cend(),
-            [](const auto& left, const auto& right)
-            {
-                return *left < *right;
-            });
+    {
+        int index{ sourcesEvents_->getNextIndex() };
+        return sourcesEventTime_.cbegin() + (index != NO_EVENT ? index : 0);
+    }
     else //EventType::deviceEvent
     {
-        return std::min_element(
-            devicesEventTime_.cbegin(), devicesEventTime_.cend(),
-            [](const auto& left, const auto& right)
-            {
-                if (*left < 0.0)
-                    return false;
-                else if (*right < 0.0)
-                    return true;
-                else
-                    return *left < *right;
-            });
+        // All the devices are idle without an event, the first one stands for them
+        int index{ devicesEvents_->getNextIndex() };
+        return devicesEventTime_.cbegin() + (index != NO_EVENT ? index : 0);
     }
 }
 
@@ -51,17 +38,64 @@ int QS::CalendarOfEvents::getEventIndex(const EventConstIter& eventIter, EventTy
 
 int QS::CalendarOfEvents::getFreeDeviceIndex(int deviceIndex) const
 {
-    auto devicesStatusBegin = devicesEventTime_.cbegin();
-    auto isDeviceFree = [](const double* status) { return *status < 0.0; };
+    int devicesCount{ static_cast<int>(devicesEventTime_.size()) };
+
+    if (int freeDeviceIndex{ findFreeDevice(deviceIndex, devicesCount) }; freeDeviceIndex != devicesCount)
+        return freeDeviceIndex;
+
+    int freeDeviceIndex{ findFreeDevice(0, deviceIndex) };
+    return freeDeviceIndex != deviceIndex ? freeDeviceIndex : devicesCount;
+}
+
+void QS::CalendarOfEvents::update(EventType eventType, int index)
+{
+    if (eventType == EventType::sourceEvent)
+        sourcesEvents_->update(index, *sourcesEventTime_[index]);
+    else //EventType::deviceEvent
+    {
+        bool isFree{ *devicesEventTime_[index] < 0.0 };
+        devicesEvents_->update(index, isFree ? NO_EVENT_TIME : *devicesEventTime_[index]);
+
+        std::uint64_t bit{ std::uint64_t{ 1 } << (index % 64) };
+        if (isFree)
+            freeDevices_[index / 64] |= bit;
+        else
+            freeDevices_[index / 64] &= ~bit;
+    }
+}
+
+void QS::CalendarOfEvents::reset()
+{
+    sourcesEvents_->clear();
+    devicesEvents_->clear();
 
-    auto it = std::find_if(devicesStatusBegin + deviceIndex,
-        devicesEventTime_.cend(), isDeviceFree);
-    if (it != devicesEventTime_.end())
-        return it - devicesStatusBegin;
+    for (int i{}; i < sourcesEventTime_.size(); ++i)
+        update(EventType::sourceEvent, i);
 
-    it = std::find_if(devicesStatusBegin, devicesStatusBegin + deviceIndex, isDeviceFree);
-    return it - devicesStatusBegin != deviceIndex ?
-        it - devicesStatusBegin : devicesEventTime_.size();
+    for (int i{}; i < devicesEventTime_.size(); ++i)
+        update(EventType::deviceEvent, i);
+}
+
+void QS::CalendarOfEvents::reserve(int sourcesCount, int devicesCount)
+{
+    sourcesEventTime_.reserve(sourcesCount);
+    devicesEventTime_.reserve(devicesCount);
+    freeDevices_.reserve((devicesCount + 63) / 64);
+}
+
+void QS::CalendarOfEvents::resize(const std::vector<USource>& sources, const std::vector<UDevice>& devices)
+{
+    sourcesEventTime_.resize(sources.size());
+    for (int i{}; i < sources.size(); ++i)
+        sourcesEventTime_[i] = sources[i]->getNextGenerationTimePtr();
+
+    devicesEventTime_.resize(devices.size());
+    for (int i{}; i < devices.size(); ++i)
+        devicesEventTime_[i] = devices[i]->getProcessingEndTimePtr();
+
+    sourcesEvents_->resize(static_cast<int>(sources.size()));
+    devicesEvents_->resize(static_cast<int>(devices.size()));
+    freeDevices_.resize((devices.size() + 63) / 64);
 }
 
 std::vector<const double*> QueueingSystem::CalendarOfEvents::getSourcesEventTime() const
@@ -73,3 +107,26 @@ std::vector<const double*> QueueingSystem::CalendarOfEvents::getDevicesEventTime
 {
     return devicesEventTime_;
 }
+
+int QS::CalendarOfEvents::findFreeDevice(int begin, int end) const
+{
+    // Free devices are set bits, whole words of busy devices are skipped
+    int index{ begin };
+    while (index < end)
+    {
+        std::uint64_t word{ freeDevices_[index / 64] >> (index % 64) };
+        if (!word)
+        {
+            index = (index / 64 + 1) * 64;
+            continue;
+        }
+
+        while (!(word & 1))
+        {
+            word >>= 1;
+            ++index;
+        }
+        return std::min(index, end);
+    }
+    return end;
+}
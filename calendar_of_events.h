@@ -3,9 +3,11 @@
 
 #include "source.h"
 #include "device.h"
+#include "event_set.h"
 
 #include <vector>
 #include <memory>
+#include <cstdint>
 
 namespace QueueingSystem
 {
@@ -21,18 +23,31 @@ namespace QueueingSystem
     {
     public:
         CalendarOfEvents(const std::vector<USource>& sources,
-            const std::vector<UDevice>& devices);
+            const std::vector<UDevice>& devices, EventSetType eventSetType = EventSetType::linear);
 
-        EventConstIter getNextEvent(EventType eventType) const;
+        EventConstIter getNextEvent(EventType eventType);
         int getEventIndex(const EventConstIter& eventIter, EventType eventType) const;
         int getFreeDeviceIndex(int deviceIndex) const;
 
+        // Has to follow every change of the event time of a source or a device
+        void update(EventType eventType, int index);
+        void reset();
+
+        void reserve(int sourcesCount, int devicesCount);
+        // Takes the entities of a reconfigured system, reset() has to follow
+        void resize(const std::vector<USource>& sources, const std::vector<UDevice>& devices);
+
         std::vector<const double*> getSourcesEventTime() const;
         std::vector<const double*> getDevicesEventTime() const;
 
     private:
+        int findFreeDevice(int begin, int end) const;
+
         std::vector<const double*> sourcesEventTime_;
         std::vector<const double*> devicesEventTime_;
+        UEventSet sourcesEvents_;
+        UEventSet devicesEvents_;
+        std::vector<std::uint64_t> freeDevices_;
     };
 }
 
@@ -0,0 +1,170 @@
+#include "configuration_collectors.h"
+
+#include <algorithm>
+#include <numeric>
+#include <limits>
+
+namespace QS = QueueingSystem;
+
+namespace
+{
+    constexpr int OBJECTIVES_COUNT{ 3 };
+
+    // Objectives turned to minimization
+    double getObjective(const QS::SystemConfigurationStats& stats, int objective)
+    {
+        switch (objective)
+        {
+        case 0:
+            return stats.rejectionProbability;
+        case 1:
+            return -stats.workload;
+        default: //cost
+            return QS::getConfigurationCost(stats.conf);
+        }
+    }
+
+    // Equal points dominate each other, so a repeated one is not added twice
+    bool isDominatedBy(const QS::SystemConfigurationStats& point, const QS::SystemConfigurationStats& other)
+    {
+        for (int objective{}; objective < OBJECTIVES_COUNT; ++objective)
+            if (getObjective(other, objective) > getObjective(point, objective))
+                return false;
+        return true;
+    }
+}
+
+bool QS::isBetterConfiguration(const SystemConfigurationStats& left, const SystemConfigurationStats& right)
+{
+    return (left.workload > right.workload) ||
+        (left.workload == right.workload && left.conf.devicesCount < right.conf.devicesCount) ||
+        (left.workload == right.workload && left.conf.devicesCount == right.conf.devicesCount &&
+         left.conf.bufferSize < right.conf.bufferSize);
+}
+
+int QS::getConfigurationCost(const SystemConfiguration& conf)
+{
+    return conf.devicesCount + conf.bufferSize;
+}
+
+QS::TopConfigurations::TopConfigurations(std::size_t capacity):
+    capacity_(capacity)
+{
+    heap_.reserve(capacity);
+}
+
+void QS::TopConfigurations::add(const SystemConfigurationStats& stats)
+{
+    if (heap_.size() < capacity_)
+    {
+        heap_.push_back(stats);
+        std::push_heap(heap_.begin(), heap_.end(), isBetterConfiguration);
+    }
+    else if (capacity_ && isBetterConfiguration(stats, heap_.front()))
+    {
+        std::pop_heap(heap_.begin(), heap_.end(), isBetterConfiguration);
+        heap_.back() = stats;
+        std::push_heap(heap_.begin(), heap_.end(), isBetterConfiguration);
+    }
+}
+
+void QS::TopConfigurations::merge(const TopConfigurations& other)
+{
+    for (const auto& stats : other.heap_)
+        add(stats);
+}
+
+std::size_t QS::TopConfigurations::getSize() const
+{
+    return heap_.size();
+}
+
+std::vector<QS::SystemConfigurationStats> QS::TopConfigurations::getSorted() const
+{
+    auto sorted{ heap_ };
+    std::sort(sorted.begin(), sorted.end(), isBetterConfiguration);
+    return sorted;
+}
+
+QS::ParetoFrontier::ParetoFrontier(std::size_t capacity):
+    capacity_(capacity)
+{
+    points_.reserve(capacity + 1);
+    order_.reserve(capacity + 1);
+    crowding_.reserve(capacity + 1);
+}
+
+void QS::ParetoFrontier::add(const SystemConfigurationStats& stats)
+{
+    for (const auto& point : points_)
+        if (isDominatedBy(stats, point))
+            return;
+
+    points_.erase(std::remove_if(points_.begin(), points_.end(),
+        [&stats](const SystemConfigurationStats& point)
+        {
+            return isDominatedBy(point, stats);
+        }), points_.end());
+
+    points_.push_back(stats);
+    if (points_.size() > capacity_)
+        thin();
+}
+
+void QS::ParetoFrontier::merge(const ParetoFrontier& other)
+{
+    for (const auto& stats : other.points_)
+        add(stats);
+}
+
+std::size_t QS::ParetoFrontier::getSize() const
+{
+    return points_.size();
+}
+
+std::vector<QS::SystemConfigurationStats> QS::ParetoFrontier::getSorted() const
+{
+    auto sorted{ points_ };
+    std::sort(sorted.begin(), sorted.end(),
+        [](const SystemConfigurationStats& left, const SystemConfigurationStats& right)
+        {
+            int leftCost{ getConfigurationCost(left.conf) };
+            int rightCost{ getConfigurationCost(right.conf) };
+            return leftCost < rightCost || (leftCost == rightCost && isBetterConfiguration(left, right));
+        });
+    return sorted;
+}
+
+void QS::ParetoFrontier::thin()
+{
+    // Crowding distance: the sum over the objectives of the normalized gap
+    // between the neighbours on both sides
+    order_.resize(points_.size());
+    crowding_.assign(points_.size(), 0.0);
+
+    for (int objective{}; objective < OBJECTIVES_COUNT; ++objective)
+    {
+        std::iota(order_.begin(), order_.end(), 0);
+        std::sort(order_.begin(), order_.end(),
+            [this, objective](std::size_t left, std::size_t right)
+            {
+                return getObjective(points_[left], objective) < getObjective(points_[right], objective);
+            });
+
+        double range{ getObjective(points_[order_.back()], objective) -
+            getObjective(points_[order_.front()], objective) };
+        crowding_[order_.front()] = std::numeric_limits<double>::infinity();
+        crowding_[order_.back()] = std::numeric_limits<double>::infinity();
+        if (range <= 0.0)
+            continue;
+
+        for (std::size_t i{ 1 }; i + 1 < order_.size(); ++i)
+            crowding_[order_[i]] += (getObjective(points_[order_[i + 1]], objective) -
+                getObjective(points_[order_[i - 1]], objective)) / range;
+    }
+
+    auto crowded{ static_cast<std::size_t>(std::min_element(crowding_.cbegin(), crowding_.cend()) -
+        crowding_.cbegin()) };
+    points_[crowded] = points_.back();
+    points_.pop_back();
+}
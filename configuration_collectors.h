@@ -0,0 +1,73 @@
+#ifndef CONFIGURATION_COLLECTORS_H
+#define CONFIGURATION_COLLECTORS_H
+
+#include "queueing_system.h"
+
+#include <vector>
+#include <cstddef>
+
+namespace QueueingSystem
+{
+    // Rows of the best configurations table
+    inline constexpr std::size_t BEST_CONFIGURATIONS_COUNT{ 10 };
+    inline constexpr std::size_t PARETO_FRONTIER_CAPACITY{ 64 };
+
+    struct SystemConfigurationStats
+    {
+        SystemConfiguration conf{};
+        double rejectionProbability{};
+        double workload{};
+    };
+
+    // Higher workload first, then fewer devices, then a smaller buffer
+    bool isBetterConfiguration(const SystemConfigurationStats& left, const SystemConfigurationStats& right);
+
+    int getConfigurationCost(const SystemConfiguration& conf);
+
+    // The capacity best configurations seen, kept as a heap with the worst on
+    // top; storage is reserved once, adding never allocates.
+    class TopConfigurations
+    {
+    public:
+        explicit TopConfigurations(std::size_t capacity = BEST_CONFIGURATIONS_COUNT);
+
+        void add(const SystemConfigurationStats& stats);
+        // Collectors filled by different threads combine into one
+        void merge(const TopConfigurations& other);
+
+        std::size_t getSize() const;
+        // Best first
+        std::vector<SystemConfigurationStats> getSorted() const;
+
+    private:
+        std::vector<SystemConfigurationStats> heap_;
+        std::size_t capacity_;
+    };
+
+    // Configurations no other one beats on rejection probability, workload
+    // and cost (devices + buffer) at once. Past the capacity the point with
+    // the smallest crowding distance is dropped, so the frontier stays spread
+    // out; the extreme points of every objective are always kept.
+    class ParetoFrontier
+    {
+    public:
+        explicit ParetoFrontier(std::size_t capacity = PARETO_FRONTIER_CAPACITY);
+
+        void add(const SystemConfigurationStats& stats);
+        void merge(const ParetoFrontier& other);
+
+        std::size_t getSize() const;
+        // Cheapest first
+        std::vector<SystemConfigurationStats> getSorted() const;
+
+    private:
+        void thin();
+
+        std::vector<SystemConfigurationStats> points_;
+        std::size_t capacity_;
+        std::vector<std::size_t> order_;
+        std::vector<double> crowding_;
+    };
+}
+
+#endif
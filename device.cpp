@@ -6,7 +6,8 @@ namespace QS = QueueingSystem;
 
 QS::Device::Device(int deviceId, double lambda):
     deviceId_(deviceId),
-    distribution_(lambda)
+    lambda_(lambda),
+    distribution_(std::make_unique<ShiftedExponentialDistribution>(MIN_PROCESSING_TIME, lambda))
 {}
 
 int QS::Device::getProcessingRequestSourceId() const
@@ -15,6 +16,12 @@ int QS::Device::getProcessingRequestSourceId() const
     return processingRequest_.get()->id.sourceId;
 }
 
+double QS::Device::getProcessingRequestGenerationTime() const
+{
+    assert(processingRequest_ && "Request is not processed");
+    return processingRequest_->generationTime;
+}
+
 const double* QueueingSystem::Device::getProcessingEndTimePtr() const
 {
     return &processingEndTime_;
@@ -27,18 +34,24 @@ double QS::Device::getProcessingTime() const
 
 void QS::Device::setLambda(double lambda)
 {
-    distribution_ = std::exponential_distribution<double>{ lambda };
+    lambda_ = lambda;
+    distribution_ = std::make_unique<ShiftedExponentialDistribution>(MIN_PROCESSING_TIME, lambda);
 }
 
 double QS::Device::getLambda() const
 {
-    return distribution_.lambda();
+    return lambda_;
+}
+
+void QS::Device::setDistribution(const Distribution& distribution)
+{
+    distribution_ = distribution.clone();
 }
 
 void QS::Device::processRequest(URequest& request, double processingStartTime)
 {
     processingRequest_ = std::move(request);
-    processingTime_ = MIN_PROCESSING_TIME + distribution_(generator_);
+    processingTime_ = (*distribution_)(generator_);
     processingEndTime_ = processingStartTime + processingTime_;
 }
 
@@ -49,8 +62,40 @@ void QS::Device::endProcessingRequest()
     processingEndTime_ = IDLE_TIME;
 }
 
+void QS::Device::reseed(std::mt19937& seeder)
+{
+    generator_.seed(seeder());
+}
+
 void QS::Device::reset()
 {
     endProcessingRequest();
-    distribution_.reset();
+    distribution_->reset();
+}
+
+QS::DeviceState QS::Device::getState() const
+{
+    DeviceState state{};
+    if (processingRequest_)
+        state.processingRequest = *processingRequest_;
+    state.processingTime = processingTime_;
+    state.processingEndTime = processingEndTime_;
+    state.generator = generator_;
+    state.distribution = distribution_->clone();
+    return state;
+}
+
+void QS::Device::restore(const DeviceState& state)
+{
+    if (!state.processingRequest)
+        processingRequest_.reset();
+    else if (processingRequest_)
+        *processingRequest_ = *state.processingRequest;
+    else
+        processingRequest_ = std::make_unique<Request>(*state.processingRequest);
+
+    processingTime_ = state.processingTime;
+    processingEndTime_ = state.processingEndTime;
+    generator_ = state.generator;
+    distribution_ = state.distribution->clone();
 }
@@ -2,21 +2,33 @@
 #define DEVICE_HPP
 
 #include "request.h"
+#include "distribution.h"
 
 #include <random>
 #include <memory>
+#include <optional>
 
 namespace QueueingSystem
 {
     inline constexpr double IDLE_TIME{ -1.0 };
     inline constexpr double MIN_PROCESSING_TIME{ 5.0 };
 
+    struct DeviceState
+    {
+        std::optional<Request> processingRequest{};
+        double processingTime{ IDLE_TIME };
+        double processingEndTime{ IDLE_TIME };
+        std::mt19937 generator{};
+        UDistribution distribution{};
+    };
+
     class Device
     {
     public:
         Device(int deviceId, double lambda = 0.05);
 
         int getProcessingRequestSourceId() const;
+        double getProcessingRequestGenerationTime() const;
         const double* getProcessingEndTimePtr() const;
 
         double getProcessingTime() const;
@@ -24,19 +36,27 @@ namespace QueueingSystem
         void setLambda(double lambda);
         double getLambda() const;
 
+        void setDistribution(const Distribution& distribution);
+
         void processRequest(URequest& request, double processingStartTime);
         void endProcessingRequest();
 
+        void reseed(std::mt19937& seeder);
+
         void reset();
 
+        DeviceState getState() const;
+        void restore(const DeviceState& state);
+
     private:
         int deviceId_;
         URequest processingRequest_{};
         double processingTime_{ IDLE_TIME };
         double processingEndTime_{ IDLE_TIME };
+        double lambda_;
 
         std::mt19937 generator_{ std::random_device{}() };
-        std::exponential_distribution<double> distribution_;
+        UDistribution distribution_;
     };
 
     using UDevice = std::unique_ptr<Device>;
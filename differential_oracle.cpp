@@ -0,0 +1,377 @@
+#include "differential_oracle.h"
+#include "basic_queueing_system.h"
+
+#include <random>
+#include <memory>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+
+namespace QS = QueueingSystem;
+
+namespace
+{
+    // Folds the request events back into one TraceEvent per event
+    class TraceObserver
+    {
+    public:
+        explicit TraceObserver(std::vector<QS::TraceEvent>& trace):
+            trace_(&trace)
+        {}
+
+        void onArrival(const QS::Request& request, double time)
+        {
+            arrival_ = request.id;
+            trace_->push_back({ time, QS::EventType::sourceEvent, request.id.sourceId, -1, 0.0, occupancy_ });
+        }
+
+        void onBufferInsert(const QS::Request& /*request*/, double /*time*/)
+        {
+            trace_->back().bufferOccupancy = ++occupancy_;
+        }
+
+        void onEviction(const QS::Request& request, double /*time*/)
+        {
+            // The new request itself never got in
+            if (request.id.sourceId != arrival_.sourceId || request.id.serialNumber != arrival_.serialNumber)
+                trace_->back().bufferOccupancy = --occupancy_;
+        }
+
+        void onDispatch(const QS::Request& /*request*/, int deviceId, double /*startTime*/, double endTime)
+        {
+            auto& event{ trace_->back() };
+            event.startedDeviceId = deviceId;
+            event.serviceEndTime = endTime;
+            event.bufferOccupancy = --occupancy_;
+        }
+
+        void onServiceCompletion(const QS::Request& /*request*/, int deviceId, double /*startTime*/,
+            double endTime)
+        {
+            trace_->push_back({ endTime, QS::EventType::deviceEvent, deviceId, -1, 0.0, occupancy_ });
+        }
+
+    private:
+        std::vector<QS::TraceEvent>* trace_;
+        QS::RequestId arrival_{ -1, -1 };
+        int occupancy_{};
+    };
+
+    using OracleQueueingSystem = QS::BasicQueueingSystem<QS::EntityStreamArrivalPolicy,
+        QS::EntityStreamServicePolicy, QS::SourcePriorityBufferPolicy, QS::RoundRobinDispatchPolicy, TraceObserver>;
+
+    struct OracleRun
+    {
+        std::vector<QS::TraceEvent> trace{};
+        QS::SystemFinalStats finalStats{};
+    };
+
+    OracleRun runQueueingSystem(QS::SystemConfiguration conf, QS::EventSetType eventSet, std::uint32_t seed)
+    {
+        conf.eventSet = eventSet;
+        QS::QueueingSystem system{ conf };
+        std::mt19937 seeder{ seed };
+        system.reseed(seeder);
+
+        OracleRun run{};
+        while (system.makeStep())
+        {
+            const auto& step{ system.getLastStep() };
+            run.trace.push_back({ system.getTime(), step.eventType, step.entityId, step.startedDeviceId,
+                step.startedDeviceId != -1 ? step.serviceEndTime : 0.0, step.bufferOccupancy });
+        }
+        run.finalStats = system.getSystemFinalStats();
+        return run;
+    }
+
+    OracleRun runBasicQueueingSystem(QS::SystemConfiguration conf, QS::EventSetType eventSet, std::uint32_t seed)
+    {
+        conf.eventSet = eventSet;
+        OracleRun run{};
+        OracleQueueingSystem system{ conf, TraceObserver{ run.trace } };
+        std::mt19937 seeder{ seed };
+        system.reseed(seeder);
+
+        system.run();
+        run.finalStats = system.getSystemFinalStats();
+        return run;
+    }
+
+    bool isClose(double reference, double candidate)
+    {
+        if (reference == candidate || (std::isnan(reference) && std::isnan(candidate)))
+            return true;
+        return std::abs(reference - candidate) <=
+            QS::ORACLE_TOLERANCE * std::max(std::abs(reference), std::abs(candidate));
+    }
+
+    // Collects the first mismatch only, later ones are mostly its consequences
+    class Comparison
+    {
+    public:
+        Comparison(const std::string& engine, long long eventIndex):
+            divergence_{ engine, eventIndex }
+        {}
+
+        void exact(const std::string& field, double reference, double candidate)
+        {
+            if (!hasDiverged() && reference != candidate)
+                diverge(field, reference, candidate);
+        }
+
+        void close(const std::string& field, double reference, double candidate)
+        {
+            if (!hasDiverged() && !isClose(reference, candidate))
+                diverge(field, reference, candidate);
+        }
+
+        void estimate(const std::string& field, const QS::SteadyStateEstimate& reference,
+            const QS::SteadyStateEstimate& candidate)
+        {
+            close(field + ".mean", reference.mean, candidate.mean);
+            close(field + ".halfWidth", reference.halfWidth, candidate.halfWidth);
+            exact(field + ".warmupCount", static_cast<double>(reference.warmupCount),
+                static_cast<double>(candidate.warmupCount));
+            exact(field + ".batchesCount", reference.batchesCount, candidate.batchesCount);
+            exact(field + ".batchSize", static_cast<double>(reference.batchSize),
+                static_cast<double>(candidate.batchSize));
+        }
+
+        bool hasDiverged() const
+        {
+            return !divergence_.field.empty();
+        }
+
+        const QS::Divergence& getDivergence() const
+        {
+            return divergence_;
+        }
+
+    private:
+        void diverge(const std::string& field, double reference, double candidate)
+        {
+            divergence_.field = field;
+            divergence_.referenceValue = reference;
+            divergence_.candidateValue = candidate;
+        }
+
+        QS::Divergence divergence_;
+    };
+
+    Comparison compareTraces(const std::string& engine, const std::vector<QS::TraceEvent>& reference,
+        const std::vector<QS::TraceEvent>& candidate)
+    {
+        auto eventsCount{ std::min(reference.size(), candidate.size()) };
+        for (std::size_t i{ 0 }; i < eventsCount; ++i)
+        {
+            const auto& expected{ reference[i] };
+            const auto& actual{ candidate[i] };
+
+            Comparison comparison{ engine, static_cast<long long>(i) };
+            comparison.exact("time", expected.time, actual.time);
+            comparison.exact("eventType", static_cast<int>(expected.eventType), static_cast<int>(actual.eventType));
+            comparison.exact("entityId", expected.entityId, actual.entityId);
+            comparison.exact("startedDeviceId", expected.startedDeviceId, actual.startedDeviceId);
+            comparison.exact("serviceEndTime", expected.serviceEndTime, actual.serviceEndTime);
+            comparison.exact("bufferOccupancy", expected.bufferOccupancy, actual.bufferOccupancy);
+            if (comparison.hasDiverged())
+                return comparison;
+        }
+
+        Comparison comparison{ engine, static_cast<long long>(eventsCount) };
+        comparison.exact("eventsCount", static_cast<double>(reference.size()), static_cast<double>(candidate.size()));
+        return comparison;
+    }
+
+    Comparison compareFinalStats(const std::string& engine, const QS::SystemFinalStats& reference,
+        const QS::SystemFinalStats& candidate)
+    {
+        Comparison comparison{ engine, -1 };
+        comparison.close("rejectionProbability", reference.rejectionProbability, candidate.rejectionProbability);
+        comparison.close("workload", reference.workload, candidate.workload);
+        // Infinite without rejections, the conversion is then unspecified
+        if (reference.rejectionProbability > 0.0)
+            comparison.exact("requiredRequestsCount", reference.requiredRequestsCount,
+                candidate.requiredRequestsCount);
+        comparison.estimate("rejectionEstimate", reference.rejectionEstimate, candidate.rejectionEstimate);
+        comparison.estimate("waitingTimeEstimate", reference.waitingTimeEstimate, candidate.waitingTimeEstimate);
+
+        comparison.exact("sourcesCount", static_cast<double>(reference.sourcesFinalStats.size()),
+            static_cast<double>(candidate.sourcesFinalStats.size()));
+        comparison.exact("devicesCount", static_cast<double>(reference.deviceFinalStats.size()),
+            static_cast<double>(candidate.deviceFinalStats.size()));
+        if (comparison.hasDiverged())
+            return comparison;
+
+        for (std::size_t i{ 0 }; i < reference.sourcesFinalStats.size(); ++i)
+        {
+            const auto& expected{ *reference.sourcesFinalStats[i] };
+            const auto& actual{ *candidate.sourcesFinalStats[i] };
+            auto prefix{ "sources[" + std::to_string(i) + "]." };
+
+            comparison.exact(prefix + "requestsCount", expected.requestsCount, actual.requestsCount);
+            comparison.close(prefix + "rejectionProbability", expected.rejectionProbability,
+                actual.rejectionProbability);
+            comparison.close(prefix + "averageBufferTime", expected.averageBufferTime, actual.averageBufferTime);
+            comparison.close(prefix + "averageServiceTime", expected.averageServiceTime, actual.averageServiceTime);
+            comparison.close(prefix + "averageProcessingTime", expected.averageProcessingTime,
+                actual.averageProcessingTime);
+            comparison.close(prefix + "bufferTimeDispersion", expected.bufferTimeDispersion,
+                actual.bufferTimeDispersion);
+            comparison.close(prefix + "serviceTimeDispersion", expected.serviceTimeDispersion,
+                actual.serviceTimeDispersion);
+        }
+
+        for (std::size_t i{ 0 }; i < reference.deviceFinalStats.size(); ++i)
+        {
+            const auto& expected{ *reference.deviceFinalStats[i] };
+            const auto& actual{ *candidate.deviceFinalStats[i] };
+            auto prefix{ "devices[" + std::to_string(i) + "]." };
+
+            comparison.exact(prefix + "requestsCount", expected.requestsCount, actual.requestsCount);
+            comparison.close(prefix + "averageServiceTime", expected.averageServiceTime, actual.averageServiceTime);
+            comparison.close(prefix + "utilizationFactor", expected.utilizationFactor, actual.utilizationFactor);
+        }
+        return comparison;
+    }
+
+    void compare(const std::string& engine, const OracleRun& reference, const OracleRun& candidate,
+        std::vector<QS::Divergence>& divergences)
+    {
+        auto comparison{ compareTraces(engine, reference.trace, candidate.trace) };
+        if (!comparison.hasDiverged())
+            comparison = compareFinalStats(engine, reference.finalStats, candidate.finalStats);
+        if (comparison.hasDiverged())
+            divergences.push_back(comparison.getDivergence());
+    }
+
+    std::vector<QS::SystemConfiguration> makeEdgeConfigurations()
+    {
+        QS::SystemConfiguration base{};
+        base.requestsLimit = 2000;
+
+        std::vector<QS::SystemConfiguration> configurations(8, base);
+        configurations[0].bufferSize = 1;
+        configurations[1].devicesCount = 1;
+        configurations[2].sourcesCount = 1;
+        configurations[2].bufferSize = 1;
+        configurations[2].devicesCount = 1;
+        configurations[3].requestsLimit = 1;
+        // Every source generates at the same times, and services end together
+        // with arrivals
+        configurations[4].arrivalDistribution = std::make_shared<QS::DeterministicDistribution>(1.0);
+        configurations[4].serviceDistribution = std::make_shared<QS::DeterministicDistribution>(2.0);
+        configurations[5] = configurations[4];
+        configurations[5].bufferSize = 1;
+        configurations[5].devicesCount = 1;
+        // Overloaded, with rejections from the start
+        configurations[6].devicesCount = 2;
+        configurations[6].lambda = 0.01f;
+        configurations[7] = configurations[6];
+        configurations[7].requestsLimit = 20000;
+        configurations[7].targetPrecision = 0.1;
+        return configurations;
+    }
+
+    QS::SystemConfiguration makeRandomConfiguration(std::mt19937& generator)
+    {
+        auto uniformInt = [&generator](int min, int max)
+        {
+            return std::uniform_int_distribution<int>{ min, max }(generator);
+        };
+        auto uniformReal = [&generator](double min, double max)
+        {
+            return std::uniform_real_distribution<double>{ min, max }(generator);
+        };
+
+        QS::SystemConfiguration conf{};
+        conf.sourcesCount = uniformInt(1, 30);
+        conf.bufferSize = uniformInt(1, 30);
+        conf.devicesCount = uniformInt(1, 30);
+        conf.distrRange = static_cast<float>(uniformReal(0.1, 10.0));
+        conf.lambda = static_cast<float>(uniformReal(0.01, 2.0));
+        conf.requestsLimit = uniformInt(1, 5000);
+
+        // Periods of a few whole halves, so that events coincide
+        int model{ uniformInt(0, 7) };
+        if (model == 0 || model == 2)
+            conf.arrivalDistribution = std::make_shared<QS::DeterministicDistribution>(0.5 * uniformInt(1, 4));
+        if (model == 1 || model == 2)
+            conf.serviceDistribution = std::make_shared<QS::DeterministicDistribution>(0.5 * uniformInt(1, 8));
+        if (uniformInt(0, 7) == 0)
+            conf.targetPrecision = 0.1;
+        return conf;
+    }
+
+    std::string describe(const QS::SystemConfiguration& conf, std::uint32_t seed)
+    {
+        std::ostringstream description{};
+        description << "sources " << conf.sourcesCount << ", buffer " << conf.bufferSize
+            << ", devices " << conf.devicesCount << ", requests " << conf.requestsLimit
+            << ", range " << conf.distrRange << ", lambda " << conf.lambda << ", arrivals ";
+        if (conf.arrivalDistribution)
+            conf.arrivalDistribution->write(description);
+        else
+            description << "uniform";
+        description << ", service ";
+        if (conf.serviceDistribution)
+            conf.serviceDistribution->write(description);
+        else
+            description << "exponential";
+        description << ", precision " << conf.targetPrecision << ", seed " << seed;
+        return description.str();
+    }
+}
+
+std::vector<QS::Divergence> QS::checkConfiguration(const SystemConfiguration& conf, std::uint32_t seed)
+{
+    SystemConfiguration generated{ conf };
+    generated.trace = nullptr;
+
+    auto reference{ runQueueingSystem(generated, EventSetType::linear, seed) };
+
+    std::vector<Divergence> divergences{};
+    compare("binary heap", reference, runQueueingSystem(generated, EventSetType::binaryHeap, seed), divergences);
+    compare("calendar queue", reference, runQueueingSystem(generated, EventSetType::calendarQueue, seed),
+        divergences);
+    compare("compile-time engine", reference, runBasicQueueingSystem(generated, EventSetType::linear, seed),
+        divergences);
+    compare("compile-time engine, binary heap", reference,
+        runBasicQueueingSystem(generated, EventSetType::binaryHeap, seed), divergences);
+    return divergences;
+}
+
+int QS::runDifferentialOracle(std::ostream& out, int configurationsCount, std::uint32_t seed)
+{
+    std::mt19937 generator{ seed };
+    auto configurations{ makeEdgeConfigurations() };
+    for (int i{ 0 }; i < configurationsCount; ++i)
+        configurations.push_back(makeRandomConfiguration(generator));
+
+    out << "seed " << seed << '\n';
+
+    int divergentCount{};
+    for (std::size_t i{ 0 }; i < configurations.size(); ++i)
+    {
+        auto streamsSeed{ generator() };
+        auto divergences{ checkConfiguration(configurations[i], streamsSeed) };
+        if (divergences.empty())
+            continue;
+
+        ++divergentCount;
+        out << "configuration " << i << ": " << describe(configurations[i], streamsSeed) << '\n';
+        for (const auto& divergence : divergences)
+        {
+            out << "    " << divergence.engine << ": ";
+            if (divergence.eventIndex < 0)
+                out << "final statistics";
+            else
+                out << "event " << divergence.eventIndex;
+            out << ", " << divergence.field << " " << divergence.candidateValue
+                << " instead of " << divergence.referenceValue << '\n';
+        }
+    }
+
+    out << configurations.size() << " configurations, " << divergentCount << " divergent" << std::endl;
+    return divergentCount ? 1 : 0;
+}
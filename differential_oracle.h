@@ -0,0 +1,54 @@
+#ifndef DIFFERENTIAL_ORACLE_H
+#define DIFFERENTIAL_ORACLE_H
+
+#include "queueing_system.h"
+
+#include <vector>
+#include <string>
+#include <ostream>
+#include <cstdint>
+
+namespace QueueingSystem
+{
+    inline constexpr const char* DIFFERENTIAL_ORACLE_FLAG{ "--differential-oracle" };
+    // Relative difference allowed in the final statistics, which the engines
+    // accumulate each in their own way; the traces have to match exactly
+    inline constexpr double ORACLE_TOLERANCE{ 1e-9 };
+
+    // One event of a run, what the StepRecord of QueueingSystem tells
+    struct TraceEvent
+    {
+        double time{};
+        EventType eventType{};
+        int entityId{};
+        int startedDeviceId{ -1 };
+        // 0 when the event started no service
+        double serviceEndTime{};
+        int bufferOccupancy{};
+    };
+
+    // First difference of an engine from the reference
+    struct Divergence
+    {
+        std::string engine{};
+        // Index in the trace, -1 for the final statistics
+        long long eventIndex{ -1 };
+        std::string field{};
+        double referenceValue{};
+        double candidateValue{};
+    };
+
+    // Runs conf on the reference, QueueingSystem with the linear event set,
+    // and on the optimized engines: the other event sets and BasicQueueingSystem.
+    // Every engine draws from a stream per source and per device seeded from
+    // seed like QueueingSystem::reseed does, so they go through the same
+    // events. Generated arrivals only, conf.trace and conf.eventSet are ignored.
+    std::vector<Divergence> checkConfiguration(const SystemConfiguration& conf, std::uint32_t seed);
+
+    // Checks the edge cases (a single place in the buffer, a single device,
+    // simultaneous events) and configurationsCount random configurations,
+    // reporting the first divergence of every engine; 1 when there is one
+    int runDifferentialOracle(std::ostream& out, int configurationsCount, std::uint32_t seed);
+}
+
+#endif
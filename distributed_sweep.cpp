@@ -0,0 +1,571 @@
+#include "distributed_sweep.h"
+
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <limits>
+#include <string>
+#include <thread>
+#include <sstream>
+#include <stdexcept>
+#include <array>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+namespace QS = QueueingSystem;
+namespace fs = std::filesystem;
+
+namespace
+{
+    constexpr int HEARTBEAT_POINTS{ 10 };
+    constexpr std::chrono::milliseconds POLL_INTERVAL{ 50 };
+
+    std::int64_t getProcessId()
+    {
+#ifdef _WIN32
+        return static_cast<std::int64_t>(GetCurrentProcessId());
+#else
+        return static_cast<std::int64_t>(getpid());
+#endif
+    }
+
+    // Unique per run, so sweeps of this and other processes never share a queue
+    fs::path makeQueueDirectory()
+    {
+        static std::atomic<int> queuesCount{};
+        return fs::temp_directory_path() /
+            ("qs_sweep_" + std::to_string(getProcessId()) + '_' + std::to_string(queuesCount++));
+    }
+
+    fs::path pendingDirectory(const fs::path& queueDirectory)
+    {
+        return queueDirectory / "pending";
+    }
+
+    fs::path claimedDirectory(const fs::path& queueDirectory)
+    {
+        return queueDirectory / "claimed";
+    }
+
+    fs::path doneDirectory(const fs::path& queueDirectory)
+    {
+        return queueDirectory / "done";
+    }
+
+    fs::path stopFile(const fs::path& queueDirectory)
+    {
+        return queueDirectory / "stop";
+    }
+
+    std::string chunkFileName(int chunkId)
+    {
+        return "chunk_" + std::to_string(chunkId) + ".txt";
+    }
+
+    std::string claimFileName(int chunkId, int slot)
+    {
+        return "chunk_" + std::to_string(chunkId) + ".w" + std::to_string(slot) + ".txt";
+    }
+
+    // chunk_<id>.txt and chunk_<id>.w<slot>.txt both start with "chunk_<id>."
+    int parseChunkId(const fs::path& file)
+    {
+        auto name{ file.filename().string() };
+        auto idBegin{ name.find('_') + 1 };
+        return std::stoi(name.substr(idBegin, name.find('.') - idBegin));
+    }
+
+    int parseClaimSlot(const fs::path& file)
+    {
+        auto name{ file.filename().string() };
+        auto slotBegin{ name.find(".w") + 2 };
+        return std::stoi(name.substr(slotBegin, name.rfind('.') - slotBegin));
+    }
+
+    void writeChunk(const fs::path& file, const QS::SweepSpec& spec, int begin, int end)
+    {
+        std::ofstream out{ file };
+        QS::writeSweepJob(out, spec, begin, end);
+    }
+
+    bool readChunk(const fs::path& file, QS::SweepSpec& spec, int& begin, int& end)
+    {
+        std::ifstream in{ file };
+        return QS::readSweepJob(in, spec, begin, end);
+    }
+
+    void touch(const fs::path& file)
+    {
+        std::error_code ec{};
+        fs::last_write_time(file, fs::file_time_type::clock::now(), ec);
+    }
+
+    void processChunk(const fs::path& queueDirectory, const fs::path& claim, QS::TelemetryPublisher& telemetry)
+    {
+        QS::SweepSpec spec{};
+        int begin{};
+        int end{};
+        std::error_code ec{};
+
+        if (!readChunk(claim, spec, begin, end))
+        {
+            fs::remove(claim, ec);
+            return;
+        }
+
+        auto chunkId{ parseChunkId(claim) };
+        auto result{ doneDirectory(queueDirectory) / chunkFileName(chunkId) };
+        auto partial{ claim };
+        partial.replace_extension(".part");
+
+        {
+            std::ofstream out{ partial };
+            out.precision(std::numeric_limits<double>::max_digits10);
+
+            for (int index{ begin }; index < end; index += HEARTBEAT_POINTS)
+            {
+                for (const auto& point : QS::runSweepChunk(spec, index, std::min(index + HEARTBEAT_POINTS, end),
+                    telemetry.isOpen() ? &telemetry : nullptr))
+                    QS::writeSweepPoint(out, point);
+                touch(claim);
+            }
+        }
+
+        fs::rename(partial, result, ec);
+        fs::remove(claim, ec);
+    }
+
+    bool tryClaimChunk(const fs::path& queueDirectory, int slot, fs::path& claim)
+    {
+        std::error_code ec{};
+        for (const auto& entry : fs::directory_iterator{ pendingDirectory(queueDirectory), ec })
+        {
+            claim = claimedDirectory(queueDirectory) / claimFileName(parseChunkId(entry.path()), slot);
+
+            fs::rename(entry.path(), claim, ec);
+            if (!ec)
+            {
+                touch(claim);
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+QS::SweepCoordinator::SweepCoordinator(const DistributedSweepConfiguration& conf):
+    conf_(conf)
+{
+    if (conf_.workerExecutable.empty())
+        conf_.workerExecutable = getCurrentExecutablePath();
+}
+
+std::vector<QS::SweepPointStats> QS::SweepCoordinator::run(const SweepSpec& spec)
+{
+    int pointsCount{ getSweepPointsCount(spec.kind) };
+    int chunksCount{ (pointsCount + conf_.chunkSize - 1) / conf_.chunkSize };
+
+    // A trace is not written to the chunk files, runSweep rejects it
+    if (spec.baseConf.trace)
+        return runSweep(spec);
+
+    prepareQueue(spec, chunksCount);
+    chunkRetries_.assign(chunksCount, 0);
+    failedChunks_.clear();
+
+    for (int slot{}; slot < conf_.workersCount; ++slot)
+        spawnWorker(slot);
+
+    // Slot 0 shows the points collected from the workers out of the sweep
+    TelemetryPublisher telemetry{ 0 };
+    std::error_code ec{};
+    if (workers_.empty())
+    {
+        fs::remove_all(queueDirectory_, ec);
+        return runSweepChunk(spec, 0, pointsCount, telemetry.isOpen() ? &telemetry : nullptr);
+    }
+
+    auto& snapshot{ telemetry.getSnapshot() };
+    snapshot.sweepEnd = pointsCount;
+
+    std::vector<SweepPointStats> points{};
+    points.reserve(pointsCount);
+    std::vector<bool> collected(chunksCount);
+    int collectedCount{};
+
+    auto runChunk{ [&](int chunkId)
+        {
+            if (collected[chunkId])
+                return;
+
+            int begin{ chunkId * conf_.chunkSize };
+            for (const auto& point : runSweepChunk(spec, begin, std::min(begin + conf_.chunkSize, pointsCount)))
+                points.push_back(point);
+            collected[chunkId] = true;
+            ++collectedCount;
+        } };
+
+    int respawnsCount{};
+    bool respawnsExhausted{};
+    while (collectedCount < chunksCount && !respawnsExhausted)
+    {
+        collectedCount += collectResults(points, collected);
+        snapshot.sweepPoint = static_cast<std::int64_t>(points.size());
+        telemetry.publish();
+
+        for (auto& worker : workers_)
+        {
+            if (!isWorkerAlive(worker))
+            {
+                requeueClaims(worker.slot);
+                if (respawnsCount == conf_.respawnsLimit)
+                {
+                    respawnsExhausted = true;
+                    break;
+                }
+                ++respawnsCount;
+                spawnWorker(worker.slot);
+            }
+        }
+        requeueStaleClaims();
+
+        for (auto chunkId : failedChunks_)
+            runChunk(chunkId);
+        failedChunks_.clear();
+
+        std::this_thread::sleep_for(POLL_INTERVAL);
+    }
+
+    // With no pending chunks left the live workers finish their claims and stop
+    if (respawnsExhausted)
+        fs::remove_all(pendingDirectory(queueDirectory_), ec);
+    stopWorkers();
+
+    collectedCount += collectResults(points, collected);
+    for (int chunkId{}; chunkId < chunksCount; ++chunkId)
+        runChunk(chunkId);
+
+    fs::remove_all(queueDirectory_, ec);
+
+    std::sort(points.begin(), points.end(),
+        [](const auto& left, const auto& right)
+        {
+            return left.index < right.index;
+        });
+
+    return points;
+}
+
+std::vector<QS::SweepPointStats> QS::SweepCoordinator::operator()(const SweepSpec& spec)
+{
+    return run(spec);
+}
+
+void QS::SweepCoordinator::prepareQueue(const SweepSpec& spec, int chunksCount)
+{
+    queueDirectory_ = conf_.queueDirectory.empty() ? makeQueueDirectory() : conf_.queueDirectory;
+    const auto& queueDirectory{ queueDirectory_ };
+
+    fs::remove_all(queueDirectory);
+    fs::create_directories(pendingDirectory(queueDirectory));
+    fs::create_directories(claimedDirectory(queueDirectory));
+    fs::create_directories(doneDirectory(queueDirectory));
+
+    int pointsCount{ getSweepPointsCount(spec.kind) };
+    for (int chunkId{}; chunkId < chunksCount; ++chunkId)
+    {
+        int begin{ chunkId * conf_.chunkSize };
+        writeChunk(pendingDirectory(queueDirectory) / chunkFileName(chunkId),
+            spec, begin, std::min(begin + conf_.chunkSize, pointsCount));
+    }
+}
+
+int QS::SweepCoordinator::collectResults(std::vector<SweepPointStats>& points, std::vector<bool>& collected)
+{
+    int newlyCollected{};
+    std::error_code ec{};
+
+    for (const auto& entry : fs::directory_iterator{ doneDirectory(queueDirectory_), ec })
+    {
+        auto chunkId{ parseChunkId(entry.path()) };
+        if (collected[chunkId])
+            continue;
+
+        std::ifstream in{ entry.path() };
+        SweepPointStats point{};
+        while (QS::readSweepPoint(in, point))
+            points.push_back(point);
+
+        collected[chunkId] = true;
+        ++newlyCollected;
+    }
+
+    return newlyCollected;
+}
+
+void QS::SweepCoordinator::requeueClaim(const fs::path& claim)
+{
+    auto chunkId{ parseChunkId(claim) };
+    std::error_code ec{};
+
+    if (chunkRetries_[chunkId]++ < conf_.chunkRetriesLimit)
+        fs::rename(claim, pendingDirectory(queueDirectory_) / chunkFileName(chunkId), ec);
+    else
+    {
+        fs::remove(claim, ec);
+        failedChunks_.push_back(chunkId);
+    }
+}
+
+void QS::SweepCoordinator::requeueClaims(int slot)
+{
+    std::error_code ec{};
+    for (const auto& entry : fs::directory_iterator{ claimedDirectory(queueDirectory_), ec })
+    {
+        if (entry.path().extension() == ".txt" && parseClaimSlot(entry.path()) == slot)
+            requeueClaim(entry.path());
+    }
+}
+
+void QS::SweepCoordinator::requeueStaleClaims()
+{
+    auto now{ fs::file_time_type::clock::now() };
+    std::error_code ec{};
+
+    for (const auto& entry : fs::directory_iterator{ claimedDirectory(queueDirectory_), ec })
+    {
+        if (entry.path().extension() != ".txt")
+            continue;
+
+        auto lastHeartbeat{ fs::last_write_time(entry.path(), ec) };
+        if (!ec && now - lastHeartbeat > conf_.heartbeatTimeout)
+            requeueClaim(entry.path());
+    }
+}
+
+#ifdef _WIN32
+
+void QS::SweepCoordinator::spawnWorker(int slot)
+{
+    auto commandLine{ L"\"" + conf_.workerExecutable.wstring() + L"\" " +
+        fs::path{ SWEEP_WORKER_FLAG }.wstring() + L" \"" + queueDirectory_.wstring() + L"\" " +
+        std::to_wstring(slot) };
+
+    STARTUPINFOW startupInfo{};
+    startupInfo.cb = sizeof(startupInfo);
+    PROCESS_INFORMATION processInfo{};
+
+    if (!CreateProcessW(nullptr, commandLine.data(), nullptr, nullptr, FALSE,
+        CREATE_NO_WINDOW, nullptr, nullptr, &startupInfo, &processInfo))
+        return;
+
+    CloseHandle(processInfo.hThread);
+
+    auto handle{ reinterpret_cast<std::intptr_t>(processInfo.hProcess) };
+    auto worker{ std::find_if(workers_.begin(), workers_.end(),
+        [slot](const auto& worker) { return worker.slot == slot; }) };
+    if (worker != workers_.end())
+    {
+        CloseHandle(reinterpret_cast<HANDLE>(worker->handle));
+        worker->handle = handle;
+    }
+    else
+        workers_.push_back(WorkerProcess{ slot, handle });
+}
+
+bool QS::SweepCoordinator::isWorkerAlive(const WorkerProcess& worker) const
+{
+    return WaitForSingleObject(reinterpret_cast<HANDLE>(worker.handle), 0) == WAIT_TIMEOUT;
+}
+
+void QS::SweepCoordinator::stopWorkers()
+{
+    std::ofstream{ stopFile(queueDirectory_) };
+
+    auto deadline{ std::chrono::steady_clock::now() + conf_.stopTimeout };
+    for (const auto& worker : workers_)
+    {
+        auto handle{ reinterpret_cast<HANDLE>(worker.handle) };
+        auto timeLeft{ std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now()) };
+        if (WaitForSingleObject(handle, static_cast<DWORD>(std::max<long long>(timeLeft.count(), 0))) == WAIT_TIMEOUT)
+        {
+            TerminateProcess(handle, 1);
+            WaitForSingleObject(handle, INFINITE);
+        }
+        CloseHandle(handle);
+    }
+    workers_.clear();
+}
+
+fs::path QS::getCurrentExecutablePath()
+{
+    std::wstring path(32768, L'\0');
+    path.resize(GetModuleFileNameW(nullptr, path.data(), static_cast<DWORD>(path.size())));
+    return path;
+}
+
+#else
+
+void QS::SweepCoordinator::spawnWorker(int slot)
+{
+    auto executable{ conf_.workerExecutable.string() };
+    auto queueDirectory{ queueDirectory_.string() };
+    auto slotArg{ std::to_string(slot) };
+
+    pid_t pid{ fork() };
+    if (pid == 0)
+    {
+        execl(executable.c_str(), executable.c_str(), SWEEP_WORKER_FLAG,
+            queueDirectory.c_str(), slotArg.c_str(), static_cast<char*>(nullptr));
+        _exit(127);
+    }
+    if (pid < 0)
+        return;
+
+    auto worker{ std::find_if(workers_.begin(), workers_.end(),
+        [slot](const auto& worker) { return worker.slot == slot; }) };
+    if (worker != workers_.end())
+        worker->handle = pid;
+    else
+        workers_.push_back(WorkerProcess{ slot, pid });
+}
+
+bool QS::SweepCoordinator::isWorkerAlive(const WorkerProcess& worker) const
+{
+    return waitpid(static_cast<pid_t>(worker.handle), nullptr, WNOHANG) == 0;
+}
+
+void QS::SweepCoordinator::stopWorkers()
+{
+    std::ofstream{ stopFile(queueDirectory_) };
+
+    auto deadline{ std::chrono::steady_clock::now() + conf_.stopTimeout };
+    for (const auto& worker : workers_)
+    {
+        auto pid{ static_cast<pid_t>(worker.handle) };
+        while (waitpid(pid, nullptr, WNOHANG) == 0)
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+            {
+                kill(pid, SIGKILL);
+                waitpid(pid, nullptr, 0);
+                break;
+            }
+            std::this_thread::sleep_for(POLL_INTERVAL);
+        }
+    }
+    workers_.clear();
+}
+
+fs::path QS::getCurrentExecutablePath()
+{
+    std::error_code ec{};
+    return fs::read_symlink("/proc/self/exe", ec);
+}
+
+#endif
+
+int QS::runSweepWorker(const fs::path& queueDirectory, int slot)
+{
+    fs::path claim{};
+    TelemetryPublisher telemetry{ slot + 1 };
+
+    while (true)
+    {
+        if (tryClaimChunk(queueDirectory, slot, claim))
+            processChunk(queueDirectory, claim, telemetry);
+        else if (fs::exists(stopFile(queueDirectory)))
+            return 0;
+        else
+            std::this_thread::sleep_for(POLL_INTERVAL);
+    }
+}
+
+void QS::writeSweepJob(std::ostream& out, const SweepSpec& spec, int begin, int end)
+{
+    const auto& conf{ spec.baseConf };
+    if (conf.trace)
+        throw std::invalid_argument{ "A sweep job cannot carry a trace" };
+
+    out.precision(std::numeric_limits<float>::max_digits10);
+    out << static_cast<int>(spec.kind) << ' ' << begin << ' ' << end << ' ' << spec.prescreen << ' '
+        << spec.margins.rejectionProbability << ' ' << spec.margins.workload << '\n'
+        << conf.sourcesCount << ' ' << conf.distrRange << ' ' << conf.bufferSize << ' '
+        << conf.devicesCount << ' ' << conf.lambda << ' ' << conf.requestsLimit << ' '
+        << conf.targetPrecision << '\n';
+
+    out.precision(std::numeric_limits<double>::max_digits10);
+    for (const auto& distribution : { conf.arrivalDistribution, conf.serviceDistribution })
+    {
+        if (distribution)
+            distribution->write(out);
+        else
+            out << "none";
+        out << '\n';
+    }
+}
+
+bool QS::readSweepJob(std::istream& in, SweepSpec& spec, int& begin, int& end)
+{
+    auto& conf{ spec.baseConf };
+    int kind{};
+
+    in >> kind >> begin >> end >> spec.prescreen >> spec.margins.rejectionProbability >> spec.margins.workload
+        >> conf.sourcesCount >> conf.distrRange >> conf.bufferSize
+        >> conf.devicesCount >> conf.lambda >> conf.requestsLimit >> conf.targetPrecision;
+    spec.kind = static_cast<SweepKind>(kind);
+    if (!in)
+        return false;
+
+    conf.arrivalDistribution = readDistribution(in);
+    conf.serviceDistribution = readDistribution(in);
+
+    return static_cast<bool>(in);
+}
+
+// Half-widths are infinite on short runs, stod reads "inf" back
+void QS::writeSweepPoint(std::ostream& out, const SweepPointStats& point)
+{
+    out << point.index << ' ' << point.rejectionProbability << ' ' << point.workload << ' '
+        << point.simulated << ' ' << point.requiredRequestsCount << ' ' << point.averageBufferTime << ' '
+        << point.averageServiceTime << ' ' << point.minUtilization << ' ' << point.maxUtilization << ' '
+        << point.rejectionHalfWidth << ' ' << point.averageWaitingTime << ' '
+        << point.waitingTimeHalfWidth << '\n';
+}
+
+bool QS::readSweepPoint(std::istream& in, SweepPointStats& point)
+{
+    std::string line{};
+    if (!std::getline(in, line))
+        return false;
+
+    std::istringstream fields{ line };
+    std::array<std::string, 12> tokens{};
+    for (auto& token : tokens)
+        if (!(fields >> token))
+            return false;
+
+    point.index = std::stoi(tokens[0]);
+    point.rejectionProbability = std::stod(tokens[1]);
+    point.workload = std::stod(tokens[2]);
+    point.simulated = tokens[3] != "0";
+    point.requiredRequestsCount = std::stoi(tokens[4]);
+    point.averageBufferTime = std::stod(tokens[5]);
+    point.averageServiceTime = std::stod(tokens[6]);
+    point.minUtilization = std::stod(tokens[7]);
+    point.maxUtilization = std::stod(tokens[8]);
+    point.rejectionHalfWidth = std::stod(tokens[9]);
+    point.averageWaitingTime = std::stod(tokens[10]);
+    point.waitingTimeHalfWidth = std::stod(tokens[11]);
+    return true;
+}
@@ -0,0 +1,87 @@
+#ifndef DISTRIBUTED_SWEEP_H
+#define DISTRIBUTED_SWEEP_H
+
+#include "queueing_system_research.h"
+
+#include <filesystem>
+#include <string>
+#include <vector>
+#include <ostream>
+#include <istream>
+#include <chrono>
+#include <cstdint>
+
+namespace QueueingSystem
+{
+    inline constexpr const char* SWEEP_WORKER_FLAG{ "--sweep-worker" };
+
+    struct DistributedSweepConfiguration
+    {
+        // Emptied before the sweep and removed after it; empty takes a new
+        // directory under the temporary one for every run
+        std::filesystem::path queueDirectory{};
+        std::filesystem::path workerExecutable{};
+        int workersCount{ 4 };
+        int chunkSize{ 250 };
+        std::chrono::milliseconds heartbeatTimeout{ 60000 };
+        // Time the workers get to exit once stopped, then they are killed and
+        // the coordinator runs their chunks itself
+        std::chrono::milliseconds stopTimeout{ 10000 };
+        // Times a chunk goes back to pending before the coordinator runs it itself
+        int chunkRetriesLimit{ 3 };
+        // Respawns over the whole sweep, then the chunks left run in the coordinator
+        int respawnsLimit{ 16 };
+    };
+
+    // The coordinator splits a sweep into chunk files in queueDirectory/pending,
+    // workers claim them by renaming into queueDirectory/claimed and publish
+    // results into queueDirectory/done. Chunks of dead or silent workers are
+    // moved back to pending and the worker slot is respawned, up to the
+    // limits of the configuration, past which the coordinator simulates the
+    // chunks in-process. A sweep of a trace runs in-process.
+    class SweepCoordinator
+    {
+    public:
+        explicit SweepCoordinator(const DistributedSweepConfiguration& conf);
+
+        std::vector<SweepPointStats> run(const SweepSpec& spec);
+        std::vector<SweepPointStats> operator()(const SweepSpec& spec);
+
+    private:
+        struct WorkerProcess
+        {
+            int slot{};
+            std::intptr_t handle{};
+        };
+
+        void prepareQueue(const SweepSpec& spec, int chunksCount);
+        void spawnWorker(int slot);
+        bool isWorkerAlive(const WorkerProcess& worker) const;
+        void stopWorkers();
+        void requeueClaim(const std::filesystem::path& claim);
+        void requeueClaims(int slot);
+        void requeueStaleClaims();
+        int collectResults(std::vector<SweepPointStats>& points, std::vector<bool>& collected);
+
+        DistributedSweepConfiguration conf_;
+        std::filesystem::path queueDirectory_;
+        std::vector<WorkerProcess> workers_;
+        std::vector<int> chunkRetries_;
+        // Chunks out of retries, taken out of the queue
+        std::vector<int> failedChunks_;
+    };
+
+    std::filesystem::path getCurrentExecutablePath();
+
+    int runSweepWorker(const std::filesystem::path& queueDirectory, int slot);
+
+    // Text form of a chunk of a sweep and of its points, shared by the chunk
+    // files and the simulation service protocol. A job takes four lines and
+    // cannot carry a trace, writeSweepJob throws std::invalid_argument.
+    void writeSweepJob(std::ostream& out, const SweepSpec& spec, int begin, int end);
+    bool readSweepJob(std::istream& in, SweepSpec& spec, int& begin, int& end);
+    void writeSweepPoint(std::ostream& out, const SweepPointStats& point);
+    bool readSweepPoint(std::istream& in, SweepPointStats& point);
+}
+
+#endif
@@ -0,0 +1,645 @@
+#include "distribution.h"
+
+#include <numeric>
+#include <algorithm>
+#include <fstream>
+#include <cmath>
+#include <stdexcept>
+
+namespace QS = QueueingSystem;
+
+namespace
+{
+    constexpr int INVERSE_CDF_TABLE_SIZE{ 4096 };
+    constexpr int STATIONARY_ITERATIONS{ 1000 };
+
+    // Gaussian elimination with partial pivoting, the matrix is small
+    std::vector<double> solveLinearSystem(std::vector<std::vector<double>> matrix, std::vector<double> values)
+    {
+        int size{ static_cast<int>(values.size()) };
+        for (int column{}; column < size; ++column)
+        {
+            int pivot{ column };
+            for (int row{ column + 1 }; row < size; ++row)
+                if (std::abs(matrix[row][column]) > std::abs(matrix[pivot][column]))
+                    pivot = row;
+            std::swap(matrix[column], matrix[pivot]);
+            std::swap(values[column], values[pivot]);
+
+            for (int row{ column + 1 }; row < size; ++row)
+            {
+                double factor{ matrix[row][column] / matrix[column][column] };
+                for (int k{ column }; k < size; ++k)
+                    matrix[row][k] -= factor * matrix[column][k];
+                values[row] -= factor * values[column];
+            }
+        }
+
+        std::vector<double> solution(size);
+        for (int row{ size - 1 }; row >= 0; --row)
+        {
+            double sum{ values[row] };
+            for (int k{ row + 1 }; k < size; ++k)
+                sum -= matrix[row][k] * solution[k];
+            solution[row] = sum / matrix[row][row];
+        }
+        return solution;
+    }
+
+    template <class T>
+    void writeVector(std::ostream& out, const std::vector<T>& values)
+    {
+        out << ' ' << values.size();
+        for (const auto& value : values)
+            out << ' ' << value;
+    }
+
+    template <class T>
+    std::vector<T> readVector(std::istream& in)
+    {
+        std::size_t size{};
+        in >> size;
+        std::vector<T> values(size);
+        for (auto& value : values)
+            in >> value;
+        return values;
+    }
+}
+
+QS::AliasTable::AliasTable(const std::vector<double>& weights):
+    probability_(weights.size()),
+    alias_(weights.size())
+{
+    int size{ static_cast<int>(weights.size()) };
+    double sum{ std::accumulate(weights.cbegin(), weights.cend(), 0.0) };
+
+    std::vector<double> scaled(size);
+    std::vector<int> small{};
+    std::vector<int> large{};
+    for (int i{}; i < size; ++i)
+    {
+        scaled[i] = weights[i] * size / sum;
+        (scaled[i] < 1.0 ? small : large).push_back(i);
+    }
+
+    while (!small.empty() && !large.empty())
+    {
+        int less{ small.back() };
+        small.pop_back();
+        int more{ large.back() };
+
+        probability_[less] = scaled[less];
+        alias_[less] = more;
+
+        scaled[more] -= 1.0 - scaled[less];
+        if (scaled[more] < 1.0)
+        {
+            large.pop_back();
+            small.push_back(more);
+        }
+    }
+
+    for (int i : large)
+        probability_[i] = 1.0;
+    for (int i : small)
+        probability_[i] = 1.0;
+}
+
+int QS::AliasTable::operator()(std::mt19937& generator) const
+{
+    double x{ std::generate_canonical<double, 32>(generator) * probability_.size() };
+    int column{ static_cast<int>(x) };
+    if (column == static_cast<int>(probability_.size()))
+        --column;
+
+    return x - column < probability_[column] ? column : alias_[column];
+}
+
+int QS::AliasTable::getSize() const
+{
+    return probability_.size();
+}
+
+QS::UDistribution QS::readDistribution(std::istream& in)
+{
+    std::string name{};
+    in >> name;
+
+    if (name == "none")
+        return nullptr;
+    if (name == "uniform")
+    {
+        double a{};
+        double b{};
+        in >> a >> b;
+        return std::make_unique<UniformDistribution>(a, b);
+    }
+    if (name == "shifted_exponential")
+    {
+        double shift{};
+        double lambda{};
+        in >> shift >> lambda;
+        return std::make_unique<ShiftedExponentialDistribution>(shift, lambda);
+    }
+    if (name == "erlang")
+    {
+        int k{};
+        double lambda{};
+        in >> k >> lambda;
+        return std::make_unique<ErlangDistribution>(k, lambda);
+    }
+    if (name == "hyperexponential")
+    {
+        auto probabilities{ readVector<double>(in) };
+        auto rates{ readVector<double>(in) };
+        return std::make_unique<HyperexponentialDistribution>(probabilities, rates);
+    }
+    if (name == "lognormal")
+    {
+        double m{};
+        double s{};
+        in >> m >> s;
+        return std::make_unique<LognormalDistribution>(m, s);
+    }
+    if (name == "deterministic")
+    {
+        double value{};
+        in >> value;
+        return std::make_unique<DeterministicDistribution>(value);
+    }
+    if (name == "mmpp")
+    {
+        auto arrivalRates{ readVector<double>(in) };
+        std::vector<std::vector<double>> transitionRates(arrivalRates.size());
+        for (auto& row : transitionRates)
+            row = readVector<double>(in);
+        return std::make_unique<MmppDistribution>(arrivalRates, transitionRates);
+    }
+    if (name == "empirical")
+    {
+        int sampling{};
+        in >> sampling;
+        auto binEdges{ readVector<double>(in) };
+        auto counts{ readVector<double>(in) };
+        return std::make_unique<EmpiricalDistribution>(binEdges, counts,
+            static_cast<EmpiricalSampling>(sampling));
+    }
+
+    throw std::invalid_argument{ "Unknown distribution: " + name };
+}
+
+QS::UniformDistribution::UniformDistribution(double a, double b):
+    distribution_(a, b)
+{}
+
+double QS::UniformDistribution::operator()(std::mt19937& generator)
+{
+    return distribution_(generator);
+}
+
+void QS::UniformDistribution::reset()
+{
+    distribution_.reset();
+}
+
+double QS::UniformDistribution::getMean() const
+{
+    return (distribution_.a() + distribution_.b()) / 2.0;
+}
+
+double QS::UniformDistribution::getVariance() const
+{
+    double width{ distribution_.b() - distribution_.a() };
+    return width * width / 12.0;
+}
+
+QS::UDistribution QS::UniformDistribution::clone() const
+{
+    return std::make_unique<UniformDistribution>(*this);
+}
+
+void QS::UniformDistribution::write(std::ostream& out) const
+{
+    out << "uniform " << distribution_.a() << ' ' << distribution_.b();
+}
+
+double QS::UniformDistribution::getB() const
+{
+    return distribution_.b();
+}
+
+QS::ShiftedExponentialDistribution::ShiftedExponentialDistribution(double shift, double lambda):
+    shift_(shift),
+    distribution_(lambda)
+{}
+
+double QS::ShiftedExponentialDistribution::operator()(std::mt19937& generator)
+{
+    return shift_ + distribution_(generator);
+}
+
+void QS::ShiftedExponentialDistribution::reset()
+{
+    distribution_.reset();
+}
+
+double QS::ShiftedExponentialDistribution::getMean() const
+{
+    return shift_ + 1.0 / distribution_.lambda();
+}
+
+double QS::ShiftedExponentialDistribution::getVariance() const
+{
+    return 1.0 / (distribution_.lambda() * distribution_.lambda());
+}
+
+QS::UDistribution QS::ShiftedExponentialDistribution::clone() const
+{
+    return std::make_unique<ShiftedExponentialDistribution>(*this);
+}
+
+void QS::ShiftedExponentialDistribution::write(std::ostream& out) const
+{
+    out << "shifted_exponential " << shift_ << ' ' << distribution_.lambda();
+}
+
+double QS::ShiftedExponentialDistribution::getLambda() const
+{
+    return distribution_.lambda();
+}
+
+QS::ErlangDistribution::ErlangDistribution(int k, double lambda):
+    k_(k),
+    lambda_(lambda),
+    distribution_(k, 1.0 / lambda)
+{}
+
+double QS::ErlangDistribution::operator()(std::mt19937& generator)
+{
+    return distribution_(generator);
+}
+
+void QS::ErlangDistribution::reset()
+{
+    distribution_.reset();
+}
+
+double QS::ErlangDistribution::getMean() const
+{
+    return k_ / lambda_;
+}
+
+double QS::ErlangDistribution::getVariance() const
+{
+    return k_ / (lambda_ * lambda_);
+}
+
+QS::UDistribution QS::ErlangDistribution::clone() const
+{
+    return std::make_unique<ErlangDistribution>(*this);
+}
+
+void QS::ErlangDistribution::write(std::ostream& out) const
+{
+    out << "erlang " << k_ << ' ' << lambda_;
+}
+
+QS::HyperexponentialDistribution::HyperexponentialDistribution(const std::vector<double>& probabilities,
+    const std::vector<double>& rates):
+    probabilities_(probabilities),
+    rates_(rates),
+    phases_(std::make_shared<AliasTable>(probabilities))
+{}
+
+double QS::HyperexponentialDistribution::operator()(std::mt19937& generator)
+{
+    double rate{ rates_[(*phases_)(generator)] };
+    return -std::log1p(-std::generate_canonical<double, 32>(generator)) / rate;
+}
+
+double QS::HyperexponentialDistribution::getMean() const
+{
+    double sum{ std::accumulate(probabilities_.cbegin(), probabilities_.cend(), 0.0) };
+    double mean{};
+    for (int i{}; i < rates_.size(); ++i)
+        mean += probabilities_[i] / sum / rates_[i];
+    return mean;
+}
+
+double QS::HyperexponentialDistribution::getVariance() const
+{
+    double sum{ std::accumulate(probabilities_.cbegin(), probabilities_.cend(), 0.0) };
+    double secondMoment{};
+    for (int i{}; i < rates_.size(); ++i)
+        secondMoment += probabilities_[i] / sum * 2.0 / (rates_[i] * rates_[i]);
+
+    double mean{ getMean() };
+    return secondMoment - mean * mean;
+}
+
+QS::UDistribution QS::HyperexponentialDistribution::clone() const
+{
+    return std::make_unique<HyperexponentialDistribution>(*this);
+}
+
+void QS::HyperexponentialDistribution::write(std::ostream& out) const
+{
+    out << "hyperexponential";
+    writeVector(out, probabilities_);
+    writeVector(out, rates_);
+}
+
+QS::LognormalDistribution::LognormalDistribution(double m, double s):
+    distribution_(m, s)
+{}
+
+double QS::LognormalDistribution::operator()(std::mt19937& generator)
+{
+    return distribution_(generator);
+}
+
+void QS::LognormalDistribution::reset()
+{
+    distribution_.reset();
+}
+
+double QS::LognormalDistribution::getMean() const
+{
+    return std::exp(distribution_.m() + distribution_.s() * distribution_.s() / 2.0);
+}
+
+double QS::LognormalDistribution::getVariance() const
+{
+    double s2{ distribution_.s() * distribution_.s() };
+    return std::expm1(s2) * std::exp(2.0 * distribution_.m() + s2);
+}
+
+QS::UDistribution QS::LognormalDistribution::clone() const
+{
+    return std::make_unique<LognormalDistribution>(*this);
+}
+
+void QS::LognormalDistribution::write(std::ostream& out) const
+{
+    out << "lognormal " << distribution_.m() << ' ' << distribution_.s();
+}
+
+QS::DeterministicDistribution::DeterministicDistribution(double value):
+    value_(value)
+{}
+
+double QS::DeterministicDistribution::operator()(std::mt19937&)
+{
+    return value_;
+}
+
+double QS::DeterministicDistribution::getMean() const
+{
+    return value_;
+}
+
+double QS::DeterministicDistribution::getVariance() const
+{
+    return 0.0;
+}
+
+QS::UDistribution QS::DeterministicDistribution::clone() const
+{
+    return std::make_unique<DeterministicDistribution>(*this);
+}
+
+void QS::DeterministicDistribution::write(std::ostream& out) const
+{
+    out << "deterministic " << value_;
+}
+
+QS::MmppDistribution::MmppDistribution(const std::vector<double>& arrivalRates,
+    const std::vector<std::vector<double>>& transitionRates):
+    arrivalRates_(arrivalRates),
+    transitionRates_(transitionRates),
+    leavingRates_(arrivalRates.size())
+{
+    std::vector<AliasTable> nextStates{};
+    for (int state{}; state < arrivalRates_.size(); ++state)
+    {
+        auto row{ transitionRates_[state] };
+        row[state] = 0.0;
+        leavingRates_[state] = std::accumulate(row.cbegin(), row.cend(), 0.0);
+        nextStates.emplace_back(leavingRates_[state] > 0.0 ? row : std::vector<double>(1, 1.0));
+    }
+    nextStates_ = std::make_shared<std::vector<AliasTable>>(std::move(nextStates));
+}
+
+double QS::MmppDistribution::operator()(std::mt19937& generator)
+{
+    double elapsed{};
+    while (true)
+    {
+        double arrival{ -std::log1p(-std::generate_canonical<double, 32>(generator)) / arrivalRates_[state_] };
+        if (leavingRates_[state_] == 0.0)
+            return elapsed + arrival;
+
+        double leaving{ -std::log1p(-std::generate_canonical<double, 32>(generator)) / leavingRates_[state_] };
+        if (arrival < leaving)
+            return elapsed + arrival;
+
+        elapsed += leaving;
+        state_ = (*nextStates_)[state_](generator);
+    }
+}
+
+void QS::MmppDistribution::reset()
+{
+    state_ = 0;
+}
+
+double QS::MmppDistribution::getMean() const
+{
+    auto stationary{ getStationaryDistribution() };
+
+    double arrivalRate{};
+    for (int state{}; state < arrivalRates_.size(); ++state)
+        arrivalRate += stationary[state] * arrivalRates_[state];
+    return 1.0 / arrivalRate;
+}
+
+double QS::MmppDistribution::getVariance() const
+{
+    // An interval starts in state i with probability phi_i proportional to
+    // stationary_i * arrivalRates_[i]; with M = -D0 of the MMPP the moments
+    // are E[X^k] = k! phi M^-k 1
+    int statesCount{ static_cast<int>(arrivalRates_.size()) };
+    auto stationary{ getStationaryDistribution() };
+
+    std::vector<double> phi(statesCount);
+    for (int state{}; state < statesCount; ++state)
+        phi[state] = stationary[state] * arrivalRates_[state];
+    double phiSum{ std::accumulate(phi.cbegin(), phi.cend(), 0.0) };
+    for (auto& value : phi)
+        value /= phiSum;
+
+    // Row vectors times M^-1 solve the transposed system
+    std::vector<std::vector<double>> transposed(statesCount, std::vector<double>(statesCount));
+    for (int from{}; from < statesCount; ++from)
+        for (int to{}; to < statesCount; ++to)
+            transposed[to][from] = from == to ? arrivalRates_[from] + leavingRates_[from] :
+                -transitionRates_[from][to];
+
+    auto first{ solveLinearSystem(transposed, phi) };
+    auto second{ solveLinearSystem(transposed, first) };
+
+    double mean{ std::accumulate(first.cbegin(), first.cend(), 0.0) };
+    double secondMoment{ 2.0 * std::accumulate(second.cbegin(), second.cend(), 0.0) };
+    return secondMoment - mean * mean;
+}
+
+std::vector<double> QS::MmppDistribution::getStationaryDistribution() const
+{
+    // Stationary distribution of the uniformized modulating chain
+    int statesCount{ static_cast<int>(arrivalRates_.size()) };
+    double uniformizationRate{ *std::max_element(leavingRates_.cbegin(), leavingRates_.cend()) };
+    if (uniformizationRate == 0.0)
+    {
+        std::vector<double> initial(statesCount, 0.0);
+        initial.front() = 1.0;
+        return initial;
+    }
+
+    std::vector<double> stationary(statesCount, 1.0 / statesCount);
+    for (int iteration{}; iteration < STATIONARY_ITERATIONS; ++iteration)
+    {
+        std::vector<double> next(statesCount);
+        for (int from{}; from < statesCount; ++from)
+        {
+            next[from] += stationary[from] * (1.0 - leavingRates_[from] / uniformizationRate);
+            for (int to{}; to < statesCount; ++to)
+                if (to != from)
+                    next[to] += stationary[from] * transitionRates_[from][to] / uniformizationRate;
+        }
+        stationary = next;
+    }
+    return stationary;
+}
+
+QS::UDistribution QS::MmppDistribution::clone() const
+{
+    return std::make_unique<MmppDistribution>(*this);
+}
+
+void QS::MmppDistribution::write(std::ostream& out) const
+{
+    out << "mmpp";
+    writeVector(out, arrivalRates_);
+    for (const auto& row : transitionRates_)
+        writeVector(out, row);
+}
+
+QS::EmpiricalDistribution::EmpiricalDistribution(const std::vector<double>& binEdges,
+    const std::vector<double>& counts, EmpiricalSampling sampling):
+    binEdges_(binEdges),
+    counts_(counts),
+    sampling_(sampling)
+{
+    Tables tables{};
+    tables.bins = AliasTable{ counts_ };
+
+    double total{ std::accumulate(counts_.cbegin(), counts_.cend(), 0.0) };
+    tables.quantiles.resize(INVERSE_CDF_TABLE_SIZE + 1);
+
+    int bin{};
+    double cumulative{};
+    for (int i{}; i <= INVERSE_CDF_TABLE_SIZE; ++i)
+    {
+        double target{ total * i / INVERSE_CDF_TABLE_SIZE };
+        while (bin < static_cast<int>(counts_.size()) - 1 && cumulative + counts_[bin] < target)
+            cumulative += counts_[bin++];
+
+        double inBin{ counts_[bin] > 0.0 ? (target - cumulative) / counts_[bin] : 0.0 };
+        tables.quantiles[i] = binEdges_[bin] + std::min(inBin, 1.0) * (binEdges_[bin + 1] - binEdges_[bin]);
+    }
+
+    tables_ = std::make_shared<Tables>(std::move(tables));
+}
+
+double QS::EmpiricalDistribution::operator()(std::mt19937& generator)
+{
+    double u{ std::generate_canonical<double, 32>(generator) };
+
+    if (sampling_ == EmpiricalSampling::aliasTable)
+    {
+        int bin{ tables_->bins(generator) };
+        return binEdges_[bin] + u * (binEdges_[bin + 1] - binEdges_[bin]);
+    }
+    else //EmpiricalSampling::inverseCdfTable
+    {
+        const auto& quantiles{ tables_->quantiles };
+        double x{ u * INVERSE_CDF_TABLE_SIZE };
+        int i{ static_cast<int>(x) };
+        if (i == INVERSE_CDF_TABLE_SIZE)
+            return quantiles.back();
+        return quantiles[i] + (x - i) * (quantiles[i + 1] - quantiles[i]);
+    }
+}
+
+double QS::EmpiricalDistribution::getMean() const
+{
+    double total{ std::accumulate(counts_.cbegin(), counts_.cend(), 0.0) };
+    double mean{};
+    for (int bin{}; bin < counts_.size(); ++bin)
+        mean += counts_[bin] / total * (binEdges_[bin] + binEdges_[bin + 1]) / 2.0;
+    return mean;
+}
+
+double QS::EmpiricalDistribution::getVariance() const
+{
+    double total{ std::accumulate(counts_.cbegin(), counts_.cend(), 0.0) };
+    double secondMoment{};
+    for (int bin{}; bin < counts_.size(); ++bin)
+    {
+        double a{ binEdges_[bin] };
+        double b{ binEdges_[bin + 1] };
+        secondMoment += counts_[bin] / total * (a * a + a * b + b * b) / 3.0;
+    }
+
+    double mean{ getMean() };
+    return secondMoment - mean * mean;
+}
+
+QS::UDistribution QS::EmpiricalDistribution::clone() const
+{
+    return std::make_unique<EmpiricalDistribution>(*this);
+}
+
+void QS::EmpiricalDistribution::write(std::ostream& out) const
+{
+    out << "empirical " << static_cast<int>(sampling_);
+    writeVector(out, binEdges_);
+    writeVector(out, counts_);
+}
+
+std::unique_ptr<QS::EmpiricalDistribution> QS::readHistogram(const std::string& path,
+    EmpiricalSampling sampling)
+{
+    std::ifstream in{ path };
+
+    std::vector<double> binEdges{};
+    std::vector<double> counts{};
+    double lower{};
+    double upper{};
+    double count{};
+    while (in >> lower >> upper >> count)
+    {
+        // Every row starts where the previous one ends
+        if (binEdges.empty())
+            binEdges.push_back(lower);
+        else if (lower != binEdges.back())
+            throw std::invalid_argument{ "Histogram bins are not contiguous: " + path };
+        binEdges.push_back(upper);
+        counts.push_back(count);
+    }
+
+    if (counts.empty())
+        throw std::invalid_argument{ "Empty histogram: " + path };
+
+    return std::make_unique<EmpiricalDistribution>(binEdges, counts, sampling);
+}
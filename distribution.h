@@ -0,0 +1,218 @@
+#ifndef DISTRIBUTION_H
+#define DISTRIBUTION_H
+
+#include <random>
+#include <memory>
+#include <vector>
+#include <string>
+#include <istream>
+#include <ostream>
+
+namespace QueueingSystem
+{
+    // Vose alias table: draws index i with probability weights[i] / sum(weights)
+    // using one uniform variate.
+    class AliasTable
+    {
+    public:
+        AliasTable() = default;
+        explicit AliasTable(const std::vector<double>& weights);
+
+        int operator()(std::mt19937& generator) const;
+
+        int getSize() const;
+
+    private:
+        std::vector<double> probability_;
+        std::vector<int> alias_;
+    };
+
+    class Distribution
+    {
+    public:
+        virtual ~Distribution() = default;
+
+        virtual double operator()(std::mt19937& generator) = 0;
+        virtual void reset() {}
+
+        virtual double getMean() const = 0;
+        virtual double getVariance() const = 0;
+
+        virtual std::unique_ptr<Distribution> clone() const = 0;
+        virtual void write(std::ostream& out) const = 0;
+    };
+
+    using UDistribution = std::unique_ptr<Distribution>;
+    using SDistribution = std::shared_ptr<const Distribution>;
+
+    // Reads a distribution written by Distribution::write, "none" gives nullptr
+    UDistribution readDistribution(std::istream& in);
+
+    class UniformDistribution : public Distribution
+    {
+    public:
+        UniformDistribution(double a, double b);
+
+        double operator()(std::mt19937& generator) override;
+        void reset() override;
+        double getMean() const override;
+        double getVariance() const override;
+        UDistribution clone() const override;
+        void write(std::ostream& out) const override;
+
+        double getB() const;
+
+    private:
+        std::uniform_real_distribution<double> distribution_;
+    };
+
+    class ShiftedExponentialDistribution : public Distribution
+    {
+    public:
+        ShiftedExponentialDistribution(double shift, double lambda);
+
+        double operator()(std::mt19937& generator) override;
+        void reset() override;
+        double getMean() const override;
+        double getVariance() const override;
+        UDistribution clone() const override;
+        void write(std::ostream& out) const override;
+
+        double getLambda() const;
+
+    private:
+        double shift_;
+        std::exponential_distribution<double> distribution_;
+    };
+
+    class ErlangDistribution : public Distribution
+    {
+    public:
+        ErlangDistribution(int k, double lambda);
+
+        double operator()(std::mt19937& generator) override;
+        void reset() override;
+        double getMean() const override;
+        double getVariance() const override;
+        UDistribution clone() const override;
+        void write(std::ostream& out) const override;
+
+    private:
+        int k_;
+        double lambda_;
+        std::gamma_distribution<double> distribution_;
+    };
+
+    class HyperexponentialDistribution : public Distribution
+    {
+    public:
+        HyperexponentialDistribution(const std::vector<double>& probabilities,
+            const std::vector<double>& rates);
+
+        double operator()(std::mt19937& generator) override;
+        double getMean() const override;
+        double getVariance() const override;
+        UDistribution clone() const override;
+        void write(std::ostream& out) const override;
+
+    private:
+        std::vector<double> probabilities_;
+        std::vector<double> rates_;
+        std::shared_ptr<const AliasTable> phases_;
+    };
+
+    class LognormalDistribution : public Distribution
+    {
+    public:
+        LognormalDistribution(double m, double s);
+
+        double operator()(std::mt19937& generator) override;
+        void reset() override;
+        double getMean() const override;
+        double getVariance() const override;
+        UDistribution clone() const override;
+        void write(std::ostream& out) const override;
+
+    private:
+        std::lognormal_distribution<double> distribution_;
+    };
+
+    class DeterministicDistribution : public Distribution
+    {
+    public:
+        explicit DeterministicDistribution(double value);
+
+        double operator()(std::mt19937& generator) override;
+        double getMean() const override;
+        double getVariance() const override;
+        UDistribution clone() const override;
+        void write(std::ostream& out) const override;
+
+    private:
+        double value_;
+    };
+
+    // Inter-arrival times of a Markov-modulated Poisson process: arrivals with
+    // rate arrivalRates[i] while the modulating chain is in state i, the chain
+    // leaves state i for j with rate transitionRates[i][j].
+    class MmppDistribution : public Distribution
+    {
+    public:
+        MmppDistribution(const std::vector<double>& arrivalRates,
+            const std::vector<std::vector<double>>& transitionRates);
+
+        double operator()(std::mt19937& generator) override;
+        void reset() override;
+        double getMean() const override;
+        double getVariance() const override;
+        UDistribution clone() const override;
+        void write(std::ostream& out) const override;
+
+    private:
+        std::vector<double> getStationaryDistribution() const;
+
+        std::vector<double> arrivalRates_;
+        std::vector<std::vector<double>> transitionRates_;
+        std::vector<double> leavingRates_;
+        std::shared_ptr<const std::vector<AliasTable>> nextStates_;
+        int state_{};
+    };
+
+    enum class EmpiricalSampling
+    {
+        aliasTable,
+        inverseCdfTable,
+    };
+
+    // Piecewise-uniform distribution over histogram bins. Both sampling tables
+    // are built once and shared by the clones, a sample is a table lookup.
+    class EmpiricalDistribution : public Distribution
+    {
+    public:
+        EmpiricalDistribution(const std::vector<double>& binEdges, const std::vector<double>& counts,
+            EmpiricalSampling sampling = EmpiricalSampling::aliasTable);
+
+        double operator()(std::mt19937& generator) override;
+        double getMean() const override;
+        double getVariance() const override;
+        UDistribution clone() const override;
+        void write(std::ostream& out) const override;
+
+    private:
+        struct Tables
+        {
+            AliasTable bins{};
+            std::vector<double> quantiles{};
+        };
+
+        std::vector<double> binEdges_;
+        std::vector<double> counts_;
+        EmpiricalSampling sampling_;
+        std::shared_ptr<const Tables> tables_;
+    };
+
+    std::unique_ptr<EmpiricalDistribution> readHistogram(const std::string& path,
+        EmpiricalSampling sampling = EmpiricalSampling::aliasTable);
+}
+
+#endif
@@ -0,0 +1,110 @@
+#include "downsampling.h"
+
+#include <cmath>
+#include <algorithm>
+
+namespace QS = QueueingSystem;
+
+void QS::downsampleLttb(const float* xs, const float* ys, std::size_t count, std::size_t threshold,
+    std::vector<float>& outXs, std::vector<float>& outYs)
+{
+    outXs.clear();
+    outYs.clear();
+    if (threshold >= count || threshold < 3)
+    {
+        outXs.assign(xs, xs + count);
+        outYs.assign(ys, ys + count);
+        return;
+    }
+
+    outXs.reserve(threshold);
+    outYs.reserve(threshold);
+    outXs.push_back(xs[0]);
+    outYs.push_back(ys[0]);
+
+    double bucketSize{ static_cast<double>(count - 2) / (threshold - 2) };
+    std::size_t kept{ 0 };
+    for (std::size_t bucket{ 0 }; bucket < threshold - 2; ++bucket)
+    {
+        auto first{ static_cast<std::size_t>(bucket * bucketSize) + 1 };
+        auto last{ static_cast<std::size_t>((bucket + 1) * bucketSize) + 1 };
+
+        // Mean of the next bucket, the last point for the last bucket
+        auto nextFirst{ last };
+        auto nextLast{ std::max(std::min(static_cast<std::size_t>((bucket + 2) * bucketSize) + 1, count - 1),
+            nextFirst + 1) };
+        double nextX{};
+        double nextY{};
+        for (auto i{ nextFirst }; i < nextLast; ++i)
+        {
+            nextX += xs[i];
+            nextY += ys[i];
+        }
+        nextX /= nextLast - nextFirst;
+        nextY /= nextLast - nextFirst;
+
+        double largestArea{ -1.0 };
+        std::size_t selected{ first };
+        for (auto i{ first }; i < last; ++i)
+        {
+            double area{ std::abs((xs[kept] - nextX) * (ys[i] - ys[kept]) -
+                (xs[kept] - xs[i]) * (nextY - ys[kept])) };
+            if (area > largestArea)
+            {
+                largestArea = area;
+                selected = i;
+            }
+        }
+
+        outXs.push_back(xs[selected]);
+        outYs.push_back(ys[selected]);
+        kept = selected;
+    }
+
+    outXs.push_back(xs[count - 1]);
+    outYs.push_back(ys[count - 1]);
+}
+
+void QS::downsampleMinMax(const float* xs, const float* ys, std::size_t count, std::size_t bucketsCount,
+    std::vector<float>& outXs, std::vector<float>& outYs)
+{
+    outXs.clear();
+    outYs.clear();
+    if (2 * bucketsCount >= count || !bucketsCount)
+    {
+        outXs.assign(xs, xs + count);
+        outYs.assign(ys, ys + count);
+        return;
+    }
+
+    outXs.reserve(2 * bucketsCount);
+    outYs.reserve(2 * bucketsCount);
+    double bucketSize{ static_cast<double>(count) / bucketsCount };
+    for (std::size_t bucket{ 0 }; bucket < bucketsCount; ++bucket)
+    {
+        auto first{ static_cast<std::size_t>(bucket * bucketSize) };
+        auto last{ std::min(static_cast<std::size_t>((bucket + 1) * bucketSize), count) };
+        if (first == last)
+            continue;
+
+        std::size_t min{ first };
+        std::size_t max{ first };
+        for (auto i{ first + 1 }; i < last; ++i)
+        {
+            if (ys[i] < ys[min])
+                min = i;
+            if (ys[i] > ys[max])
+                max = i;
+        }
+
+        auto left{ min < max ? min : max };
+        auto right{ min < max ? max : min };
+        outXs.push_back(xs[left]);
+        outYs.push_back(ys[left]);
+        if (right != left)
+        {
+            outXs.push_back(xs[right]);
+            outYs.push_back(ys[right]);
+        }
+    }
+}
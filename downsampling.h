@@ -0,0 +1,25 @@
+#ifndef DOWNSAMPLING_H
+#define DOWNSAMPLING_H
+
+#include <vector>
+#include <cstddef>
+
+namespace QueueingSystem
+{
+    // Curves are reduced to the points a plot of the given width can show.
+    // Both take points ordered by x and replace the contents of the outputs.
+
+    // Largest-Triangle-Three-Buckets: the first and the last point are kept,
+    // the rest is split into threshold - 2 buckets, and of every bucket the
+    // point spanning the largest triangle with the last kept one and the mean
+    // of the next bucket is taken. Keeps the shape of noisy curves.
+    void downsampleLttb(const float* xs, const float* ys, std::size_t count, std::size_t threshold,
+        std::vector<float>& outXs, std::vector<float>& outYs);
+
+    // The smallest and the largest y of every bucket in the order they come,
+    // so the envelope of the curve is exact. Up to 2 * bucketsCount points.
+    void downsampleMinMax(const float* xs, const float* ys, std::size_t count, std::size_t bucketsCount,
+        std::vector<float>& outXs, std::vector<float>& outYs);
+}
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef ENGINE_OBSERVER_H
+#define ENGINE_OBSERVER_H
+
+#include "request.h"
+
+namespace QueueingSystem
+{
+    // Observer of the event loop of BasicQueueingSystem, given as its last
+    // template argument. Any type with these member functions will do; they
+    // are called directly, so the empty ones of NullObserver inline away
+    // together with whatever the engine computes only for them.
+    struct NullObserver
+    {
+        // A source generated the request
+        void onArrival(const Request& /*request*/, double /*time*/) {}
+        // The request took a place in the buffer
+        void onBufferInsert(const Request& /*request*/, double /*time*/) {}
+        // The request was pushed out of a full buffer and is lost
+        void onEviction(const Request& /*request*/, double /*time*/) {}
+        // The request left the buffer for the device until endTime
+        void onDispatch(const Request& /*request*/, int /*deviceId*/, double /*startTime*/,
+            double /*endTime*/) {}
+        // The device finished the request
+        void onServiceCompletion(const Request& /*request*/, int /*deviceId*/, double /*startTime*/,
+            double /*endTime*/) {}
+    };
+
+    // Whether the observer needs the whole request at onServiceCompletion.
+    // If not, the engine keeps only the source id of each device's request.
+    template <class Observer>
+    inline constexpr bool needsCompletedRequest{ true };
+
+    template <>
+    inline constexpr bool needsCompletedRequest<NullObserver>{ false };
+}
+
+#endif
@@ -0,0 +1,410 @@
+#ifndef ENGINE_POLICIES_H
+#define ENGINE_POLICIES_H
+
+#include "queueing_system.h"
+#include "event_set.h"
+
+#include <vector>
+#include <random>
+#include <algorithm>
+
+namespace QueueingSystem
+{
+    // Arrival policy: inter-generation times of every source. Policies draw
+    // from one stream for all their entities, which keeps copies small.
+    class UniformArrivalPolicy
+    {
+    public:
+        void reset(const SystemConfiguration& conf)
+        {
+            nextGenerationTime_.resize(conf.sourcesCount);
+            distribution_ = std::uniform_real_distribution<double>{ 0.0, conf.distrRange };
+
+            std::fill(nextGenerationTime_.begin(), nextGenerationTime_.end(), 0.0);
+        }
+
+        int getNextSource() const
+        {
+            return static_cast<int>(std::min_element(nextGenerationTime_.cbegin(),
+                nextGenerationTime_.cend()) - nextGenerationTime_.cbegin());
+        }
+
+        double getNextGenerationTime(int sourceId) const
+        {
+            return nextGenerationTime_[sourceId];
+        }
+
+        double generate(int sourceId)
+        {
+            double generationTime{ nextGenerationTime_[sourceId] };
+            nextGenerationTime_[sourceId] += distribution_(generator_);
+            return generationTime;
+        }
+
+        void reseed(std::mt19937& seeder)
+        {
+            generator_.seed(seeder());
+        }
+
+    private:
+        std::vector<double> nextGenerationTime_;
+        std::mt19937 generator_{ std::random_device{}() };
+        std::uniform_real_distribution<double> distribution_;
+    };
+
+    // Service policy: processing time of the request started on a device.
+    class ShiftedExponentialServicePolicy
+    {
+    public:
+        void reset(const SystemConfiguration& conf)
+        {
+            distribution_ = std::exponential_distribution<double>{ conf.lambda };
+        }
+
+        double getProcessingTime(int /*deviceId*/)
+        {
+            return MIN_PROCESSING_TIME + distribution_(generator_);
+        }
+
+        void reseed(std::mt19937& seeder)
+        {
+            generator_.seed(seeder());
+        }
+
+    private:
+        std::mt19937 generator_{ std::random_device{}() };
+        std::exponential_distribution<double> distribution_;
+    };
+
+    inline std::vector<UDistribution> cloneDistributions(const std::vector<UDistribution>& distributions)
+    {
+        std::vector<UDistribution> clones{};
+        clones.reserve(distributions.size());
+        for (const auto& distribution : distributions)
+            clones.push_back(distribution->clone());
+        return clones;
+    }
+
+    // Arrival policy for SystemConfiguration::arrivalDistribution, one clone of
+    // the distribution per source.
+    class DistributionArrivalPolicy
+    {
+    public:
+        DistributionArrivalPolicy() = default;
+
+        DistributionArrivalPolicy(const DistributionArrivalPolicy& other):
+            nextGenerationTime_(other.nextGenerationTime_),
+            generator_(other.generator_),
+            distributions_(cloneDistributions(other.distributions_)),
+            prototype_(other.prototype_),
+            distrRange_(other.distrRange_)
+        {}
+
+        DistributionArrivalPolicy& operator=(const DistributionArrivalPolicy& other)
+        {
+            nextGenerationTime_ = other.nextGenerationTime_;
+            generator_ = other.generator_;
+            distributions_ = cloneDistributions(other.distributions_);
+            prototype_ = other.prototype_;
+            distrRange_ = other.distrRange_;
+            return *this;
+        }
+
+        void reset(const SystemConfiguration& conf)
+        {
+            nextGenerationTime_.assign(conf.sourcesCount, 0.0);
+
+            if (conf.arrivalDistribution != prototype_ || distrRange_ != conf.distrRange ||
+                static_cast<int>(distributions_.size()) != conf.sourcesCount)
+            {
+                prototype_ = conf.arrivalDistribution;
+                distrRange_ = conf.distrRange;
+                distributions_.resize(conf.sourcesCount);
+                for (auto& distribution : distributions_)
+                    distribution = prototype_ ? prototype_->clone() :
+                        std::make_unique<UniformDistribution>(0.0, conf.distrRange);
+            }
+            else
+                for (const auto& distribution : distributions_)
+                    distribution->reset();
+        }
+
+        int getNextSource() const
+        {
+            return static_cast<int>(std::min_element(nextGenerationTime_.cbegin(),
+                nextGenerationTime_.cend()) - nextGenerationTime_.cbegin());
+        }
+
+        double getNextGenerationTime(int sourceId) const
+        {
+            return nextGenerationTime_[sourceId];
+        }
+
+        double generate(int sourceId)
+        {
+            double generationTime{ nextGenerationTime_[sourceId] };
+            nextGenerationTime_[sourceId] += (*distributions_[sourceId])(generator_);
+            return generationTime;
+        }
+
+        void reseed(std::mt19937& seeder)
+        {
+            generator_.seed(seeder());
+        }
+
+    private:
+        std::vector<double> nextGenerationTime_;
+        std::mt19937 generator_{ std::random_device{}() };
+        std::vector<UDistribution> distributions_;
+        SDistribution prototype_;
+        double distrRange_{};
+    };
+
+    // Service policy for SystemConfiguration::serviceDistribution, one clone of
+    // the distribution per device.
+    class DistributionServicePolicy
+    {
+    public:
+        DistributionServicePolicy() = default;
+
+        DistributionServicePolicy(const DistributionServicePolicy& other):
+            generator_(other.generator_),
+            distributions_(cloneDistributions(other.distributions_)),
+            prototype_(other.prototype_),
+            lambda_(other.lambda_)
+        {}
+
+        DistributionServicePolicy& operator=(const DistributionServicePolicy& other)
+        {
+            generator_ = other.generator_;
+            distributions_ = cloneDistributions(other.distributions_);
+            prototype_ = other.prototype_;
+            lambda_ = other.lambda_;
+            return *this;
+        }
+
+        void reset(const SystemConfiguration& conf)
+        {
+            if (conf.serviceDistribution != prototype_ || lambda_ != conf.lambda ||
+                static_cast<int>(distributions_.size()) != conf.devicesCount)
+            {
+                prototype_ = conf.serviceDistribution;
+                lambda_ = conf.lambda;
+                distributions_.resize(conf.devicesCount);
+                for (auto& distribution : distributions_)
+                    distribution = prototype_ ? prototype_->clone() :
+                        std::make_unique<ShiftedExponentialDistribution>(MIN_PROCESSING_TIME, conf.lambda);
+            }
+            else
+                for (const auto& distribution : distributions_)
+                    distribution->reset();
+        }
+
+        double getProcessingTime(int deviceId)
+        {
+            return (*distributions_[deviceId])(generator_);
+        }
+
+        void reseed(std::mt19937& seeder)
+        {
+            generator_.seed(seeder());
+        }
+
+    private:
+        std::mt19937 generator_{ std::random_device{}() };
+        std::vector<UDistribution> distributions_;
+        SDistribution prototype_;
+        double lambda_{};
+    };
+
+    // Arrival and service policies with a stream per entity, like the Source
+    // and Device objects of QueueingSystem; reseed goes in the same order, so
+    // the engine follows a QueueingSystem reseeded from an equal seeder
+    class EntityStreamArrivalPolicy
+    {
+    public:
+        EntityStreamArrivalPolicy() = default;
+
+        EntityStreamArrivalPolicy(const EntityStreamArrivalPolicy& other):
+            nextGenerationTime_(other.nextGenerationTime_),
+            generators_(other.generators_),
+            distributions_(cloneDistributions(other.distributions_))
+        {}
+
+        EntityStreamArrivalPolicy& operator=(const EntityStreamArrivalPolicy& other)
+        {
+            nextGenerationTime_ = other.nextGenerationTime_;
+            generators_ = other.generators_;
+            distributions_ = cloneDistributions(other.distributions_);
+            return *this;
+        }
+
+        void reset(const SystemConfiguration& conf)
+        {
+            nextGenerationTime_.assign(conf.sourcesCount, 0.0);
+            generators_.resize(conf.sourcesCount);
+            distributions_.resize(conf.sourcesCount);
+            for (auto& distribution : distributions_)
+                distribution = conf.arrivalDistribution ? conf.arrivalDistribution->clone() :
+                    std::make_unique<UniformDistribution>(0.0, conf.distrRange);
+        }
+
+        int getNextSource() const
+        {
+            return static_cast<int>(std::min_element(nextGenerationTime_.cbegin(),
+                nextGenerationTime_.cend()) - nextGenerationTime_.cbegin());
+        }
+
+        double getNextGenerationTime(int sourceId) const
+        {
+            return nextGenerationTime_[sourceId];
+        }
+
+        double generate(int sourceId)
+        {
+            double generationTime{ nextGenerationTime_[sourceId] };
+            nextGenerationTime_[sourceId] += (*distributions_[sourceId])(generators_[sourceId]);
+            return generationTime;
+        }
+
+        void reseed(std::mt19937& seeder)
+        {
+            for (auto& generator : generators_)
+                generator.seed(seeder());
+        }
+
+    private:
+        std::vector<double> nextGenerationTime_;
+        std::vector<std::mt19937> generators_;
+        std::vector<UDistribution> distributions_;
+    };
+
+    class EntityStreamServicePolicy
+    {
+    public:
+        EntityStreamServicePolicy() = default;
+
+        EntityStreamServicePolicy(const EntityStreamServicePolicy& other):
+            generators_(other.generators_),
+            distributions_(cloneDistributions(other.distributions_))
+        {}
+
+        EntityStreamServicePolicy& operator=(const EntityStreamServicePolicy& other)
+        {
+            generators_ = other.generators_;
+            distributions_ = cloneDistributions(other.distributions_);
+            return *this;
+        }
+
+        void reset(const SystemConfiguration& conf)
+        {
+            generators_.resize(conf.devicesCount);
+            distributions_.resize(conf.devicesCount);
+            for (auto& distribution : distributions_)
+                distribution = conf.serviceDistribution ? conf.serviceDistribution->clone() :
+                    std::make_unique<ShiftedExponentialDistribution>(MIN_PROCESSING_TIME, conf.lambda);
+        }
+
+        double getProcessingTime(int deviceId)
+        {
+            return (*distributions_[deviceId])(generators_[deviceId]);
+        }
+
+        void reseed(std::mt19937& seeder)
+        {
+            for (auto& generator : generators_)
+                generator.seed(seeder());
+        }
+
+    private:
+        std::vector<std::mt19937> generators_;
+        std::vector<UDistribution> distributions_;
+    };
+
+    // Buffer policy: the discipline of Buffer on plain Request values. A full
+    // buffer rejects the request in the last position, the request of the
+    // source with the smallest id is selected first.
+    class SourcePriorityBufferPolicy
+    {
+    public:
+        void reset(const SystemConfiguration& conf)
+        {
+            requests_.resize(conf.bufferSize);
+            requestsCount_ = 0;
+        }
+
+        bool placeRequest(const Request& request, Request& rejectedRequest)
+        {
+            if (requestsCount_ != static_cast<int>(requests_.size()))
+            {
+                requests_[requestsCount_++] = request;
+                return true;
+            }
+
+            rejectedRequest = requests_.back();
+            requests_.back() = request;
+            return false;
+        }
+
+        Request selectRequest()
+        {
+            auto bufferStart{ requests_.begin() };
+            auto requestIter{ std::min_element(bufferStart, bufferStart + requestsCount_) };
+            auto request{ *requestIter };
+
+            std::rotate(requestIter, requestIter + 1, bufferStart + requestsCount_);
+            --requestsCount_;
+
+            return request;
+        }
+
+        bool isEmpty() const
+        {
+            return !requestsCount_;
+        }
+
+        int getOccupancy() const
+        {
+            return requestsCount_;
+        }
+
+    private:
+        std::vector<Request> requests_;
+        int requestsCount_{};
+    };
+
+    // Dispatch policy: the first free device starting from the one after the
+    // previously loaded device.
+    class RoundRobinDispatchPolicy
+    {
+    public:
+        void reset(const SystemConfiguration&)
+        {
+            deviceIndex_ = 0;
+        }
+
+        int selectDevice(const std::vector<double>& devicesEndTime)
+        {
+            int devicesCount{ static_cast<int>(devicesEndTime.size()) };
+            auto isDeviceFree = [](double endTime) { return endTime == NO_EVENT_TIME; };
+
+            auto begin{ devicesEndTime.cbegin() };
+            auto it{ std::find_if(begin + deviceIndex_, devicesEndTime.cend(), isDeviceFree) };
+            if (it == devicesEndTime.cend())
+            {
+                it = std::find_if(begin, begin + deviceIndex_, isDeviceFree);
+                if (it == begin + deviceIndex_)
+                    return devicesCount;
+            }
+
+            int freeDeviceIndex{ static_cast<int>(it - begin) };
+            deviceIndex_ = freeDeviceIndex < devicesCount - 1 ? freeDeviceIndex + 1 : 0;
+            return freeDeviceIndex;
+        }
+
+    private:
+        int deviceIndex_{};
+    };
+}
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef ENTITY_POOL_H
+#define ENTITY_POOL_H
+
+#include <vector>
+#include <memory>
+#include <cstddef>
+
+namespace QueueingSystem
+{
+    // Resizes the active entities without destroying any: removed ones are
+    // parked in spare and taken back last out first, so an entity keeps its
+    // index and a sweep over the count constructs each of them once.
+    // make(index) builds an entity the pool does not have yet.
+    template <class Entity, class Make>
+    void resizeFromPool(std::vector<std::unique_ptr<Entity>>& active,
+        std::vector<std::unique_ptr<Entity>>& spare, std::size_t size, Make make)
+    {
+        while (active.size() > size)
+        {
+            spare.push_back(std::move(active.back()));
+            active.pop_back();
+        }
+
+        while (active.size() < size)
+        {
+            if (spare.empty())
+                active.push_back(make(active.size()));
+            else
+            {
+                active.push_back(std::move(spare.back()));
+                spare.pop_back();
+            }
+        }
+    }
+}
+
+#endif
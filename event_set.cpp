@@ -0,0 +1,390 @@
+#include "event_set.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+
+namespace QS = QueueingSystem;
+
+namespace
+{
+    constexpr std::size_t MIN_BUCKETS_COUNT{ 2 };
+    constexpr std::size_t WIDTH_SAMPLE_SIZE{ 25 };
+    constexpr int RETUNE_PERIOD{ 1024 };
+    constexpr std::size_t RETUNE_SEARCH_COST{ 16 };
+    constexpr int LINEAR_BENCHMARK_LIMIT{ 10000 };
+}
+
+QS::UEventSet QS::makeEventSet(EventSetType type, int size)
+{
+    switch (type)
+    {
+    case EventSetType::binaryHeap:
+        return std::make_unique<BinaryHeapEventSet>(size);
+    case EventSetType::calendarQueue:
+        return std::make_unique<CalendarQueueEventSet>(size);
+    default: //EventSetType::linear
+        return std::make_unique<LinearEventSet>(size);
+    }
+}
+
+QS::LinearEventSet::LinearEventSet(int size):
+    times_(size, NO_EVENT_TIME)
+{}
+
+void QS::LinearEventSet::update(int index, double time)
+{
+    times_[index] = time;
+}
+
+void QS::LinearEventSet::clear()
+{
+    std::fill(times_.begin(), times_.end(), NO_EVENT_TIME);
+}
+
+void QS::LinearEventSet::resize(int size)
+{
+    times_.assign(size, NO_EVENT_TIME);
+}
+
+int QS::LinearEventSet::getNextIndex()
+{
+    auto it{ std::min_element(times_.cbegin(), times_.cend()) };
+    return it == times_.cend() || *it == NO_EVENT_TIME ? NO_EVENT : static_cast<int>(it - times_.cbegin());
+}
+
+QS::BinaryHeapEventSet::BinaryHeapEventSet(int size):
+    times_(size, NO_EVENT_TIME),
+    positions_(size, NO_EVENT)
+{
+    heap_.reserve(size);
+}
+
+void QS::BinaryHeapEventSet::update(int index, double time)
+{
+    int position{ positions_[index] };
+    times_[index] = time;
+
+    if (time == NO_EVENT_TIME)
+    {
+        if (position != NO_EVENT)
+            remove(position);
+    }
+    else if (position == NO_EVENT)
+    {
+        positions_[index] = static_cast<int>(heap_.size());
+        heap_.push_back(index);
+        siftUp(positions_[index]);
+    }
+    else
+    {
+        siftUp(position);
+        siftDown(positions_[index]);
+    }
+}
+
+void QS::BinaryHeapEventSet::clear()
+{
+    for (int index : heap_)
+    {
+        times_[index] = NO_EVENT_TIME;
+        positions_[index] = NO_EVENT;
+    }
+    heap_.clear();
+}
+
+void QS::BinaryHeapEventSet::resize(int size)
+{
+    clear();
+    times_.resize(size, NO_EVENT_TIME);
+    positions_.resize(size, NO_EVENT);
+    heap_.reserve(size);
+}
+
+int QS::BinaryHeapEventSet::getNextIndex()
+{
+    return heap_.empty() ? NO_EVENT : heap_.front();
+}
+
+bool QS::BinaryHeapEventSet::isEarlier(int left, int right) const
+{
+    return times_[left] < times_[right] || (times_[left] == times_[right] && left < right);
+}
+
+void QS::BinaryHeapEventSet::siftUp(int position)
+{
+    while (position > 0)
+    {
+        int parent{ (position - 1) / 2 };
+        if (!isEarlier(heap_[position], heap_[parent]))
+            break;
+
+        swap(position, parent);
+        position = parent;
+    }
+}
+
+void QS::BinaryHeapEventSet::siftDown(int position)
+{
+    int size{ static_cast<int>(heap_.size()) };
+    while (true)
+    {
+        int earliest{ position };
+        for (int child{ 2 * position + 1 }; child <= 2 * position + 2 && child < size; ++child)
+            if (isEarlier(heap_[child], heap_[earliest]))
+                earliest = child;
+
+        if (earliest == position)
+            break;
+
+        swap(position, earliest);
+        position = earliest;
+    }
+}
+
+void QS::BinaryHeapEventSet::swap(int left, int right)
+{
+    std::swap(heap_[left], heap_[right]);
+    positions_[heap_[left]] = left;
+    positions_[heap_[right]] = right;
+}
+
+void QS::BinaryHeapEventSet::remove(int position)
+{
+    positions_[heap_[position]] = NO_EVENT;
+    heap_[position] = heap_.back();
+    heap_.pop_back();
+
+    if (position < static_cast<int>(heap_.size()))
+    {
+        int index{ heap_[position] };
+        positions_[index] = position;
+        siftUp(position);
+        siftDown(positions_[index]);
+    }
+}
+
+QS::CalendarQueueEventSet::CalendarQueueEventSet(int size):
+    heads_(MIN_BUCKETS_COUNT, NO_EVENT),
+    events_(size)
+{}
+
+void QS::CalendarQueueEventSet::update(int index, double time)
+{
+    if (events_[index].time != NO_EVENT_TIME)
+        remove(index);
+
+    if (time != NO_EVENT_TIME)
+        insert(index, time);
+
+    if (eventsCount_ > 2 * heads_.size())
+        resizeBuckets(2 * heads_.size());
+    else if (heads_.size() > MIN_BUCKETS_COUNT && eventsCount_ < heads_.size() / 2)
+        resizeBuckets(heads_.size() / 2);
+}
+
+void QS::CalendarQueueEventSet::clear()
+{
+    // The calendar grows again from the new events, re-estimating the width
+    heads_.assign(MIN_BUCKETS_COUNT, NO_EVENT);
+    std::fill(events_.begin(), events_.end(), Event{});
+    eventsCount_ = 0;
+    currentDay_ = 0;
+    searchesCount_ = 0;
+    searchCost_ = 0;
+}
+
+void QS::CalendarQueueEventSet::resize(int size)
+{
+    clear();
+    events_.resize(size);
+}
+
+int QS::CalendarQueueEventSet::getNextIndex()
+{
+    if (!eventsCount_)
+        return NO_EVENT;
+
+    // The width estimated on the last resize stops fitting when the spacing of
+    // events drifts, then the scans get long and the calendar is rebuilt
+    if (++searchesCount_ == RETUNE_PERIOD)
+    {
+        if (searchCost_ > RETUNE_SEARCH_COST * RETUNE_PERIOD)
+            resizeBuckets(heads_.size());
+        searchesCount_ = 0;
+        searchCost_ = 0;
+    }
+
+    // No event is earlier than currentDay_, so the first day of the year
+    // having events holds the earliest one
+    for (std::size_t i{ 0 }; i < heads_.size(); ++i)
+    {
+        std::int64_t day{ currentDay_ + static_cast<std::int64_t>(i) };
+        int next{ NO_EVENT };
+        for (int index{ getHead(day) }; index != NO_EVENT; index = events_[index].next)
+        {
+            ++searchCost_;
+            if (events_[index].day == day && (next == NO_EVENT || isEarlier(index, next)))
+                next = index;
+        }
+        ++searchCost_;
+
+        if (next != NO_EVENT)
+        {
+            currentDay_ = day;
+            return next;
+        }
+    }
+
+    // Sparse year: direct search over all the events
+    searchCost_ += eventsCount_;
+
+    int next{ NO_EVENT };
+    for (int head : heads_)
+        for (int index{ head }; index != NO_EVENT; index = events_[index].next)
+            if (next == NO_EVENT || isEarlier(index, next))
+                next = index;
+
+    currentDay_ = events_[next].day;
+    return next;
+}
+
+bool QS::CalendarQueueEventSet::isEarlier(int left, int right) const
+{
+    return events_[left].time < events_[right].time ||
+        (events_[left].time == events_[right].time && left < right);
+}
+
+std::int64_t QS::CalendarQueueEventSet::getDay(double time) const
+{
+    return static_cast<std::int64_t>(std::floor(time / width_));
+}
+
+int& QS::CalendarQueueEventSet::getHead(std::int64_t day)
+{
+    return heads_[static_cast<std::size_t>(day) & (heads_.size() - 1)];
+}
+
+void QS::CalendarQueueEventSet::insert(int index, double time)
+{
+    std::int64_t day{ getDay(time) };
+    int& head{ getHead(day) };
+
+    events_[index] = Event{ time, day, head, NO_EVENT };
+    if (head != NO_EVENT)
+        events_[head].previous = index;
+    head = index;
+
+    if (!eventsCount_++ || day < currentDay_)
+        currentDay_ = day;
+}
+
+void QS::CalendarQueueEventSet::remove(int index)
+{
+    auto& event{ events_[index] };
+    if (event.previous != NO_EVENT)
+        events_[event.previous].next = event.next;
+    else
+        getHead(event.day) = event.next;
+    if (event.next != NO_EVENT)
+        events_[event.next].previous = event.previous;
+
+    event = Event{};
+    --eventsCount_;
+}
+
+void QS::CalendarQueueEventSet::resizeBuckets(std::size_t bucketsCount)
+{
+    width_ = estimateWidth();
+
+    std::vector<int> indices{};
+    indices.reserve(eventsCount_);
+    for (int head : heads_)
+        for (int index{ head }; index != NO_EVENT; index = events_[index].next)
+            indices.push_back(index);
+
+    heads_.assign(bucketsCount, NO_EVENT);
+    eventsCount_ = 0;
+    for (int index : indices)
+        insert(index, events_[index].time);
+}
+
+double QS::CalendarQueueEventSet::estimateWidth() const
+{
+    std::vector<double> times{};
+    times.reserve(eventsCount_);
+    for (const auto& event : events_)
+        if (event.time != NO_EVENT_TIME)
+            times.push_back(event.time);
+
+    std::size_t sampleSize{ std::min(WIDTH_SAMPLE_SIZE, times.size()) };
+    if (sampleSize < 2)
+        return width_;
+
+    std::nth_element(times.begin(), times.begin() + (sampleSize - 1), times.end());
+    std::sort(times.begin(), times.begin() + sampleSize);
+
+    // Brown: three times the mean separation of the earliest events, leaving
+    // out separations over twice the first estimate
+    double average{ (times[sampleSize - 1] - times[0]) / (sampleSize - 1) };
+    double separationsSum{};
+    int separationsCount{};
+    for (std::size_t i{ 1 }; i < sampleSize; ++i)
+        if (double separation{ times[i] - times[i - 1] }; separation <= 2.0 * average)
+        {
+            separationsSum += separation;
+            ++separationsCount;
+        }
+
+    double width{ separationsCount ? 3.0 * separationsSum / separationsCount : 0.0 };
+    return width > 0.0 ? width : width_;
+}
+
+QS::EventSetBenchmarkResult QS::benchmarkEventSet(EventSetType type, int eventsCount, int holdsCount)
+{
+    std::mt19937 generator{ 1 };
+    std::exponential_distribution<double> delay{ 1.0 };
+
+    auto eventSet{ makeEventSet(type, eventsCount) };
+    std::vector<double> times(eventsCount);
+    for (int i{ 0 }; i < eventsCount; ++i)
+    {
+        times[i] = delay(generator);
+        eventSet->update(i, times[i]);
+    }
+
+    auto start{ std::chrono::steady_clock::now() };
+    for (int i{ 0 }; i < holdsCount; ++i)
+    {
+        int index{ eventSet->getNextIndex() };
+        times[index] += delay(generator) * eventsCount;
+        eventSet->update(index, times[index]);
+    }
+    std::chrono::duration<double, std::nano> duration{ std::chrono::steady_clock::now() - start };
+
+    return EventSetBenchmarkResult{ type, eventsCount, duration.count() / holdsCount };
+}
+
+int QS::runEventSetBenchmark(std::ostream& out, int holdsCount)
+{
+    out << std::setw(10) << "events" << std::setw(14) << "linear, ns" << std::setw(14) << "heap, ns"
+        << std::setw(14) << "calendar, ns" << '\n';
+
+    for (int eventsCount{ 100 }; eventsCount <= 1000000; eventsCount *= 10)
+    {
+        out << std::setw(10) << eventsCount << std::fixed << std::setprecision(1);
+        for (auto type : { EventSetType::linear, EventSetType::binaryHeap, EventSetType::calendarQueue })
+        {
+            if (type == EventSetType::linear && eventsCount > LINEAR_BENCHMARK_LIMIT)
+                out << std::setw(14) << '-';
+            else
+                out << std::setw(14) << benchmarkEventSet(type, eventsCount, holdsCount).holdTime;
+        }
+        out << std::endl;
+    }
+
+    return 0;
+}
@@ -0,0 +1,139 @@
+#ifndef EVENT_SET_H
+#define EVENT_SET_H
+
+#include <vector>
+#include <memory>
+#include <limits>
+#include <cstdint>
+#include <ostream>
+
+namespace QueueingSystem
+{
+    inline constexpr double NO_EVENT_TIME{ std::numeric_limits<double>::infinity() };
+    inline constexpr int NO_EVENT{ -1 };
+    inline constexpr const char* EVENT_SET_BENCHMARK_FLAG{ "--benchmark-event-sets" };
+
+    enum class EventSetType
+    {
+        linear,
+        binaryHeap,
+        calendarQueue,
+    };
+
+    // Pending event times of a fixed number of entities. An entity with
+    // NO_EVENT_TIME has no event; equal times are ordered by entity index.
+    class EventSet
+    {
+    public:
+        virtual ~EventSet() = default;
+
+        virtual void update(int index, double time) = 0;
+        virtual void clear() = 0;
+        // Changes the number of entities, pending events are dropped
+        virtual void resize(int size) = 0;
+
+        // Entity of the earliest event or NO_EVENT
+        virtual int getNextIndex() = 0;
+    };
+
+    using UEventSet = std::unique_ptr<EventSet>;
+
+    UEventSet makeEventSet(EventSetType type, int size);
+
+    class LinearEventSet : public EventSet
+    {
+    public:
+        explicit LinearEventSet(int size);
+
+        void update(int index, double time) override;
+        void clear() override;
+        void resize(int size) override;
+        int getNextIndex() override;
+
+    private:
+        std::vector<double> times_;
+    };
+
+    class BinaryHeapEventSet : public EventSet
+    {
+    public:
+        explicit BinaryHeapEventSet(int size);
+
+        void update(int index, double time) override;
+        void clear() override;
+        void resize(int size) override;
+        int getNextIndex() override;
+
+    private:
+        bool isEarlier(int left, int right) const;
+        void siftUp(int position);
+        void siftDown(int position);
+        void swap(int left, int right);
+        void remove(int position);
+
+        std::vector<double> times_;
+        std::vector<int> heap_;
+        std::vector<int> positions_;
+    };
+
+    // Brown's calendar queue: a year of buckets of equal width, the number of
+    // buckets follows the number of events and the width is re-estimated from
+    // the spacing of the earliest events on every resize or when searches get
+    // long, so hold operations take amortized O(1).
+    class CalendarQueueEventSet : public EventSet
+    {
+    public:
+        explicit CalendarQueueEventSet(int size);
+
+        void update(int index, double time) override;
+        void clear() override;
+        void resize(int size) override;
+        int getNextIndex() override;
+
+    private:
+        // Events of the same day (time / width_ rounded down) share a bucket,
+        // days of a year map to the buckets cyclically. A bucket is a list
+        // threaded through the events, so an event is unlinked in O(1).
+        struct Event
+        {
+            double time{ NO_EVENT_TIME };
+            std::int64_t day{};
+            int next{ NO_EVENT };
+            int previous{ NO_EVENT };
+        };
+
+        bool isEarlier(int left, int right) const;
+        std::int64_t getDay(double time) const;
+        int& getHead(std::int64_t day);
+        void insert(int index, double time);
+        void remove(int index);
+        void resizeBuckets(std::size_t bucketsCount);
+        double estimateWidth() const;
+
+        // First event of every bucket or NO_EVENT
+        std::vector<int> heads_;
+        std::vector<Event> events_;
+        double width_{ 1.0 };
+        std::size_t eventsCount_{};
+        std::int64_t currentDay_{};
+        int searchesCount_{};
+        std::size_t searchCost_{};
+    };
+
+    struct EventSetBenchmarkResult
+    {
+        EventSetType type{};
+        int eventsCount{};
+        double holdTime{};
+    };
+
+    // Classic hold model: eventsCount pending events, every hold removes the
+    // earliest and schedules it again an exponential delay later.
+    // holdTime is the mean time of one hold in nanoseconds.
+    EventSetBenchmarkResult benchmarkEventSet(EventSetType type, int eventsCount, int holdsCount);
+
+    // Table of hold times for 10^2..10^6 events, the linear scan up to 10^4
+    int runEventSetBenchmark(std::ostream& out, int holdsCount);
+}
+
+#endif
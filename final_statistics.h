@@ -1,7 +1,11 @@
 #ifndef FINAL_STATISTICS_H
 #define FINAL_STATISTICS_H
 
+#include "latency_histogram.h"
+#include "time_windows.h"
+
 #include <memory>
+#include <vector>
 
 namespace QueueingSystem
 {
@@ -14,6 +18,10 @@ namespace QueueingSystem
         double averageProcessingTime{};
         double bufferTimeDispersion{};
         double serviceTimeDispersion{};
+        // Time from arrival to service start, of every served request
+        LatencyHistogram waitingTimeHistogram{};
+        // Time from arrival to service end
+        LatencyHistogram sojournTimeHistogram{};
     };
 
     struct DeviceFinalStats
@@ -23,6 +31,18 @@ namespace QueueingSystem
         double utilizationFactor{};
     };
 
+    // Steady-state mean of a series after warm-up truncation, halfWidth is the
+    // 95% batch-means confidence half-width (infinite while data is short)
+    // over batchesCount batches of batchSize observations
+    struct SteadyStateEstimate
+    {
+        double mean{};
+        double halfWidth{};
+        long long warmupCount{};
+        int batchesCount{};
+        long long batchSize{};
+    };
+
     using USourceFinalStats = std::unique_ptr<SourceFinalStats>;
     using UDeviceFinalStats = std::unique_ptr<DeviceFinalStats>;
 
@@ -33,6 +53,13 @@ namespace QueueingSystem
         double rejectionProbability{};
         double workload{};
         int requiredRequestsCount{};
+        SteadyStateEstimate rejectionEstimate{};
+        SteadyStateEstimate waitingTimeEstimate{};
+        // Merged over the sources, empty for engines that do not record them
+        LatencyHistogram waitingTimeHistogram{};
+        LatencyHistogram sojournTimeHistogram{};
+        // Arrivals, rejections, busy time and buffer occupancy over the model time
+        std::vector<TimeWindow> timeWindows{};
     };
 
     using USystemFinalStats = std::unique_ptr<SystemFinalStats>;
@@ -0,0 +1,130 @@
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace QS = QueueingSystem;
+
+namespace
+{
+    constexpr int SUB_BUCKETS_COUNT{ 1 << QS::HISTOGRAM_SUB_BUCKET_BITS };
+    constexpr int HALF_SUB_BUCKETS_COUNT{ SUB_BUCKETS_COUNT / 2 };
+    constexpr auto MAX_UNITS{ static_cast<std::uint64_t>(QS::HISTOGRAM_MAX_VALUE / QS::HISTOGRAM_RESOLUTION) };
+}
+
+void QS::LatencyHistogram::record(double value)
+{
+    value = std::max(value, 0.0);
+    auto units{ std::min(static_cast<std::uint64_t>(value / HISTOGRAM_RESOLUTION), MAX_UNITS) };
+    auto index{ static_cast<std::size_t>(getBucketIndex(units)) };
+    if (index >= counts_.size())
+        counts_.resize(index + 1);
+    ++counts_[index];
+
+    min_ = count_ ? std::min(min_, value) : value;
+    max_ = count_ ? std::max(max_, value) : value;
+    sum_ += value;
+    ++count_;
+}
+
+void QS::LatencyHistogram::merge(const LatencyHistogram& other)
+{
+    if (!other.count_)
+        return;
+
+    if (counts_.size() < other.counts_.size())
+        counts_.resize(other.counts_.size());
+    for (std::size_t i{ 0 }; i < other.counts_.size(); ++i)
+        counts_[i] += other.counts_[i];
+
+    min_ = count_ ? std::min(min_, other.min_) : other.min_;
+    max_ = count_ ? std::max(max_, other.max_) : other.max_;
+    sum_ += other.sum_;
+    count_ += other.count_;
+}
+
+void QS::LatencyHistogram::reset()
+{
+    std::fill(counts_.begin(), counts_.end(), 0);
+    count_ = 0;
+    min_ = 0.0;
+    max_ = 0.0;
+    sum_ = 0.0;
+}
+
+long long QS::LatencyHistogram::getCount() const
+{
+    return count_;
+}
+
+double QS::LatencyHistogram::getMin() const
+{
+    return min_;
+}
+
+double QS::LatencyHistogram::getMax() const
+{
+    return max_;
+}
+
+double QS::LatencyHistogram::getMean() const
+{
+    return count_ ? sum_ / count_ : 0.0;
+}
+
+double QS::LatencyHistogram::getPercentile(double percentile) const
+{
+    if (!count_)
+        return 0.0;
+
+    auto rank{ static_cast<long long>(std::ceil(percentile / 100.0 * count_)) };
+    rank = std::clamp(rank, 1LL, count_);
+
+    long long counted{};
+    for (std::size_t i{ 0 }; i < counts_.size(); ++i)
+    {
+        counted += static_cast<long long>(counts_[i]);
+        if (counted >= rank)
+            return std::clamp(getBucketUpperBound(static_cast<int>(i)), min_, max_);
+    }
+    return max_;
+}
+
+std::vector<std::pair<double, double>> QS::LatencyHistogram::getCdf() const
+{
+    std::vector<std::pair<double, double>> cdf{};
+    long long counted{};
+    for (std::size_t i{ 0 }; i < counts_.size(); ++i)
+    {
+        if (!counts_[i])
+            continue;
+        counted += static_cast<long long>(counts_[i]);
+        cdf.emplace_back(std::clamp(getBucketUpperBound(static_cast<int>(i)), min_, max_),
+            static_cast<double>(counted) / count_);
+    }
+    return cdf;
+}
+
+std::size_t QS::LatencyHistogram::getMemorySize() const
+{
+    return sizeof(*this) + counts_.capacity() * sizeof(std::uint64_t);
+}
+
+// Units below SUB_BUCKETS_COUNT map to themselves. Above, the units are
+// shifted until HISTOGRAM_SUB_BUCKET_BITS bits remain, and every shift adds
+// an octave of HALF_SUB_BUCKETS_COUNT buckets.
+int QS::LatencyHistogram::getBucketIndex(std::uint64_t units)
+{
+    if (units < SUB_BUCKETS_COUNT)
+        return static_cast<int>(units);
+
+    int shift{ std::ilogb(static_cast<double>(units)) - (HISTOGRAM_SUB_BUCKET_BITS - 1) };
+    return shift * HALF_SUB_BUCKETS_COUNT + static_cast<int>(units >> shift);
+}
+
+double QS::LatencyHistogram::getBucketUpperBound(int index)
+{
+    int shift{ std::max(index / HALF_SUB_BUCKETS_COUNT - 1, 0) };
+    auto subBucket{ static_cast<std::uint64_t>(index - shift * HALF_SUB_BUCKETS_COUNT) };
+    return static_cast<double>((subBucket + 1) << shift) * HISTOGRAM_RESOLUTION;
+}
@@ -0,0 +1,57 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <vector>
+#include <utility>
+#include <cstdint>
+#include <cstddef>
+
+namespace QueueingSystem
+{
+    // Smallest time told apart from zero
+    inline constexpr double HISTOGRAM_RESOLUTION{ 1e-3 };
+    // Larger times are counted in the last bucket, their exact maximum is kept
+    inline constexpr double HISTOGRAM_MAX_VALUE{ 1e9 };
+    // 2^(bits - 1) buckets per octave, a bucket is within 1/64 of its values
+    inline constexpr int HISTOGRAM_SUB_BUCKET_BITS{ 7 };
+    inline constexpr double REPORTED_PERCENTILES[]{ 50.0, 90.0, 95.0, 99.0, 99.9 };
+
+    // Log-linear histogram of times in the manner of HdrHistogram: below
+    // 2^bits resolution units the buckets are one unit wide, above they
+    // double in width every octave. Recording is an index computation and an
+    // increment; the buckets grow up to the largest value seen, so memory is
+    // bounded by HISTOGRAM_MAX_VALUE whatever the number of records.
+    // Histograms of different sources, runs or threads merge by adding counts.
+    class LatencyHistogram
+    {
+    public:
+        void record(double value);
+        void merge(const LatencyHistogram& other);
+        void reset();
+
+        long long getCount() const;
+        double getMin() const;
+        double getMax() const;
+        double getMean() const;
+
+        // Value at least percentile percent of the records are not above,
+        // the upper bound of its bucket clamped to the recorded range
+        double getPercentile(double percentile) const;
+        // Upper bound of every occupied bucket with the share of records not above it
+        std::vector<std::pair<double, double>> getCdf() const;
+
+        std::size_t getMemorySize() const;
+
+    private:
+        static int getBucketIndex(std::uint64_t units);
+        static double getBucketUpperBound(int index);
+
+        std::vector<std::uint64_t> counts_;
+        long long count_{};
+        double min_{};
+        double max_{};
+        double sum_{};
+    };
+}
+
+#endif
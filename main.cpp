@@ -2,6 +2,16 @@
 #include "statistics.h"
 #include "queueing_system_gui.h"
 #include "queueing_system_research.h"
+#include "distributed_sweep.h"
+#include "event_set.h"
+#include "replications.h"
+#include "simulation_timeline.h"
+#include "telemetry.h"
+#include "simulation_service.h"
+#include "differential_oracle.h"
+#include "process_model.h"
+#include "parallel_queueing_system.h"
+#include "rare_event_splitting.h"
 
 #include <imgui.h>
 #include <implot.h>
@@ -12,14 +22,61 @@
 //#include <vld.h>
 #include <iostream>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <random>
+#include <cstdint>
 
 static void glfw_error_callback(int error, const char* description)
 {
     fprintf(stderr, "GLFW Error %d: %s\n", error, description);
 }
 
-int main()
+int main(int argc, char* argv[])
 {
+    namespace QS = QueueingSystem;
+    namespace QSGui = QueueingSystemGui;
+
+    if (argc > 3 && std::string_view{ argv[1] } == QS::SWEEP_WORKER_FLAG)
+        return QS::runSweepWorker(argv[2], std::stoi(argv[3]));
+
+    if (argc > 1 && std::string_view{ argv[1] } == QS::SIMULATION_SERVICE_FLAG)
+    {
+        QS::SimulationServiceConfiguration serviceConf{};
+        if (argc > 2)
+            serviceConf.socketPath = argv[2];
+        return QS::runSimulationService(serviceConf);
+    }
+
+    if (argc > 2 && std::string_view{ argv[1] } == QS::SERVICE_SWEEP_FLAG)
+        return QS::runServiceSweep(std::cout, static_cast<QS::SweepKind>(std::stoi(argv[2])));
+
+    // Slot 0 and the default 4 workers
+    if (argc > 1 && std::string_view{ argv[1] } == QS::TELEMETRY_TOP_FLAG)
+        return QS::runTelemetryTop(std::cout, argc > 2 ? std::stoi(argv[2]) : 5);
+
+    if (argc > 1 && std::string_view{ argv[1] } == QS::EVENT_SET_BENCHMARK_FLAG)
+        return QS::runEventSetBenchmark(std::cout, argc > 2 ? std::stoi(argv[2]) : 1000000);
+
+    if (argc > 1 && std::string_view{ argv[1] } == QS::APPROXIMATION_REPORT_FLAG)
+        return QS::runApproximationReport(std::cout, argc > 2 ? std::stoi(argv[2]) : 25);
+
+    if (argc > 1 && std::string_view{ argv[1] } == QS::REPLICATIONS_BENCHMARK_FLAG)
+        return QS::runReplicationsBenchmark(std::cout, argc > 2 ? std::stoi(argv[2]) : 64);
+
+    if (argc > 1 && std::string_view{ argv[1] } == QS::PROCESS_BENCHMARK_FLAG)
+        return QS::runProcessBenchmark(std::cout, argc > 2 ? std::stoi(argv[2]) : 1000000);
+
+    if (argc > 1 && std::string_view{ argv[1] } == QS::PARALLEL_BENCHMARK_FLAG)
+        return QS::runParallelBenchmark(std::cout, argc > 2 ? std::stoi(argv[2]) : 100000);
+
+    if (argc > 1 && std::string_view{ argv[1] } == QS::SPLITTING_REPORT_FLAG)
+        return QS::runSplittingReport(std::cout, argc > 2 ? std::stoi(argv[2]) : QS::DEFAULT_SPLITTING_LEVELS);
+
+    if (argc > 1 && std::string_view{ argv[1] } == QS::DIFFERENTIAL_ORACLE_FLAG)
+        return QS::runDifferentialOracle(std::cout, argc > 2 ? std::stoi(argv[2]) : 200,
+            argc > 3 ? static_cast<std::uint32_t>(std::stoul(argv[3])) : std::random_device{}());
+
     glfwSetErrorCallback(glfw_error_callback);
     if (!glfwInit())
         return 1;
@@ -49,11 +106,9 @@ int main()
     IM_ASSERT(font != nullptr);
     auto clear_color{ ImVec4(0.45f, 0.55f, 0.60f, 1.00f) };
 
-    namespace QS = QueueingSystem;
-    namespace QSGui = QueueingSystemGui;
-
     auto systemConf{ std::make_unique<QS::SystemConfiguration>() };
     auto system{ std::make_unique<QS::QueueingSystem>(*systemConf)};
+    auto timeline{ std::make_unique<QS::SimulationTimeline>(*system) };
 
     auto systemStatus{ std::make_unique<QS::SystemStatus>(system->getSystemStatus()) };
     QS::USystemFinalStats systemFinalStats{};
@@ -68,12 +123,16 @@ int main()
         ImGui_ImplGlfw_NewFrame();
         ImGui::NewFrame();
 
-        QSGui::configuration(*system, *systemConf, *systemStatus);
+        QSGui::configuration(*timeline, *systemConf, *systemStatus);
 
-        QSGui::controls(*system, showResultsWindow, systemFinalStats);
+        QSGui::controls(*timeline, *systemConf, showResultsWindow, systemFinalStats);
 
         QSGui::stepStatistics(*systemStatus);
 
+        QSGui::busyTimeline(timeline->getBusyTimeline(), timeline->getTime());
+
+        QSGui::timeWindows(system->getTimeWindows(), system->getDevicesCount());
+
         if (showResultsWindow)
             QSGui::finalStatistics(*systemFinalStats, showResultsWindow);
 
@@ -0,0 +1,206 @@
+#include "mapped_file.h"
+
+#include <stdexcept>
+#include <algorithm>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace QS = QueueingSystem;
+
+#ifdef _WIN32
+
+QS::MappedFile::MappedFile(const std::filesystem::path& path, MappingMode mode)
+{
+    bool readOnly{ mode == MappingMode::readOnly };
+
+    HANDLE file{ CreateFileW(path.c_str(), readOnly ? GENERIC_READ : GENERIC_READ | GENERIC_WRITE,
+        FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr) };
+    if (file == INVALID_HANDLE_VALUE)
+        throw std::runtime_error{ "Cannot open " + path.string() };
+    file_ = reinterpret_cast<std::intptr_t>(file);
+
+    LARGE_INTEGER size{};
+    GetFileSizeEx(file, &size);
+    size_ = static_cast<std::size_t>(size.QuadPart);
+    if (!size_)
+        return;
+
+    HANDLE mapping{ CreateFileMappingW(file, nullptr, readOnly ? PAGE_READONLY : PAGE_READWRITE,
+        0, 0, nullptr) };
+    if (!mapping)
+    {
+        close();
+        throw std::runtime_error{ "Cannot map " + path.string() };
+    }
+    mapping_ = reinterpret_cast<std::intptr_t>(mapping);
+
+    data_ = static_cast<std::byte*>(MapViewOfFile(mapping, readOnly ? FILE_MAP_READ : FILE_MAP_WRITE,
+        0, 0, 0));
+    if (!data_)
+    {
+        close();
+        throw std::runtime_error{ "Cannot map " + path.string() };
+    }
+}
+
+void QS::MappedFile::close()
+{
+    if (data_)
+        UnmapViewOfFile(data_);
+    if (mapping_)
+        CloseHandle(reinterpret_cast<HANDLE>(mapping_));
+    if (file_ != -1)
+        CloseHandle(reinterpret_cast<HANDLE>(file_));
+
+    data_ = nullptr;
+    size_ = 0;
+    mapping_ = 0;
+    file_ = -1;
+}
+
+void QS::MappedFile::adviseSequential() const
+{}
+
+void QS::MappedFile::prefetch(std::size_t offset, std::size_t length) const
+{
+    if (offset >= size_)
+        return;
+
+    WIN32_MEMORY_RANGE_ENTRY range{ data_ + offset, std::min(length, size_ - offset) };
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+void QS::MappedFile::release(std::size_t offset, std::size_t length) const
+{
+    if (offset >= size_)
+        return;
+
+    // Unlocking pages that are not locked removes them from the working set
+    VirtualUnlock(data_ + offset, std::min(length, size_ - offset));
+}
+
+#else
+
+namespace
+{
+    std::size_t getPageSize()
+    {
+        static const std::size_t pageSize{ static_cast<std::size_t>(sysconf(_SC_PAGESIZE)) };
+        return pageSize;
+    }
+}
+
+QS::MappedFile::MappedFile(const std::filesystem::path& path, MappingMode mode)
+{
+    bool readOnly{ mode == MappingMode::readOnly };
+
+    int file{ open(path.c_str(), readOnly ? O_RDONLY : O_RDWR) };
+    if (file == -1)
+        throw std::runtime_error{ "Cannot open " + path.string() };
+    file_ = file;
+
+    struct stat status{};
+    fstat(file, &status);
+    size_ = static_cast<std::size_t>(status.st_size);
+    if (!size_)
+        return;
+
+    void* data{ mmap(nullptr, size_, readOnly ? PROT_READ : PROT_READ | PROT_WRITE, MAP_SHARED, file, 0) };
+    if (data == MAP_FAILED)
+    {
+        close();
+        throw std::runtime_error{ "Cannot map " + path.string() };
+    }
+    data_ = static_cast<std::byte*>(data);
+}
+
+void QS::MappedFile::close()
+{
+    if (data_)
+        munmap(data_, size_);
+    if (file_ != -1)
+        ::close(static_cast<int>(file_));
+
+    data_ = nullptr;
+    size_ = 0;
+    file_ = -1;
+}
+
+void QS::MappedFile::adviseSequential() const
+{
+    if (data_)
+        madvise(data_, size_, MADV_SEQUENTIAL);
+}
+
+void QS::MappedFile::prefetch(std::size_t offset, std::size_t length) const
+{
+    if (offset >= size_)
+        return;
+
+    std::size_t begin{ offset / getPageSize() * getPageSize() };
+    madvise(data_ + begin, std::min(offset + length, size_) - begin, MADV_WILLNEED);
+}
+
+void QS::MappedFile::release(std::size_t offset, std::size_t length) const
+{
+    if (offset >= size_)
+        return;
+
+    // Only whole pages inside the range are dropped, they are read again on access
+    std::size_t begin{ (offset + getPageSize() - 1) / getPageSize() * getPageSize() };
+    std::size_t end{ std::min(offset + length, size_) / getPageSize() * getPageSize() };
+    if (begin < end)
+        madvise(data_ + begin, end - begin, MADV_DONTNEED);
+}
+
+#endif
+
+QS::MappedFile::~MappedFile()
+{
+    close();
+}
+
+QS::MappedFile::MappedFile(MappedFile&& other) noexcept:
+    data_(std::exchange(other.data_, nullptr)),
+    size_(std::exchange(other.size_, 0)),
+    file_(std::exchange(other.file_, -1)),
+    mapping_(std::exchange(other.mapping_, 0))
+{}
+
+QS::MappedFile& QS::MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        close();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        file_ = std::exchange(other.file_, -1);
+        mapping_ = std::exchange(other.mapping_, 0);
+    }
+    return *this;
+}
+
+const std::byte* QS::MappedFile::getData() const
+{
+    return data_;
+}
+
+std::byte* QS::MappedFile::getData()
+{
+    return data_;
+}
+
+std::size_t QS::MappedFile::getSize() const
+{
+    return size_;
+}
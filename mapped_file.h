@@ -0,0 +1,49 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <filesystem>
+#include <cstddef>
+#include <cstdint>
+
+namespace QueueingSystem
+{
+    enum class MappingMode
+    {
+        readOnly,
+        readWrite,
+    };
+
+    // Whole file mapped into the address space. Pages are loaded on access, so
+    // the file may be larger than the physical memory; prefetch and release let
+    // a sequential reader keep its resident window small.
+    class MappedFile
+    {
+    public:
+        MappedFile() = default;
+        MappedFile(const std::filesystem::path& path, MappingMode mode = MappingMode::readOnly);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile& operator=(const MappedFile&) = delete;
+        MappedFile(MappedFile&& other) noexcept;
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        const std::byte* getData() const;
+        std::byte* getData();
+        std::size_t getSize() const;
+
+        void adviseSequential() const;
+        void prefetch(std::size_t offset, std::size_t length) const;
+        void release(std::size_t offset, std::size_t length) const;
+
+    private:
+        void close();
+
+        std::byte* data_{};
+        std::size_t size_{};
+        std::intptr_t file_{ -1 };
+        std::intptr_t mapping_{};
+    };
+}
+
+#endif
@@ -0,0 +1,137 @@
+#include "output_analysis.h"
+
+#include <array>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace QS = QueueingSystem;
+
+namespace
+{
+    // Two-sided 95% quantiles of Student's t for 1..30 degrees of freedom
+    constexpr std::array<double, 30> T_QUANTILES{
+        12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+        2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+        2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042
+    };
+}
+
+double QS::getStudentQuantile(int degreesOfFreedom)
+{
+    return degreesOfFreedom <= static_cast<int>(T_QUANTILES.size()) ? T_QUANTILES[degreesOfFreedom - 1] : 1.96;
+}
+
+QS::BatchedSeries::BatchedSeries(int capacity):
+    capacity_(capacity)
+{
+    batchesMean_.reserve(capacity);
+}
+
+void QS::BatchedSeries::add(double value)
+{
+    ++count_;
+    currentSum_ += value;
+    if (++currentCount_ < batchSize_)
+        return;
+
+    batchesMean_.push_back(currentSum_ / batchSize_);
+    currentSum_ = 0.0;
+    currentCount_ = 0;
+
+    if (static_cast<int>(batchesMean_.size()) == capacity_)
+        compact();
+}
+
+void QS::BatchedSeries::reset()
+{
+    batchesMean_.clear();
+    batchSize_ = MSER_BATCH_SIZE;
+    currentSum_ = 0.0;
+    currentCount_ = 0;
+    count_ = 0;
+}
+
+long long QS::BatchedSeries::getCount() const
+{
+    return count_;
+}
+
+QS::SteadyStateEstimate QS::BatchedSeries::getEstimate() const
+{
+    int batchesCount{ static_cast<int>(batchesMean_.size()) };
+    if (batchesCount < 2)
+    {
+        double sum{ currentSum_ };
+        for (double mean : batchesMean_)
+            sum += mean * batchSize_;
+        return SteadyStateEstimate{ count_ ? sum / count_ : 0.0,
+            std::numeric_limits<double>::infinity(), 0, 0, 0 };
+    }
+
+    // MSER: the truncation d minimizing the squared error of the mean over
+    // batches d..k-1 divided by (k - d)^2, searched over the first half
+    std::vector<double> suffixSum(batchesCount + 1, 0.0);
+    std::vector<double> suffixSquaresSum(batchesCount + 1, 0.0);
+    for (int i{ batchesCount - 1 }; i >= 0; --i)
+    {
+        suffixSum[i] = suffixSum[i + 1] + batchesMean_[i];
+        suffixSquaresSum[i] = suffixSquaresSum[i + 1] + batchesMean_[i] * batchesMean_[i];
+    }
+
+    int truncation{};
+    double minStatistic{ std::numeric_limits<double>::infinity() };
+    for (int d{ 0 }; d <= batchesCount / 2; ++d)
+    {
+        double n{ static_cast<double>(batchesCount - d) };
+        double statistic{ (suffixSquaresSum[d] - suffixSum[d] * suffixSum[d] / n) / (n * n) };
+        if (statistic < minStatistic)
+        {
+            minStatistic = statistic;
+            truncation = d;
+        }
+    }
+
+    // Batch means: the kept batches regrouped into equal confidence batches,
+    // the few left over go to the warm-up
+    int keptCount{ batchesCount - truncation };
+    int groupsCount{ std::min(CONFIDENCE_BATCHES_COUNT, keptCount) };
+    int groupSize{ keptCount / groupsCount };
+    truncation = batchesCount - groupsCount * groupSize;
+
+    std::vector<double> groupsMean(groupsCount, 0.0);
+    for (int i{ truncation }; i < batchesCount; ++i)
+        groupsMean[(i - truncation) / groupSize] += batchesMean_[i] / groupSize;
+
+    double mean{};
+    for (double groupMean : groupsMean)
+        mean += groupMean / groupsCount;
+
+    double variance{};
+    for (double groupMean : groupsMean)
+        variance += (groupMean - mean) * (groupMean - mean) / (groupsCount - 1);
+
+    return SteadyStateEstimate{
+        mean,
+        getStudentQuantile(groupsCount - 1) * std::sqrt(variance / groupsCount),
+        truncation * batchSize_,
+        groupsCount,
+        groupSize * batchSize_
+    };
+}
+
+void QS::BatchedSeries::compact()
+{
+    int halfSize{ static_cast<int>(batchesMean_.size()) / 2 };
+    for (int i{ 0 }; i < halfSize; ++i)
+        batchesMean_[i] = (batchesMean_[2 * i] + batchesMean_[2 * i + 1]) / 2.0;
+    batchesMean_.resize(halfSize);
+    batchSize_ *= 2;
+}
+
+bool QS::isPrecise(const SteadyStateEstimate& estimate, double relativePrecision)
+{
+    return estimate.batchesCount == CONFIDENCE_BATCHES_COUNT &&
+        estimate.batchSize >= MIN_CONFIDENCE_BATCH_SIZE && estimate.mean != 0.0 &&
+        estimate.halfWidth <= relativePrecision * std::abs(estimate.mean);
+}
@@ -0,0 +1,52 @@
+#ifndef OUTPUT_ANALYSIS_H
+#define OUTPUT_ANALYSIS_H
+
+#include "final_statistics.h"
+
+#include <vector>
+
+namespace QueueingSystem
+{
+    inline constexpr int MSER_BATCH_SIZE{ 5 };
+    inline constexpr int SERIES_CAPACITY{ 1024 };
+    inline constexpr int CONFIDENCE_BATCHES_COUNT{ 20 };
+    inline constexpr long long MIN_CONFIDENCE_BATCH_SIZE{ 500 };
+
+    // Two-sided 95% quantile of Student's t, the normal one past 30
+    double getStudentQuantile(int degreesOfFreedom);
+
+    // Observations kept as means of equal batches. The first batches hold
+    // MSER_BATCH_SIZE observations; a full series merges neighbouring batches
+    // and doubles the batch size, so memory stays bounded on any run length.
+    class BatchedSeries
+    {
+    public:
+        explicit BatchedSeries(int capacity = SERIES_CAPACITY);
+
+        void add(double value);
+        void reset();
+
+        long long getCount() const;
+
+        // MSER warm-up truncation over the batch means, then batch means over
+        // the rest regrouped into CONFIDENCE_BATCHES_COUNT batches
+        SteadyStateEstimate getEstimate() const;
+
+    private:
+        void compact();
+
+        std::vector<double> batchesMean_;
+        int capacity_;
+        long long batchSize_{ MSER_BATCH_SIZE };
+        double currentSum_{};
+        long long currentCount_{};
+        long long count_{};
+    };
+
+    // The estimate is built on all the confidence batches, long enough to be
+    // nearly uncorrelated, and its half-width is within relativePrecision of
+    // a nonzero mean
+    bool isPrecise(const SteadyStateEstimate& estimate, double relativePrecision);
+}
+
+#endif
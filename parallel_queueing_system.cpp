@@ -0,0 +1,617 @@
+#include "parallel_queueing_system.h"
+#include "basic_queueing_system.h"
+#include "spsc_queue.h"
+
+#include <vector>
+#include <memory>
+#include <random>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <algorithm>
+
+namespace QS = QueueingSystem;
+
+namespace
+{
+    struct ArrivalMessage
+    {
+        double time{ QS::NO_EVENT_TIME };
+        int sourceId{ QS::NO_EVENT };
+    };
+
+    // deviceId NO_EVENT finishes the partition
+    struct ServiceStartMessage
+    {
+        int deviceId{ QS::NO_EVENT };
+        double startTime{};
+    };
+
+    struct ServiceEndMessage
+    {
+        int deviceId{};
+        double processingTime{};
+    };
+
+    constexpr int BACK_OFF_SPINS{ 1024 };
+    constexpr std::chrono::microseconds BACK_OFF_SLEEP{ 50 };
+
+    // Yields while the other side is likely to answer soon, then sleeps, so
+    // an idle logical process stops taking a core
+    class BackOff
+    {
+    public:
+        void operator()()
+        {
+            if (spinsCount_ < BACK_OFF_SPINS)
+            {
+                ++spinsCount_;
+                std::this_thread::yield();
+            }
+            else
+                std::this_thread::sleep_for(BACK_OFF_SLEEP);
+        }
+
+        void reset()
+        {
+            spinsCount_ = 0;
+        }
+
+    private:
+        int spinsCount_{};
+    };
+
+    // First entity of the partition when count entities are split evenly into partitionsCount
+    int getPartitionFirst(int count, int partitionsCount, int partition)
+    {
+        return static_cast<int>(static_cast<long long>(count) * partition / partitionsCount);
+    }
+
+    class SourcePartition
+    {
+    public:
+        SourcePartition(const QS::SystemConfiguration& conf, int first, int last,
+            const std::vector<std::mt19937::result_type>& seeds, const std::atomic<bool>& stopping):
+            first_(first),
+            requestsLimit_(conf.requestsLimit),
+            nextGenerationTime_(last - first, 0.0),
+            events_(QS::makeEventSet(QS::EventSetType::binaryHeap, last - first)),
+            stopping_(stopping),
+            queue_(QS::LOGICAL_PROCESS_QUEUE_CAPACITY)
+        {
+            for (int i{ first }; i < last; ++i)
+            {
+                generators_.emplace_back(seeds[i]);
+                distributions_.push_back(conf.arrivalDistribution ? conf.arrivalDistribution->clone() :
+                    std::make_unique<QS::UniformDistribution>(0.0, conf.distrRange));
+                events_->update(i - first, 0.0);
+            }
+        }
+
+        QS::SpscQueue<ArrivalMessage>& getQueue()
+        {
+            return queue_;
+        }
+
+        // No partition sends more than requestsLimit arrivals, the buffer
+        // takes the first requestsLimit of all of them
+        void run()
+        {
+            for (int i{ 0 }; i < requestsLimit_ && !stopping_.load(std::memory_order_relaxed); ++i)
+            {
+                int index{ events_->getNextIndex() };
+                if (index == QS::NO_EVENT)
+                    break;
+
+                push(ArrivalMessage{ nextGenerationTime_[index], first_ + index });
+                nextGenerationTime_[index] += (*distributions_[index])(generators_[index]);
+                events_->update(index, nextGenerationTime_[index]);
+            }
+            push(ArrivalMessage{});
+        }
+
+    private:
+        void push(const ArrivalMessage& message)
+        {
+            BackOff backOff{};
+            while (!queue_.tryPush(message))
+            {
+                if (stopping_.load(std::memory_order_relaxed))
+                    return;
+                backOff();
+            }
+        }
+
+        int first_;
+        int requestsLimit_;
+        std::vector<std::mt19937> generators_;
+        std::vector<QS::UDistribution> distributions_;
+        std::vector<double> nextGenerationTime_;
+        QS::UEventSet events_;
+        const std::atomic<bool>& stopping_;
+        QS::SpscQueue<ArrivalMessage> queue_;
+    };
+
+    class DevicePartition
+    {
+    public:
+        struct DeviceStats
+        {
+            int requestsCount{};
+            double serviceTime{};
+        };
+
+        DevicePartition(const QS::SystemConfiguration& conf, int first, int last,
+            const std::vector<std::mt19937::result_type>& seeds):
+            first_(first),
+            stats_(last - first),
+            starts_(QS::LOGICAL_PROCESS_QUEUE_CAPACITY),
+            ends_(QS::LOGICAL_PROCESS_QUEUE_CAPACITY)
+        {
+            for (int i{ first }; i < last; ++i)
+            {
+                generators_.emplace_back(seeds[i]);
+                distributions_.push_back(conf.serviceDistribution ? conf.serviceDistribution->clone() :
+                    std::make_unique<QS::ShiftedExponentialDistribution>(QS::MIN_PROCESSING_TIME, conf.lambda));
+            }
+        }
+
+        QS::SpscQueue<ServiceStartMessage>& getStarts()
+        {
+            return starts_;
+        }
+
+        QS::SpscQueue<ServiceEndMessage>& getEnds()
+        {
+            return ends_;
+        }
+
+        // Valid once the thread of the partition is joined
+        const DeviceStats& getStats(int deviceId) const
+        {
+            return stats_[deviceId - first_];
+        }
+
+        void run()
+        {
+            ServiceStartMessage start{};
+            BackOff backOff{};
+            while (true)
+            {
+                if (!starts_.tryPop(start))
+                {
+                    backOff();
+                    continue;
+                }
+                if (start.deviceId == QS::NO_EVENT)
+                    return;
+                backOff.reset();
+
+                int index{ start.deviceId - first_ };
+                double processingTime{ (*distributions_[index])(generators_[index]) };
+                ++stats_[index].requestsCount;
+                stats_[index].serviceTime += processingTime;
+
+                while (!ends_.tryPush(ServiceEndMessage{ start.deviceId, processingTime }))
+                    backOff();
+                backOff.reset();
+            }
+        }
+
+    private:
+        int first_;
+        std::vector<std::mt19937> generators_;
+        std::vector<QS::UDistribution> distributions_;
+        std::vector<DeviceStats> stats_;
+        QS::SpscQueue<ServiceStartMessage> starts_;
+        QS::SpscQueue<ServiceEndMessage> ends_;
+    };
+
+    // The logical process of the buffer, the event loop of BasicQueueingSystem
+    // with the arrivals and processing times coming from the partitions
+    class BufferProcess
+    {
+    public:
+        BufferProcess(const QS::SystemConfiguration& conf, std::vector<std::unique_ptr<SourcePartition>>& sources,
+            std::vector<std::unique_ptr<DevicePartition>>& devices):
+            conf_(conf),
+            lookahead_(conf.serviceDistribution ? 0.0 : QS::MIN_PROCESSING_TIME),
+            sources_(sources),
+            devices_(devices),
+            devicesEndTime_(conf.devicesCount, QS::NO_EVENT_TIME),
+            devicesStartTime_(conf.devicesCount),
+            devicesProcessingTime_(conf.devicesCount),
+            devicesPending_(conf.devicesCount),
+            devicesPartition_(conf.devicesCount),
+            devicesRequest_(conf.devicesCount),
+            deviceEvents_(QS::makeEventSet(QS::EventSetType::binaryHeap, conf.devicesCount)),
+            sourcesStats_(conf.sourcesCount)
+        {
+            buffer_.reset(conf);
+            dispatch_.reset(conf);
+
+            for (int partition{ 0 }; partition < devices.size(); ++partition)
+            {
+                int last{ getPartitionFirst(conf.devicesCount, static_cast<int>(devices.size()), partition + 1) };
+                for (int i{ getPartitionFirst(conf.devicesCount, static_cast<int>(devices.size()), partition) };
+                    i < last; ++i)
+                    devicesPartition_[i] = partition;
+            }
+        }
+
+        void run()
+        {
+            while (true)
+            {
+                receiveServiceEnds();
+
+                int nextDevice{ deviceEvents_->getNextIndex() };
+                double nextDeviceTime{ nextDevice == QS::NO_EVENT ? QS::NO_EVENT_TIME : devicesEndTime_[nextDevice] };
+
+                if (requestsCount_ < conf_.requestsLimit && !precisionReached_)
+                {
+                    int partition{ getNextArrivalPartition() };
+                    if (partition != QS::NO_EVENT && sources_[partition]->getQueue().peek()->time < nextDeviceTime)
+                    {
+                        ArrivalMessage arrival{};
+                        sources_[partition]->getQueue().tryPop(arrival);
+                        implTime_ = arrival.time;
+                        processSourceEvent(arrival.sourceId, arrival.time);
+                        continue;
+                    }
+                }
+
+                if (nextDevice == QS::NO_EVENT)
+                    return;
+
+                // A service end known only from below may still come after an arrival
+                if (devicesPending_[nextDevice])
+                {
+                    waitForServiceEnd(nextDevice);
+                    continue;
+                }
+
+                implTime_ = nextDeviceTime;
+                processDeviceEvent(nextDevice, nextDeviceTime);
+            }
+        }
+
+        QS::SystemFinalStats getSystemFinalStats() const
+        {
+            double rejectionProbability{ static_cast<double>(rejectionsCount_) / requestsCount_ };
+
+            QS::SystemFinalStats finalStats{};
+            for (const auto& sourceStats : sourcesStats_)
+                finalStats.sourcesFinalStats.push_back(getSourceFinalStats(sourceStats));
+
+            double workload{};
+            for (int i{ 0 }; i < conf_.devicesCount; ++i)
+            {
+                const auto& deviceStats{ devices_[devicesPartition_[i]]->getStats(i) };
+                auto deviceFinalStats{ std::make_unique<QS::DeviceFinalStats>() };
+                deviceFinalStats->requestsCount = deviceStats.requestsCount;
+                deviceFinalStats->averageServiceTime = deviceStats.serviceTime / deviceStats.requestsCount;
+                deviceFinalStats->utilizationFactor = deviceStats.serviceTime / implTime_;
+                workload += deviceFinalStats->utilizationFactor;
+                finalStats.deviceFinalStats.push_back(std::move(deviceFinalStats));
+            }
+
+            finalStats.rejectionProbability = rejectionProbability;
+            finalStats.workload = workload / conf_.devicesCount;
+            finalStats.requiredRequestsCount = static_cast<int>((1.643 * 1.643 * (1 - rejectionProbability)) /
+                (rejectionProbability * 0.1 * 0.1));
+            finalStats.rejectionEstimate = rejectionSeries_.getEstimate();
+            finalStats.waitingTimeEstimate = waitingTimeSeries_.getEstimate();
+
+            return finalStats;
+        }
+
+    private:
+        struct SourceStats
+        {
+            int requestsCount{};
+            int rejectionsCount{};
+            QS::TimeStats bufferTime{};
+            QS::TimeStats serviceTime{};
+        };
+
+        // Partition with the earliest arrival, the lower one on equal times
+        // since the partitions are in the order of the sources
+        int getNextArrivalPartition()
+        {
+            int nextPartition{ QS::NO_EVENT };
+            double nextTime{ QS::NO_EVENT_TIME };
+            for (int partition{ 0 }; partition < sources_.size(); ++partition)
+            {
+                auto& queue{ sources_[partition]->getQueue() };
+                const ArrivalMessage* arrival{};
+                BackOff backOff{};
+                while (!(arrival = queue.peek()))
+                {
+                    receiveServiceEnds();
+                    backOff();
+                }
+
+                if (arrival->time < nextTime)
+                {
+                    nextPartition = partition;
+                    nextTime = arrival->time;
+                }
+            }
+            return nextPartition;
+        }
+
+        void receiveServiceEnds()
+        {
+            ServiceEndMessage end{};
+            for (const auto& partition : devices_)
+                while (partition->getEnds().tryPop(end))
+                {
+                    devicesPending_[end.deviceId] = false;
+                    devicesProcessingTime_[end.deviceId] = end.processingTime;
+                    devicesEndTime_[end.deviceId] = devicesStartTime_[end.deviceId] + end.processingTime;
+                    deviceEvents_->update(end.deviceId, devicesEndTime_[end.deviceId]);
+                }
+        }
+
+        void waitForServiceEnd(int deviceId)
+        {
+            receiveServiceEnds();
+            BackOff backOff{};
+            while (devicesPending_[deviceId])
+            {
+                backOff();
+                receiveServiceEnds();
+            }
+        }
+
+        void processSourceEvent(int sourceId, double time)
+        {
+            auto& sourceStats{ sourcesStats_[sourceId] };
+            QS::Request request{ QS::RequestId{ sourceId, sourceStats.requestsCount++ }, time };
+
+            ++requestsCount_;
+
+            QS::Request rejectedRequest{};
+            bool placed{ buffer_.placeRequest(request, rejectedRequest) };
+            if (!placed)
+            {
+                ++sourcesStats_[rejectedRequest.id.sourceId].rejectionsCount;
+                ++rejectionsCount_;
+            }
+            rejectionSeries_.add(placed ? 0.0 : 1.0);
+
+            if (conf_.targetPrecision > 0.0 && requestsCount_ % QS::PRECISION_CHECK_PERIOD == 0)
+                precisionReached_ = QS::isPrecise(rejectionSeries_.getEstimate(), conf_.targetPrecision);
+
+            tryProcessRequest(time);
+        }
+
+        void processDeviceEvent(int deviceId, double time)
+        {
+            sourcesStats_[devicesRequest_[deviceId].id.sourceId].serviceTime.add(devicesProcessingTime_[deviceId]);
+
+            devicesEndTime_[deviceId] = QS::NO_EVENT_TIME;
+            deviceEvents_->update(deviceId, QS::NO_EVENT_TIME);
+            --busyDevicesCount_;
+
+            if (!buffer_.isEmpty())
+                tryProcessRequest(time);
+        }
+
+        void tryProcessRequest(double startTime)
+        {
+            // The scan of the dispatch would find no free device
+            if (busyDevicesCount_ == conf_.devicesCount)
+                return;
+
+            int freeDeviceIndex{ dispatch_.selectDevice(devicesEndTime_) };
+            auto request{ buffer_.selectRequest() };
+
+            if (startTime != request.generationTime)
+                sourcesStats_[request.id.sourceId].bufferTime.add(startTime - request.generationTime);
+            waitingTimeSeries_.add(startTime - request.generationTime);
+
+            devicesRequest_[freeDeviceIndex] = request;
+            devicesStartTime_[freeDeviceIndex] = startTime;
+            devicesPending_[freeDeviceIndex] = true;
+            devicesEndTime_[freeDeviceIndex] = startTime + lookahead_;
+            deviceEvents_->update(freeDeviceIndex, devicesEndTime_[freeDeviceIndex]);
+            ++busyDevicesCount_;
+
+            auto& starts{ devices_[devicesPartition_[freeDeviceIndex]]->getStarts() };
+            BackOff backOff{};
+            while (!starts.tryPush(ServiceStartMessage{ freeDeviceIndex, startTime }))
+            {
+                receiveServiceEnds();
+                backOff();
+            }
+        }
+
+        QS::USourceFinalStats getSourceFinalStats(const SourceStats& sourceStats) const
+        {
+            auto sourceFinalStats{ std::make_unique<QS::SourceFinalStats>() };
+            int servedCount{ sourceStats.requestsCount - sourceStats.rejectionsCount };
+
+            sourceFinalStats->requestsCount = sourceStats.requestsCount;
+            sourceFinalStats->rejectionProbability = static_cast<double>(sourceStats.rejectionsCount) /
+                sourceStats.requestsCount;
+            sourceFinalStats->averageBufferTime = sourceStats.bufferTime.sum / servedCount;
+            sourceFinalStats->averageServiceTime = sourceStats.serviceTime.sum / servedCount;
+            sourceFinalStats->averageProcessingTime = sourceFinalStats->averageBufferTime +
+                sourceFinalStats->averageServiceTime;
+            sourceFinalStats->bufferTimeDispersion = sourceStats.bufferTime.getDispersion(
+                sourceFinalStats->averageBufferTime);
+            sourceFinalStats->serviceTimeDispersion = sourceStats.serviceTime.getDispersion(
+                sourceFinalStats->averageServiceTime);
+
+            return sourceFinalStats;
+        }
+
+        const QS::SystemConfiguration& conf_;
+        double lookahead_;
+        std::vector<std::unique_ptr<SourcePartition>>& sources_;
+        std::vector<std::unique_ptr<DevicePartition>>& devices_;
+
+        QS::SourcePriorityBufferPolicy buffer_{};
+        QS::RoundRobinDispatchPolicy dispatch_{};
+
+        // A device with a service end not received yet has the lower bound
+        // of it as its end time, and is pending
+        std::vector<double> devicesEndTime_;
+        std::vector<double> devicesStartTime_;
+        std::vector<double> devicesProcessingTime_;
+        std::vector<char> devicesPending_;
+        std::vector<int> devicesPartition_;
+        std::vector<QS::Request> devicesRequest_;
+        QS::UEventSet deviceEvents_;
+        int busyDevicesCount_{};
+
+        std::vector<SourceStats> sourcesStats_;
+        QS::BatchedSeries rejectionSeries_{};
+        QS::BatchedSeries waitingTimeSeries_{};
+        int requestsCount_{};
+        long long rejectionsCount_{};
+        double implTime_{};
+        bool precisionReached_{};
+    };
+
+    template <class Run>
+    double measureSeconds(Run run)
+    {
+        auto start{ std::chrono::steady_clock::now() };
+        run();
+        return std::chrono::duration<double>{ std::chrono::steady_clock::now() - start }.count();
+    }
+
+    bool isSame(const QS::SystemFinalStats& first, const QS::SystemFinalStats& second)
+    {
+        auto isSameEstimate = [](const QS::SteadyStateEstimate& first, const QS::SteadyStateEstimate& second)
+        {
+            return first.mean == second.mean && first.halfWidth == second.halfWidth &&
+                first.warmupCount == second.warmupCount && first.batchSize == second.batchSize;
+        };
+
+        if (first.rejectionProbability != second.rejectionProbability || first.workload != second.workload ||
+            !isSameEstimate(first.rejectionEstimate, second.rejectionEstimate) ||
+            !isSameEstimate(first.waitingTimeEstimate, second.waitingTimeEstimate))
+            return false;
+
+        for (std::size_t i{ 0 }; i < first.sourcesFinalStats.size(); ++i)
+        {
+            const auto& firstSource{ *first.sourcesFinalStats[i] };
+            const auto& secondSource{ *second.sourcesFinalStats[i] };
+            if (firstSource.requestsCount != secondSource.requestsCount ||
+                firstSource.averageBufferTime != secondSource.averageBufferTime ||
+                firstSource.averageServiceTime != secondSource.averageServiceTime)
+                return false;
+        }
+
+        for (std::size_t i{ 0 }; i < first.deviceFinalStats.size(); ++i)
+            if (first.deviceFinalStats[i]->requestsCount != second.deviceFinalStats[i]->requestsCount ||
+                first.deviceFinalStats[i]->utilizationFactor != second.deviceFinalStats[i]->utilizationFactor)
+                return false;
+        return true;
+    }
+}
+
+QS::SystemFinalStats QS::runParallel(const SystemConfiguration& conf, const ParallelConfiguration& parallel,
+    std::uint32_t seed)
+{
+    // Sources first, then devices, as EntityStreamQueueingSystem::reseed
+    std::mt19937 seeder{ seed };
+    std::vector<std::mt19937::result_type> sourceSeeds(conf.sourcesCount);
+    std::vector<std::mt19937::result_type> deviceSeeds(conf.devicesCount);
+    for (auto& sourceSeed : sourceSeeds)
+        sourceSeed = seeder();
+    for (auto& deviceSeed : deviceSeeds)
+        deviceSeed = seeder();
+
+    std::atomic<bool> stopping{};
+    int sourcePartitionsCount{ std::clamp(parallel.sourcePartitionsCount, 1, conf.sourcesCount) };
+    int devicePartitionsCount{ std::clamp(parallel.devicePartitionsCount, 1, conf.devicesCount) };
+
+    std::vector<std::unique_ptr<SourcePartition>> sources{};
+    for (int i{ 0 }; i < sourcePartitionsCount; ++i)
+        sources.push_back(std::make_unique<SourcePartition>(conf,
+            getPartitionFirst(conf.sourcesCount, sourcePartitionsCount, i),
+            getPartitionFirst(conf.sourcesCount, sourcePartitionsCount, i + 1), sourceSeeds, stopping));
+
+    std::vector<std::unique_ptr<DevicePartition>> devices{};
+    for (int i{ 0 }; i < devicePartitionsCount; ++i)
+        devices.push_back(std::make_unique<DevicePartition>(conf,
+            getPartitionFirst(conf.devicesCount, devicePartitionsCount, i),
+            getPartitionFirst(conf.devicesCount, devicePartitionsCount, i + 1), deviceSeeds));
+
+    std::vector<std::thread> threads{};
+    for (const auto& partition : sources)
+        threads.emplace_back([&partition] { partition->run(); });
+    for (const auto& partition : devices)
+        threads.emplace_back([&partition] { partition->run(); });
+
+    BufferProcess buffer{ conf, sources, devices };
+    buffer.run();
+
+    // Every service has ended, the device partitions wait for the next start
+    stopping.store(true, std::memory_order_relaxed);
+    BackOff backOff{};
+    for (const auto& partition : devices)
+        while (!partition->getStarts().tryPush(ServiceStartMessage{}))
+            backOff();
+    for (auto& thread : threads)
+        thread.join();
+
+    return buffer.getSystemFinalStats();
+}
+
+int QS::runParallelBenchmark(std::ostream& out, int requestsCount)
+{
+    SystemConfiguration conf{};
+    conf.sourcesCount = 2000;
+    conf.bufferSize = 1000;
+    conf.devicesCount = 20000;
+    conf.requestsLimit = requestsCount;
+    // The sequential run finds the service ends in a heap, as the buffer process does
+    conf.eventSet = EventSetType::binaryHeap;
+    std::uint32_t seed{ std::random_device{}() };
+
+    SystemFinalStats sequentialStats{};
+    double sequentialTime{ measureSeconds([&]
+        {
+            EntityStreamQueueingSystem system{ conf };
+            std::mt19937 seeder{ seed };
+            system.reseed(seeder);
+            system.run();
+            sequentialStats = system.getSystemFinalStats();
+        }) };
+
+    // Speedup over one device partition, the cost of the messages is the
+    // same in every parallel run; the sequential engine has none of it
+    out << std::setw(10) << "sources" << std::setw(10) << "devices" << std::setw(12) << "time, s"
+        << std::setw(10) << "speedup" << std::setw(14) << "vs sequential" << std::setw(12) << "identical" << '\n';
+    out << std::fixed << std::setprecision(2);
+    out << std::setw(10) << '-' << std::setw(10) << '-' << std::setw(12) << sequentialTime
+        << std::setw(10) << '-' << std::setw(14) << 1.0 << std::setw(12) << '-' << '\n';
+
+    double singlePartitionTime{};
+    int threadsCount{ std::max(3, static_cast<int>(std::thread::hardware_concurrency())) };
+    for (int devicePartitionsCount{ 1 }; devicePartitionsCount <= threadsCount - 2; devicePartitionsCount *= 2)
+    {
+        ParallelConfiguration parallel{ 1, devicePartitionsCount };
+        SystemFinalStats parallelStats{};
+        double parallelTime{ measureSeconds([&]
+            {
+                parallelStats = runParallel(conf, parallel, seed);
+            }) };
+        if (devicePartitionsCount == 1)
+            singlePartitionTime = parallelTime;
+
+        out << std::setw(10) << parallel.sourcePartitionsCount << std::setw(10) << devicePartitionsCount
+            << std::setw(12) << parallelTime << std::setw(10) << singlePartitionTime / parallelTime
+            << std::setw(14) << sequentialTime / parallelTime
+            << std::setw(12) << (isSame(sequentialStats, parallelStats) ? "yes" : "no") << std::endl;
+    }
+
+    return 0;
+}
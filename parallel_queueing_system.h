@@ -0,0 +1,45 @@
+#ifndef PARALLEL_QUEUEING_SYSTEM_H
+#define PARALLEL_QUEUEING_SYSTEM_H
+
+#include "queueing_system.h"
+
+#include <ostream>
+#include <cstddef>
+#include <cstdint>
+
+namespace QueueingSystem
+{
+    inline constexpr const char* PARALLEL_BENCHMARK_FLAG{ "--benchmark-parallel" };
+    // Messages a logical process may get ahead of the buffer by
+    inline constexpr std::size_t LOGICAL_PROCESS_QUEUE_CAPACITY{ 1 << 14 };
+
+    struct ParallelConfiguration
+    {
+        // Logical processes with a thread each, next to the calling thread
+        // that keeps the buffer
+        int sourcePartitionsCount{ 1 };
+        int devicePartitionsCount{ 1 };
+    };
+
+    // Conservative parallel run of one large configuration. Sources and devices
+    // are split into contiguous partitions, the logical processes, which talk
+    // to the buffer over lock-free queues:
+    //  - a source partition sends its arrivals in time order, ahead of the
+    //    buffer, since nothing in the model acts back on the sources;
+    //  - the buffer sends a device partition the services it starts, and the
+    //    partition draws the processing times and keeps the device stats.
+    // Until a processing time comes back the buffer only knows the service
+    // ends no earlier than MIN_PROCESSING_TIME after its start, and it goes on
+    // with every event before that. With a serviceDistribution the lookahead
+    // is 0. The result is the one of EntityStreamQueueingSystem reseeded from
+    // std::mt19937{ seed }, to the last bit. Generated arrivals only.
+    SystemFinalStats runParallel(const SystemConfiguration& conf, const ParallelConfiguration& parallel,
+        std::uint32_t seed);
+
+    // Sequential and parallel runs of a model with thousands of sources and
+    // tens of thousands of devices, the speedup of more device partitions
+    // against one
+    int runParallelBenchmark(std::ostream& out, int requestsCount);
+}
+
+#endif
@@ -0,0 +1,134 @@
+#include "process_model.h"
+#include "process_scheduler.h"
+#include "basic_queueing_system.h"
+
+#include <random>
+#include <memory>
+#include <vector>
+#include <chrono>
+#include <iomanip>
+
+namespace QS = QueueingSystem;
+
+namespace
+{
+    struct ProcessModel
+    {
+        const QS::SystemConfiguration& conf;
+        QS::ProcessScheduler& scheduler;
+        QS::Resource& devices;
+        std::mt19937 generator;
+        std::vector<QS::UDistribution> arrivalDistributions{};
+        std::vector<QS::UDistribution> serviceDistributions{};
+        QS::ProcessModelStats stats{};
+        double waitingTime{};
+        double serviceTime{};
+    };
+
+    QS::Process runRequest(ProcessModel& model, QS::Request request)
+    {
+        int device{ co_await QS::acquire(model.devices, request) };
+        if (device == QS::NO_UNIT)
+        {
+            ++model.stats.rejectionsCount;
+            co_return;
+        }
+
+        double processingTime{ (*model.serviceDistributions[device])(model.generator) };
+        model.waitingTime += model.scheduler.getTime() - request.generationTime;
+        model.serviceTime += processingTime;
+
+        co_await model.scheduler.delay(processingTime);
+        model.devices.release(device);
+    }
+
+    QS::Process runSource(ProcessModel& model, int sourceId)
+    {
+        for (int serialNumber{ 0 }; model.stats.requestsCount < model.conf.requestsLimit; ++serialNumber)
+        {
+            ++model.stats.requestsCount;
+            model.scheduler.spawn(runRequest(model,
+                QS::Request{ QS::RequestId{ sourceId, serialNumber }, model.scheduler.getTime() }));
+
+            co_await model.scheduler.delay((*model.arrivalDistributions[sourceId])(model.generator));
+        }
+    }
+
+    template <class Run>
+    double measureEventTime(Run run)
+    {
+        auto start{ std::chrono::steady_clock::now() };
+        long long eventsCount{ run() };
+        std::chrono::duration<double, std::nano> elapsed{ std::chrono::steady_clock::now() - start };
+        return elapsed.count() / eventsCount;
+    }
+}
+
+QS::ProcessModelStats QS::runProcessModel(const SystemConfiguration& conf, std::uint32_t seed)
+{
+    ProcessScheduler scheduler{};
+    Resource devices{ conf.devicesCount, conf.bufferSize };
+    ProcessModel model{ conf, scheduler, devices, std::mt19937{ seed } };
+
+    for (int i{ 0 }; i < conf.sourcesCount; ++i)
+        model.arrivalDistributions.push_back(conf.arrivalDistribution ? conf.arrivalDistribution->clone() :
+            std::make_unique<UniformDistribution>(0.0, conf.distrRange));
+    for (int i{ 0 }; i < conf.devicesCount; ++i)
+        model.serviceDistributions.push_back(conf.serviceDistribution ? conf.serviceDistribution->clone() :
+            std::make_unique<ShiftedExponentialDistribution>(MIN_PROCESSING_TIME, conf.lambda));
+
+    for (int i{ 0 }; i < conf.sourcesCount; ++i)
+        scheduler.spawn(runSource(model, i));
+    scheduler.run();
+
+    auto& stats{ model.stats };
+    int servedCount{ stats.requestsCount - stats.rejectionsCount };
+    stats.rejectionProbability = static_cast<double>(stats.rejectionsCount) / stats.requestsCount;
+    stats.workload = model.serviceTime / (scheduler.getTime() * conf.devicesCount);
+    stats.averageWaitingTime = model.waitingTime / servedCount;
+    stats.eventsCount = scheduler.getEventsCount();
+    return stats;
+}
+
+int QS::runProcessBenchmark(std::ostream& out, int requestsCount)
+{
+    SystemConfiguration conf{};
+    conf.requestsLimit = requestsCount;
+
+    double stepTime{ measureEventTime([&conf]
+        {
+            QueueingSystem system{ conf };
+            long long eventsCount{};
+            while (system.makeStep())
+                ++eventsCount;
+            return eventsCount;
+        }) };
+
+    double compiledTime{ measureEventTime([&conf]
+        {
+            DefaultQueueingSystem system{ conf };
+            long long eventsCount{};
+            while (system.makeStep())
+                ++eventsCount;
+            return eventsCount;
+        }) };
+
+    ProcessModelStats stats{};
+    double processTime{ measureEventTime([&conf, &stats]
+        {
+            stats = runProcessModel(conf, std::random_device{}());
+            return stats.eventsCount;
+        }) };
+
+    out << std::setw(16) << "engine" << std::setw(14) << "event, ns" << std::setw(12) << "relative" << '\n';
+    out << std::fixed << std::setprecision(1);
+    out << std::setw(16) << "makeStep" << std::setw(14) << stepTime << std::setw(12) << 1.0 << '\n';
+    out << std::setw(16) << "compile-time" << std::setw(14) << compiledTime
+        << std::setw(12) << compiledTime / stepTime << '\n';
+    out << std::setw(16) << "processes" << std::setw(14) << processTime
+        << std::setw(12) << processTime / stepTime << '\n';
+    out << std::setprecision(4) << "process model: rejection " << stats.rejectionProbability
+        << ", workload " << stats.workload << ", waiting " << stats.averageWaitingTime << std::endl;
+
+    return 0;
+}
@@ -0,0 +1,35 @@
+#ifndef PROCESS_MODEL_H
+#define PROCESS_MODEL_H
+
+#include "queueing_system.h"
+
+#include <ostream>
+#include <cstdint>
+
+namespace QueueingSystem
+{
+    inline constexpr const char* PROCESS_BENCHMARK_FLAG{ "--benchmark-processes" };
+
+    struct ProcessModelStats
+    {
+        int requestsCount{};
+        int rejectionsCount{};
+        double rejectionProbability{};
+        double workload{};
+        double averageWaitingTime{};
+        long long eventsCount{};
+    };
+
+    // The model of QueueingSystem written with ProcessScheduler: a process
+    // per source generates the requests, a process per request waits for a
+    // device, holds it for the service time and leaves. It has the same
+    // stationary behaviour, the random streams are not those of makeStep.
+    // Generated arrivals only, targetPrecision is not applied.
+    ProcessModelStats runProcessModel(const SystemConfiguration& conf, std::uint32_t seed);
+
+    // Time per event of makeStep, the compile-time engine and the process
+    // model on the default configuration
+    int runProcessBenchmark(std::ostream& out, int requestsCount);
+}
+
+#endif
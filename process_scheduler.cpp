@@ -0,0 +1,246 @@
+#include "process_scheduler.h"
+
+#include <algorithm>
+#include <exception>
+#include <new>
+#include <utility>
+
+namespace QS = QueueingSystem;
+
+namespace
+{
+    std::size_t getSizeClass(std::size_t size)
+    {
+        return (size + QS::FRAME_SIZE_STEP - 1) / QS::FRAME_SIZE_STEP - 1;
+    }
+}
+
+QS::FramePool::~FramePool()
+{
+    for (auto& frames : freeFrames_)
+        for (void* frame : frames)
+            ::operator delete(frame);
+}
+
+void* QS::FramePool::allocate(std::size_t size)
+{
+    auto sizeClass{ getSizeClass(size) };
+    if (sizeClass >= FRAME_SIZE_CLASSES)
+        return ::operator new(size);
+
+    auto& frames{ freeFrames_[sizeClass] };
+    if (frames.empty())
+        return ::operator new((sizeClass + 1) * FRAME_SIZE_STEP);
+
+    void* frame{ frames.back() };
+    frames.pop_back();
+    return frame;
+}
+
+void QS::FramePool::deallocate(void* frame, std::size_t size)
+{
+    auto sizeClass{ getSizeClass(size) };
+    if (sizeClass >= FRAME_SIZE_CLASSES)
+        ::operator delete(frame);
+    else
+        freeFrames_[sizeClass].push_back(frame);
+}
+
+QS::FramePool& QS::getFramePool()
+{
+    thread_local FramePool framePool{};
+    return framePool;
+}
+
+void QS::Process::promise_type::unhandled_exception() noexcept
+{
+    std::terminate();
+}
+
+QS::Process::Process(std::coroutine_handle<promise_type> handle):
+    handle_(handle)
+{}
+
+QS::Process::Process(Process&& other) noexcept:
+    handle_(std::exchange(other.handle_, {}))
+{}
+
+QS::Process& QS::Process::operator=(Process&& other) noexcept
+{
+    if (this != &other)
+    {
+        if (handle_)
+            handle_.destroy();
+        handle_ = std::exchange(other.handle_, {});
+    }
+    return *this;
+}
+
+QS::Process::~Process()
+{
+    if (handle_)
+        handle_.destroy();
+}
+
+std::coroutine_handle<> QS::Process::release()
+{
+    return std::exchange(handle_, {});
+}
+
+QS::ProcessScheduler::~ProcessScheduler()
+{
+    for (const auto& resumption : calendar_)
+        resumption.handle.destroy();
+}
+
+double QS::ProcessScheduler::getTime() const
+{
+    return time_;
+}
+
+long long QS::ProcessScheduler::getEventsCount() const
+{
+    return eventsCount_;
+}
+
+void QS::ProcessScheduler::spawn(Process process)
+{
+    process.release().resume();
+}
+
+void QS::ProcessScheduler::schedule(std::coroutine_handle<> handle, double time)
+{
+    calendar_.push_back(Resumption{ time, sequence_++, handle });
+    std::push_heap(calendar_.begin(), calendar_.end(), isLater);
+}
+
+bool QS::ProcessScheduler::step()
+{
+    if (calendar_.empty())
+        return false;
+
+    std::pop_heap(calendar_.begin(), calendar_.end(), isLater);
+    auto resumption{ calendar_.back() };
+    calendar_.pop_back();
+
+    time_ = resumption.time;
+    ++eventsCount_;
+    resumption.handle.resume();
+    return true;
+}
+
+void QS::ProcessScheduler::run()
+{
+    while (step());
+}
+
+QS::ProcessScheduler::DelayAwaiter QS::ProcessScheduler::delay(double duration)
+{
+    return DelayAwaiter{ *this, duration };
+}
+
+bool QS::ProcessScheduler::isLater(const Resumption& first, const Resumption& second)
+{
+    return first.time > second.time || (first.time == second.time && first.sequence > second.sequence);
+}
+
+QS::Resource::Resource(int unitsCount, int waitingCapacity):
+    busyUnits_(unitsCount),
+    waitingCapacity_(waitingCapacity)
+{
+    waiting_.reserve(waitingCapacity);
+}
+
+QS::Resource::~Resource()
+{
+    for (auto* awaiter : waiting_)
+        awaiter->handle_.destroy();
+}
+
+int QS::Resource::getUnitsCount() const
+{
+    return static_cast<int>(busyUnits_.size());
+}
+
+int QS::Resource::getBusyUnitsCount() const
+{
+    return busyUnitsCount_;
+}
+
+int QS::Resource::getWaitingCount() const
+{
+    return static_cast<int>(waiting_.size());
+}
+
+void QS::Resource::release(int unit)
+{
+    if (waiting_.empty())
+    {
+        busyUnits_[unit] = false;
+        --busyUnitsCount_;
+        return;
+    }
+
+    auto awaiterIter{ std::min_element(waiting_.begin(), waiting_.end(),
+        [](const AcquireAwaiter* first, const AcquireAwaiter* second)
+        { return first->request_ < second->request_; }) };
+    auto* awaiter{ *awaiterIter };
+    waiting_.erase(awaiterIter);
+
+    awaiter->unit_ = unit;
+    unitIndex_ = unit < static_cast<int>(busyUnits_.size()) - 1 ? unit + 1 : 0;
+    awaiter->handle_.resume();
+}
+
+int QS::Resource::takeFreeUnit()
+{
+    int unitsCount{ static_cast<int>(busyUnits_.size()) };
+    if (busyUnitsCount_ == unitsCount)
+        return NO_UNIT;
+
+    int unit{ unitIndex_ };
+    while (busyUnits_[unit])
+        unit = unit < unitsCount - 1 ? unit + 1 : 0;
+
+    busyUnits_[unit] = true;
+    ++busyUnitsCount_;
+    unitIndex_ = unit < unitsCount - 1 ? unit + 1 : 0;
+    return unit;
+}
+
+QS::Resource::AcquireAwaiter::AcquireAwaiter(Resource& resource, const Request& request):
+    resource_(resource),
+    request_(request)
+{}
+
+bool QS::Resource::AcquireAwaiter::await_ready()
+{
+    unit_ = resource_.takeFreeUnit();
+    // Without a waiting room a request finding no free unit is rejected at once
+    return unit_ != NO_UNIT || !resource_.waitingCapacity_;
+}
+
+void QS::Resource::AcquireAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    handle_ = handle;
+    auto& waiting{ resource_.waiting_ };
+    if (static_cast<int>(waiting.size()) != resource_.waitingCapacity_)
+    {
+        waiting.push_back(this);
+        return;
+    }
+
+    auto* rejected{ waiting.back() };
+    waiting.back() = this;
+    rejected->handle_.resume();
+}
+
+int QS::Resource::AcquireAwaiter::await_resume() const noexcept
+{
+    return unit_;
+}
+
+QS::Resource::AcquireAwaiter QS::acquire(Resource& resource, const Request& request)
+{
+    return Resource::AcquireAwaiter{ resource, request };
+}
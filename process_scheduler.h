@@ -0,0 +1,209 @@
+#ifndef PROCESS_SCHEDULER_H
+#define PROCESS_SCHEDULER_H
+
+#include "request.h"
+
+#include <coroutine>
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+
+namespace QueueingSystem
+{
+    inline constexpr int NO_UNIT{ -1 };
+    // Frames up to FRAME_SIZE_STEP * FRAME_SIZE_CLASSES bytes are pooled
+    inline constexpr std::size_t FRAME_SIZE_STEP{ 64 };
+    inline constexpr std::size_t FRAME_SIZE_CLASSES{ 16 };
+
+    // Free lists of coroutine frames by size class, one pool per thread.
+    // Frames are never given back to the heap, a model spawning a process
+    // per request allocates only until its peak of live processes.
+    class FramePool
+    {
+    public:
+        FramePool() = default;
+        ~FramePool();
+
+        FramePool(const FramePool&) = delete;
+        FramePool& operator=(const FramePool&) = delete;
+
+        void* allocate(std::size_t size);
+        void deallocate(void* frame, std::size_t size);
+
+    private:
+        std::vector<void*> freeFrames_[FRAME_SIZE_CLASSES];
+    };
+
+    FramePool& getFramePool();
+
+    // Coroutine of a process. It starts suspended and runs once given to
+    // ProcessScheduler::spawn; the frame is freed when the body returns.
+    // A process must not throw.
+    class Process
+    {
+    public:
+        struct promise_type
+        {
+            Process get_return_object()
+            {
+                return Process{ std::coroutine_handle<promise_type>::from_promise(*this) };
+            }
+
+            std::suspend_always initial_suspend() noexcept
+            {
+                return {};
+            }
+
+            std::suspend_never final_suspend() noexcept
+            {
+                return {};
+            }
+
+            void return_void() {}
+            void unhandled_exception() noexcept;
+
+            static void* operator new(std::size_t size)
+            {
+                return getFramePool().allocate(size);
+            }
+
+            static void operator delete(void* frame, std::size_t size)
+            {
+                getFramePool().deallocate(frame, size);
+            }
+        };
+
+        Process(Process&& other) noexcept;
+        Process& operator=(Process&& other) noexcept;
+        ~Process();
+
+        // Hands the suspended coroutine over to the caller
+        std::coroutine_handle<> release();
+
+    private:
+        explicit Process(std::coroutine_handle<promise_type> handle);
+
+        std::coroutine_handle<promise_type> handle_;
+    };
+
+    // Event calendar of suspended processes: every event resumes one of
+    // them. Resumptions at the same time go in the order they were scheduled.
+    class ProcessScheduler
+    {
+    public:
+        ProcessScheduler() = default;
+        // Destroys the processes still waiting for their time
+        ~ProcessScheduler();
+
+        ProcessScheduler(const ProcessScheduler&) = delete;
+        ProcessScheduler& operator=(const ProcessScheduler&) = delete;
+
+        double getTime() const;
+        long long getEventsCount() const;
+
+        // The process runs up to its first suspension right away, within
+        // the event of its parent
+        void spawn(Process process);
+        void schedule(std::coroutine_handle<> handle, double time);
+
+        bool step();
+        // Until no process is scheduled, processes waiting on a resource
+        // that nobody releases are left suspended
+        void run();
+
+        struct DelayAwaiter
+        {
+            ProcessScheduler& scheduler;
+            double duration;
+
+            bool await_ready() const noexcept
+            {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<> handle)
+            {
+                scheduler.schedule(handle, scheduler.time_ + duration);
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        // co_await delay(t) resumes the process t later
+        DelayAwaiter delay(double duration);
+
+    private:
+        struct Resumption
+        {
+            double time;
+            std::uint64_t sequence;
+            std::coroutine_handle<> handle;
+        };
+
+        static bool isLater(const Resumption& first, const Resumption& second);
+
+        std::vector<Resumption> calendar_;
+        std::uint64_t sequence_{};
+        double time_{};
+        long long eventsCount_{};
+    };
+
+    // Units, like the devices, taken by requests that wait for a free one in
+    // a bounded room with the discipline of Buffer: a request arriving to a
+    // full room takes the place of the one in the last position, which is
+    // rejected, and the request of the source with the smallest id is served
+    // first. Free units are handed out round robin as by QueueingSystem.
+    // Waiting processes are resumed directly within the current event, like
+    // the dispatch in makeStep, without going through the calendar.
+    class Resource
+    {
+    public:
+        Resource(int unitsCount, int waitingCapacity);
+        // Destroys the processes still waiting
+        ~Resource();
+
+        Resource(const Resource&) = delete;
+        Resource& operator=(const Resource&) = delete;
+
+        int getUnitsCount() const;
+        int getBusyUnitsCount() const;
+        int getWaitingCount() const;
+
+        // Gives the unit to the first waiting request, which resumes before
+        // release returns, or makes it free
+        void release(int unit);
+
+        class AcquireAwaiter
+        {
+        public:
+            AcquireAwaiter(Resource& resource, const Request& request);
+
+            bool await_ready();
+            void await_suspend(std::coroutine_handle<> handle);
+            // The unit taken, NO_UNIT when the request was rejected
+            int await_resume() const noexcept;
+
+        private:
+            friend class Resource;
+
+            Resource& resource_;
+            Request request_;
+            std::coroutine_handle<> handle_{};
+            int unit_{ NO_UNIT };
+        };
+
+    private:
+        int takeFreeUnit();
+
+        std::vector<bool> busyUnits_;
+        std::vector<AcquireAwaiter*> waiting_;
+        int waitingCapacity_;
+        int busyUnitsCount_{};
+        int unitIndex_{};
+    };
+
+    // co_await acquire(devices, request) gives the unit the request got
+    Resource::AcquireAwaiter acquire(Resource& resource, const Request& request);
+}
+
+#endif
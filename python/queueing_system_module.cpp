@@ -0,0 +1,743 @@
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include "../queueing_system.h"
+#include "../queueing_system_research.h"
+
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+#include <utility>
+#include <exception>
+
+namespace QS = QueueingSystem;
+
+namespace
+{
+    // Read-only one-dimensional view of a column of C++ results. The owner
+    // keeps the results alive for as long as the array or any buffer taken
+    // from it exists, so NumPy and memoryview read them in place; a column
+    // of a vector of records is strided by the record size.
+    struct ArrayObject
+    {
+        PyObject_HEAD
+        std::shared_ptr<const void> owner;
+        const char* data;
+        Py_ssize_t length;
+        Py_ssize_t stride;
+        Py_ssize_t itemSize;
+        char format[2];
+    };
+
+    PyTypeObject* arrayType{};
+
+    template <class T>
+    constexpr char FORMAT{};
+    template <>
+    constexpr char FORMAT<bool>{ '?' };
+    template <>
+    constexpr char FORMAT<int>{ 'i' };
+    template <>
+    constexpr char FORMAT<long long>{ 'q' };
+    template <>
+    constexpr char FORMAT<float>{ 'f' };
+    template <>
+    constexpr char FORMAT<double>{ 'd' };
+
+    // A buffer of zero length still needs a valid address
+    const char EMPTY_DATA{};
+
+    template <class Value>
+    PyObject* makeArray(std::shared_ptr<const void> owner, const Value* data, Py_ssize_t length,
+        Py_ssize_t stride = sizeof(Value))
+    {
+        auto array{ PyObject_New(ArrayObject, arrayType) };
+        if (!array)
+            return nullptr;
+
+        new (&array->owner) std::shared_ptr<const void>{ std::move(owner) };
+        array->data = length ? reinterpret_cast<const char*>(data) : &EMPTY_DATA;
+        array->length = length;
+        array->stride = stride;
+        array->itemSize = sizeof(Value);
+        array->format[0] = FORMAT<Value>;
+        array->format[1] = '\0';
+        return reinterpret_cast<PyObject*>(array);
+    }
+
+    // The field of every record, in place
+    template <class Record, class Field>
+    PyObject* makeColumn(const std::shared_ptr<const std::vector<Record>>& records, Field field)
+    {
+        static const Record empty{};
+        const auto& first{ records->empty() ? empty : records->front() };
+        return makeArray(records, &field(first), static_cast<Py_ssize_t>(records->size()), sizeof(Record));
+    }
+
+    void deallocArray(PyObject* self)
+    {
+        auto array{ reinterpret_cast<ArrayObject*>(self) };
+        array->owner.~shared_ptr();
+        auto type{ Py_TYPE(self) };
+        PyObject_Free(self);
+        Py_DECREF(type);
+    }
+
+    int getArrayBuffer(PyObject* self, Py_buffer* view, int flags)
+    {
+        auto array{ reinterpret_cast<ArrayObject*>(self) };
+        if (flags & PyBUF_WRITABLE)
+        {
+            PyErr_SetString(PyExc_BufferError, "results are read-only");
+            return -1;
+        }
+        if (array->stride != array->itemSize && (flags & PyBUF_STRIDES) != PyBUF_STRIDES)
+        {
+            PyErr_SetString(PyExc_BufferError, "the column is strided");
+            return -1;
+        }
+
+        view->obj = Py_NewRef(self);
+        view->buf = const_cast<char*>(array->data);
+        view->len = array->length * array->itemSize;
+        view->readonly = 1;
+        view->itemsize = array->itemSize;
+        view->format = (flags & PyBUF_FORMAT) ? array->format : nullptr;
+        view->ndim = 1;
+        view->shape = (flags & PyBUF_ND) == PyBUF_ND ? &array->length : nullptr;
+        view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? &array->stride : nullptr;
+        view->suboffsets = nullptr;
+        view->internal = nullptr;
+        return 0;
+    }
+
+    Py_ssize_t getArrayLength(PyObject* self)
+    {
+        return reinterpret_cast<ArrayObject*>(self)->length;
+    }
+
+    PyType_Slot arraySlots[]{
+        { Py_tp_dealloc, reinterpret_cast<void*>(deallocArray) },
+        { Py_bf_getbuffer, reinterpret_cast<void*>(getArrayBuffer) },
+        { Py_sq_length, reinterpret_cast<void*>(getArrayLength) },
+        { Py_tp_doc, const_cast<char*>("Read-only column of simulation results, "
+            "pass it to numpy.asarray or memoryview to read it without a copy") },
+        { 0, nullptr },
+    };
+
+    PyType_Spec arraySpec{ "queueing_system.Array", sizeof(ArrayObject), 0, Py_TPFLAGS_DEFAULT, arraySlots };
+
+    // Adds value to the dict and drops the reference, a null value is an error already set
+    bool setItem(PyObject* dict, const char* key, PyObject* value)
+    {
+        if (!value)
+            return false;
+        int result{ PyDict_SetItemString(dict, key, value) };
+        Py_DECREF(value);
+        return result == 0;
+    }
+
+    PyObject* finishDict(PyObject* dict, bool ok)
+    {
+        if (ok)
+            return dict;
+        Py_DECREF(dict);
+        return nullptr;
+    }
+
+    // Runs the simulation with the GIL released, so other Python threads
+    // keep going; C++ exceptions come back as RuntimeError
+    template <class Function>
+    bool runWithoutGil(Function&& function)
+    {
+        std::string error{};
+        bool failed{};
+        Py_BEGIN_ALLOW_THREADS
+        try
+        {
+            function();
+        }
+        catch (const std::exception& exception)
+        {
+            failed = true;
+            error = exception.what();
+        }
+        Py_END_ALLOW_THREADS
+
+        if (failed)
+            PyErr_SetString(PyExc_RuntimeError, error.c_str());
+        return !failed;
+    }
+
+    // Keyword-only fields of SystemConfiguration, the defaults are its own
+    bool parseConfiguration(PyObject* args, PyObject* kwargs, QS::SystemConfiguration& conf)
+    {
+        static const char* keywords[]{ "sources_count", "distr_range", "buffer_size", "devices_count",
+            "lambda_", "requests_limit", "target_precision", nullptr };
+        return PyArg_ParseTupleAndKeywords(args, kwargs, "|$ifiifid", const_cast<char**>(keywords),
+            &conf.sourcesCount, &conf.distrRange, &conf.bufferSize, &conf.devicesCount,
+            &conf.lambda, &conf.requestsLimit, &conf.targetPrecision);
+    }
+
+    bool checkConfiguration(const QS::SystemConfiguration& conf)
+    {
+        if (conf.sourcesCount > 0 && conf.bufferSize > 0 && conf.devicesCount > 0 && conf.requestsLimit > 0 &&
+            conf.distrRange > 0.0f && conf.lambda > 0.0f)
+            return true;
+        PyErr_SetString(PyExc_ValueError, "counts, distr_range and lambda_ must be positive");
+        return false;
+    }
+
+    // The sweep of the research functions, without telemetry, as Python
+    // threads run several at once
+    std::vector<QS::SweepPointStats> runSweepQuietly(const QS::SweepSpec& spec)
+    {
+        return QS::runSweepChunk(spec, 0, QS::getSweepPointsCount(spec.kind));
+    }
+
+    bool parseSweepKind(const char* name, QS::SweepKind& kind)
+    {
+        static const std::pair<const char*, QS::SweepKind> kinds[]{
+            { "research", QS::SweepKind::research },
+            { "vary_devices_count", QS::SweepKind::varyDevicesCount },
+            { "vary_lambda", QS::SweepKind::varyLambda },
+            { "vary_buffer_size", QS::SweepKind::varyBufferSize },
+        };
+        for (const auto& [kindName, value] : kinds)
+        {
+            if (std::string{ kindName } == name)
+            {
+                kind = value;
+                return true;
+            }
+        }
+        PyErr_Format(PyExc_ValueError, "unknown sweep kind '%s'", name);
+        return false;
+    }
+
+    PyObject* makeSweepPointsDict(const std::shared_ptr<const std::vector<QS::SweepPointStats>>& points)
+    {
+        using Point = QS::SweepPointStats;
+
+        auto dict{ PyDict_New() };
+        if (!dict)
+            return nullptr;
+
+        bool ok{ setItem(dict, "index", makeColumn(points, [](const Point& point) -> const int& { return point.index; })) &&
+            setItem(dict, "rejection_probability", makeColumn(points,
+                [](const Point& point) -> const double& { return point.rejectionProbability; })) &&
+            setItem(dict, "workload", makeColumn(points,
+                [](const Point& point) -> const double& { return point.workload; })) &&
+            setItem(dict, "simulated", makeColumn(points,
+                [](const Point& point) -> const bool& { return point.simulated; })) &&
+            setItem(dict, "required_requests_count", makeColumn(points,
+                [](const Point& point) -> const int& { return point.requiredRequestsCount; })) &&
+            setItem(dict, "average_buffer_time", makeColumn(points,
+                [](const Point& point) -> const double& { return point.averageBufferTime; })) &&
+            setItem(dict, "average_service_time", makeColumn(points,
+                [](const Point& point) -> const double& { return point.averageServiceTime; })) &&
+            setItem(dict, "min_utilization", makeColumn(points,
+                [](const Point& point) -> const double& { return point.minUtilization; })) &&
+            setItem(dict, "max_utilization", makeColumn(points,
+                [](const Point& point) -> const double& { return point.maxUtilization; })) &&
+            setItem(dict, "rejection_half_width", makeColumn(points,
+                [](const Point& point) -> const double& { return point.rejectionHalfWidth; })) &&
+            setItem(dict, "average_waiting_time", makeColumn(points,
+                [](const Point& point) -> const double& { return point.averageWaitingTime; })) &&
+            setItem(dict, "waiting_time_half_width", makeColumn(points,
+                [](const Point& point) -> const double& { return point.waitingTimeHalfWidth; })) };
+        return finishDict(dict, ok);
+    }
+
+    PyObject* makeConfStatsDict(const std::shared_ptr<const QS::ResearchedConfStats>& confStats)
+    {
+        using Stats = QS::SystemConfigurationStats;
+
+        auto dict{ PyDict_New() };
+        if (!dict)
+            return nullptr;
+
+        bool ok{ setItem(dict, "sources_count", makeColumn(confStats,
+                [](const Stats& stats) -> const int& { return stats.conf.sourcesCount; })) &&
+            setItem(dict, "distr_range", makeColumn(confStats,
+                [](const Stats& stats) -> const float& { return stats.conf.distrRange; })) &&
+            setItem(dict, "buffer_size", makeColumn(confStats,
+                [](const Stats& stats) -> const int& { return stats.conf.bufferSize; })) &&
+            setItem(dict, "devices_count", makeColumn(confStats,
+                [](const Stats& stats) -> const int& { return stats.conf.devicesCount; })) &&
+            setItem(dict, "lambda_", makeColumn(confStats,
+                [](const Stats& stats) -> const float& { return stats.conf.lambda; })) &&
+            setItem(dict, "requests_limit", makeColumn(confStats,
+                [](const Stats& stats) -> const int& { return stats.conf.requestsLimit; })) &&
+            setItem(dict, "rejection_probability", makeColumn(confStats,
+                [](const Stats& stats) -> const double& { return stats.rejectionProbability; })) &&
+            setItem(dict, "workload", makeColumn(confStats,
+                [](const Stats& stats) -> const double& { return stats.workload; })) };
+        return finishDict(dict, ok);
+    }
+
+    PyObject* makeGraphicsTuple(const std::shared_ptr<const QS::GraphicsData>& graphics)
+    {
+        auto column{ [&graphics](const std::vector<float>& values)
+            {
+                return makeArray(graphics, values.data(), static_cast<Py_ssize_t>(values.size()));
+            } };
+
+        auto x{ column(graphics->first) };
+        auto rejectionProbability{ x ? column(graphics->second.first) : nullptr };
+        auto workload{ rejectionProbability ? column(graphics->second.second) : nullptr };
+        if (!workload)
+        {
+            Py_XDECREF(x);
+            Py_XDECREF(rejectionProbability);
+            return nullptr;
+        }
+
+        auto tuple{ PyTuple_Pack(3, x, rejectionProbability, workload) };
+        Py_DECREF(x);
+        Py_DECREF(rejectionProbability);
+        Py_DECREF(workload);
+        return tuple;
+    }
+
+    // SystemFinalStats keeps the sources and the devices behind pointers, they
+    // are laid out once into records next to it; the time windows are read in place
+    struct SourceRecord
+    {
+        int requestsCount{};
+        double rejectionProbability{};
+        double averageBufferTime{};
+        double averageServiceTime{};
+        double averageProcessingTime{};
+        double bufferTimeDispersion{};
+        double serviceTimeDispersion{};
+    };
+
+    struct FinalStatsResults
+    {
+        QS::SystemFinalStats stats{};
+        std::vector<SourceRecord> sources{};
+        std::vector<QS::DeviceFinalStats> devices{};
+    };
+
+    template <class Owner, class Record>
+    std::shared_ptr<const std::vector<Record>> getMember(const std::shared_ptr<Owner>& owner,
+        const std::vector<Record>& member)
+    {
+        return std::shared_ptr<const std::vector<Record>>{ owner, &member };
+    }
+
+    PyObject* makeEstimateDict(const QS::SteadyStateEstimate& estimate)
+    {
+        return Py_BuildValue("{s:d,s:d,s:L,s:i,s:L}", "mean", estimate.mean, "half_width", estimate.halfWidth,
+            "warmup_count", estimate.warmupCount, "batches_count", estimate.batchesCount,
+            "batch_size", estimate.batchSize);
+    }
+
+    PyObject* makePercentilesDict(const QS::LatencyHistogram& histogram)
+    {
+        auto dict{ PyDict_New() };
+        if (!dict)
+            return nullptr;
+
+        for (double percentile : QS::REPORTED_PERCENTILES)
+        {
+            auto key{ PyFloat_FromDouble(percentile) };
+            auto value{ key ? PyFloat_FromDouble(histogram.getPercentile(percentile)) : nullptr };
+            bool ok{ value && PyDict_SetItem(dict, key, value) == 0 };
+            Py_XDECREF(key);
+            Py_XDECREF(value);
+            if (!ok)
+                return finishDict(dict, false);
+        }
+        return dict;
+    }
+
+    PyObject* makeFinalStatsDict(QS::SystemFinalStats&& stats)
+    {
+        auto results{ std::make_shared<FinalStatsResults>() };
+        results->stats = std::move(stats);
+        for (const auto& source : results->stats.sourcesFinalStats)
+            results->sources.push_back(SourceRecord{ source->requestsCount, source->rejectionProbability,
+                source->averageBufferTime, source->averageServiceTime, source->averageProcessingTime,
+                source->bufferTimeDispersion, source->serviceTimeDispersion });
+        for (const auto& device : results->stats.deviceFinalStats)
+            results->devices.push_back(*device);
+
+        const auto& finalStats{ results->stats };
+        auto sources{ getMember(results, results->sources) };
+        auto devices{ getMember(results, results->devices) };
+        auto windows{ getMember(results, finalStats.timeWindows) };
+
+        auto dict{ PyDict_New() };
+        auto sourcesDict{ PyDict_New() };
+        auto devicesDict{ PyDict_New() };
+        auto windowsDict{ PyDict_New() };
+        bool ok{ dict && sourcesDict && devicesDict && windowsDict };
+
+        using Device = QS::DeviceFinalStats;
+        using Window = QS::TimeWindow;
+        ok = ok &&
+            setItem(sourcesDict, "requests_count", makeColumn(sources,
+                [](const SourceRecord& source) -> const int& { return source.requestsCount; })) &&
+            setItem(sourcesDict, "rejection_probability", makeColumn(sources,
+                [](const SourceRecord& source) -> const double& { return source.rejectionProbability; })) &&
+            setItem(sourcesDict, "average_buffer_time", makeColumn(sources,
+                [](const SourceRecord& source) -> const double& { return source.averageBufferTime; })) &&
+            setItem(sourcesDict, "average_service_time", makeColumn(sources,
+                [](const SourceRecord& source) -> const double& { return source.averageServiceTime; })) &&
+            setItem(sourcesDict, "average_processing_time", makeColumn(sources,
+                [](const SourceRecord& source) -> const double& { return source.averageProcessingTime; })) &&
+            setItem(sourcesDict, "buffer_time_dispersion", makeColumn(sources,
+                [](const SourceRecord& source) -> const double& { return source.bufferTimeDispersion; })) &&
+            setItem(sourcesDict, "service_time_dispersion", makeColumn(sources,
+                [](const SourceRecord& source) -> const double& { return source.serviceTimeDispersion; })) &&
+            setItem(devicesDict, "requests_count", makeColumn(devices,
+                [](const Device& device) -> const int& { return device.requestsCount; })) &&
+            setItem(devicesDict, "average_service_time", makeColumn(devices,
+                [](const Device& device) -> const double& { return device.averageServiceTime; })) &&
+            setItem(devicesDict, "utilization_factor", makeColumn(devices,
+                [](const Device& device) -> const double& { return device.utilizationFactor; })) &&
+            setItem(windowsDict, "start", makeColumn(windows,
+                [](const Window& window) -> const double& { return window.start; })) &&
+            setItem(windowsDict, "duration", makeColumn(windows,
+                [](const Window& window) -> const double& { return window.duration; })) &&
+            setItem(windowsDict, "arrivals_count", makeColumn(windows,
+                [](const Window& window) -> const long long& { return window.arrivalsCount; })) &&
+            setItem(windowsDict, "rejections_count", makeColumn(windows,
+                [](const Window& window) -> const long long& { return window.rejectionsCount; })) &&
+            setItem(windowsDict, "busy_time", makeColumn(windows,
+                [](const Window& window) -> const double& { return window.busyTime; })) &&
+            setItem(windowsDict, "occupancy_time", makeColumn(windows,
+                [](const Window& window) -> const double& { return window.occupancyTime; }));
+
+        ok = ok &&
+            setItem(dict, "rejection_probability", PyFloat_FromDouble(finalStats.rejectionProbability)) &&
+            setItem(dict, "workload", PyFloat_FromDouble(finalStats.workload)) &&
+            setItem(dict, "required_requests_count", PyLong_FromLong(finalStats.requiredRequestsCount)) &&
+            setItem(dict, "rejection_estimate", makeEstimateDict(finalStats.rejectionEstimate)) &&
+            setItem(dict, "waiting_time_estimate", makeEstimateDict(finalStats.waitingTimeEstimate)) &&
+            setItem(dict, "waiting_time_percentiles", makePercentilesDict(finalStats.waitingTimeHistogram)) &&
+            setItem(dict, "sojourn_time_percentiles", makePercentilesDict(finalStats.sojournTimeHistogram));
+
+        ok = ok && PyDict_SetItemString(dict, "sources", sourcesDict) == 0 &&
+            PyDict_SetItemString(dict, "devices", devicesDict) == 0 &&
+            PyDict_SetItemString(dict, "time_windows", windowsDict) == 0;
+        Py_XDECREF(sourcesDict);
+        Py_XDECREF(devicesDict);
+        Py_XDECREF(windowsDict);
+        if (!dict)
+            return nullptr;
+        return finishDict(dict, ok);
+    }
+
+    // Step-by-step model; a run releases the GIL, and the object refuses a
+    // second call from another thread while it is running
+    struct SystemObject
+    {
+        PyObject_HEAD
+        std::unique_ptr<QS::QueueingSystem> system;
+        bool running;
+    };
+
+    bool acquireSystem(SystemObject* self)
+    {
+        if (!self->system)
+        {
+            PyErr_SetString(PyExc_RuntimeError, "the system is not initialized");
+            return false;
+        }
+        if (self->running)
+        {
+            PyErr_SetString(PyExc_RuntimeError, "the system is running in another thread");
+            return false;
+        }
+        self->running = true;
+        return true;
+    }
+
+    PyObject* newSystem(PyTypeObject* type, PyObject*, PyObject*)
+    {
+        auto self{ reinterpret_cast<SystemObject*>(type->tp_alloc(type, 0)) };
+        if (self)
+            new (&self->system) std::unique_ptr<QS::QueueingSystem>{};
+        return reinterpret_cast<PyObject*>(self);
+    }
+
+    int initSystem(PyObject* object, PyObject* args, PyObject* kwargs)
+    {
+        auto self{ reinterpret_cast<SystemObject*>(object) };
+        QS::SystemConfiguration conf{};
+        if (!parseConfiguration(args, kwargs, conf) || !checkConfiguration(conf))
+            return -1;
+        if (self->running)
+        {
+            PyErr_SetString(PyExc_RuntimeError, "the system is running in another thread");
+            return -1;
+        }
+
+        self->system = std::make_unique<QS::QueueingSystem>(conf);
+        return 0;
+    }
+
+    void deallocSystem(PyObject* object)
+    {
+        auto self{ reinterpret_cast<SystemObject*>(object) };
+        self->system.~unique_ptr();
+        auto type{ Py_TYPE(object) };
+        type->tp_free(object);
+        Py_DECREF(type);
+    }
+
+    PyObject* runSystem(PyObject* object, PyObject*)
+    {
+        auto self{ reinterpret_cast<SystemObject*>(object) };
+        if (!acquireSystem(self))
+            return nullptr;
+
+        auto& system{ *self->system };
+        bool ok{ runWithoutGil([&system] { while (system.makeStep()); }) };
+        self->running = false;
+        if (!ok)
+            return nullptr;
+        Py_RETURN_NONE;
+    }
+
+    PyObject* makeSystemStep(PyObject* object, PyObject*)
+    {
+        auto self{ reinterpret_cast<SystemObject*>(object) };
+        if (!acquireSystem(self))
+            return nullptr;
+
+        bool stepped{ self->system->makeStep() };
+        self->running = false;
+        return PyBool_FromLong(stepped);
+    }
+
+    PyObject* resetSystem(PyObject* object, PyObject* args, PyObject* kwargs)
+    {
+        auto self{ reinterpret_cast<SystemObject*>(object) };
+        QS::SystemConfiguration conf{};
+        bool reconfigure{ (args && PyTuple_GET_SIZE(args)) || (kwargs && PyDict_GET_SIZE(kwargs)) };
+        if ((reconfigure && (!parseConfiguration(args, kwargs, conf) || !checkConfiguration(conf))) ||
+            !acquireSystem(self))
+            return nullptr;
+
+        if (reconfigure)
+            self->system->reset(conf);
+        else
+            self->system->reset();
+        self->running = false;
+        Py_RETURN_NONE;
+    }
+
+    PyObject* getSystemFinalStats(PyObject* object, PyObject*)
+    {
+        auto self{ reinterpret_cast<SystemObject*>(object) };
+        if (!acquireSystem(self))
+            return nullptr;
+
+        auto stats{ self->system->getSystemFinalStats() };
+        self->running = false;
+        return makeFinalStatsDict(std::move(stats));
+    }
+
+    PyObject* getSystemTime(PyObject* object, void*)
+    {
+        auto self{ reinterpret_cast<SystemObject*>(object) };
+        if (!self->system)
+            Py_RETURN_NONE;
+        if (!acquireSystem(self))
+            return nullptr;
+
+        double time{ self->system->getTime() };
+        self->running = false;
+        return PyFloat_FromDouble(time);
+    }
+
+    PyMethodDef systemMethods[]{
+        { "run", runSystem, METH_NOARGS, "Simulates up to the end of the run, the GIL is released meanwhile" },
+        { "make_step", makeSystemStep, METH_NOARGS, "Processes the next event, False once the run is over" },
+        { "reset", reinterpret_cast<PyCFunction>(reinterpret_cast<void(*)()>(resetSystem)),
+            METH_VARARGS | METH_KEYWORDS, "Starts over, with a new configuration when one is given" },
+        { "final_stats", getSystemFinalStats, METH_NOARGS, "SystemFinalStats as a dict of values and arrays" },
+        { nullptr, nullptr, 0, nullptr },
+    };
+
+    PyGetSetDef systemGetters[]{
+        { "time", getSystemTime, nullptr, "Time of the last processed event", nullptr },
+        { nullptr, nullptr, nullptr, nullptr, nullptr },
+    };
+
+    PyType_Slot systemSlots[]{
+        { Py_tp_new, reinterpret_cast<void*>(newSystem) },
+        { Py_tp_init, reinterpret_cast<void*>(initSystem) },
+        { Py_tp_dealloc, reinterpret_cast<void*>(deallocSystem) },
+        { Py_tp_methods, systemMethods },
+        { Py_tp_getset, systemGetters },
+        { Py_tp_doc, const_cast<char*>("QueueingSystem(*, sources_count, distr_range, buffer_size, "
+            "devices_count, lambda_, requests_limit, target_precision)") },
+        { 0, nullptr },
+    };
+
+    PyType_Spec systemSpec{ "queueing_system.QueueingSystem", sizeof(SystemObject), 0,
+        Py_TPFLAGS_DEFAULT, systemSlots };
+
+    PyObject* runSweep(PyObject*, PyObject* args, PyObject* kwargs)
+    {
+        const char* kindName{};
+        int prescreen{};
+        QS::SweepSpec spec{};
+
+        // The sweep keywords come first, the rest is the base configuration
+        static const char* keywords[]{ "kind", "prescreen", "sources_count", "distr_range", "buffer_size",
+            "devices_count", "lambda_", "requests_limit", "target_precision", nullptr };
+        auto& conf{ spec.baseConf };
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "s|$pifiifid", const_cast<char**>(keywords),
+            &kindName, &prescreen, &conf.sourcesCount, &conf.distrRange, &conf.bufferSize, &conf.devicesCount,
+            &conf.lambda, &conf.requestsLimit, &conf.targetPrecision) ||
+            !parseSweepKind(kindName, spec.kind) || !checkConfiguration(conf))
+            return nullptr;
+        spec.prescreen = prescreen;
+
+        auto points{ std::make_shared<std::vector<QS::SweepPointStats>>() };
+        if (!runWithoutGil([&points, &spec] { *points = runSweepQuietly(spec); }))
+            return nullptr;
+        return makeSweepPointsDict(points);
+    }
+
+    PyObject* runConfiguration(PyObject*, PyObject* args, PyObject* kwargs)
+    {
+        QS::SystemConfiguration conf{};
+        if (!parseConfiguration(args, kwargs, conf) || !checkConfiguration(conf))
+            return nullptr;
+
+        QS::SystemFinalStats stats{};
+        if (!runWithoutGil([&stats, &conf]
+            {
+                QS::QueueingSystem system{ conf };
+                while (system.makeStep());
+                stats = system.getSystemFinalStats();
+            }))
+            return nullptr;
+        return makeFinalStatsDict(std::move(stats));
+    }
+
+    PyObject* research(PyObject*, PyObject* args, PyObject* kwargs)
+    {
+        int sourcesCount{ 10 };
+        float distrRange{ 5.0f };
+        int prescreen{};
+
+        static const char* keywords[]{ "sources_count", "distr_range", "prescreen", nullptr };
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|ifp", const_cast<char**>(keywords),
+            &sourcesCount, &distrRange, &prescreen))
+            return nullptr;
+
+        auto confStats{ std::make_shared<QS::ResearchedConfStats>() };
+        if (!runWithoutGil([&confStats, sourcesCount, distrRange, prescreen]
+            {
+                *confStats = QS::researchQueueingSystem(sourcesCount, distrRange, runSweepQuietly, prescreen);
+            }))
+            return nullptr;
+        return makeConfStatsDict(confStats);
+    }
+
+    template <class Vary>
+    PyObject* getGraphicsData(Vary vary)
+    {
+        auto graphics{ std::make_shared<QS::GraphicsData>() };
+        if (!runWithoutGil([&graphics, &vary] { *graphics = vary(); }))
+            return nullptr;
+        return makeGraphicsTuple(graphics);
+    }
+
+    PyObject* graphicsVaryDevicesCount(PyObject*, PyObject* args, PyObject* kwargs)
+    {
+        int bufferSize{};
+        float lambda{};
+        static const char* keywords[]{ "buffer_size", "lambda_", nullptr };
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "if", const_cast<char**>(keywords), &bufferSize, &lambda))
+            return nullptr;
+        return getGraphicsData([bufferSize, lambda]
+            {
+                return QS::getGraphicsDataVaryDevicesCount(bufferSize, lambda, runSweepQuietly);
+            });
+    }
+
+    PyObject* graphicsVaryLambda(PyObject*, PyObject* args, PyObject* kwargs)
+    {
+        int bufferSize{};
+        int devicesCount{};
+        static const char* keywords[]{ "buffer_size", "devices_count", nullptr };
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "ii", const_cast<char**>(keywords),
+            &bufferSize, &devicesCount))
+            return nullptr;
+        return getGraphicsData([bufferSize, devicesCount]
+            {
+                return QS::getGraphicsDataVaryLambda(bufferSize, devicesCount, runSweepQuietly);
+            });
+    }
+
+    PyObject* graphicsVaryBufferSize(PyObject*, PyObject* args, PyObject* kwargs)
+    {
+        int devicesCount{};
+        float lambda{};
+        static const char* keywords[]{ "devices_count", "lambda_", nullptr };
+        if (!PyArg_ParseTupleAndKeywords(args, kwargs, "if", const_cast<char**>(keywords), &devicesCount, &lambda))
+            return nullptr;
+        return getGraphicsData([devicesCount, lambda]
+            {
+                return QS::getGraphicsDataVaryBufferSize(devicesCount, lambda, runSweepQuietly);
+            });
+    }
+
+    template <PyObject* (*Function)(PyObject*, PyObject*, PyObject*)>
+    PyCFunction withKeywords()
+    {
+        return reinterpret_cast<PyCFunction>(reinterpret_cast<void(*)()>(Function));
+    }
+
+    PyMethodDef moduleMethods[]{
+        { "run_sweep", withKeywords<runSweep>(), METH_VARARGS | METH_KEYWORDS,
+            "run_sweep(kind, *, prescreen=False, **configuration) -> dict of point columns\n"
+            "kind is research, vary_devices_count, vary_lambda or vary_buffer_size" },
+        { "run_configuration", withKeywords<runConfiguration>(), METH_VARARGS | METH_KEYWORDS,
+            "run_configuration(**configuration) -> final stats of one run" },
+        { "research", withKeywords<research>(), METH_VARARGS | METH_KEYWORDS,
+            "research(sources_count=10, distr_range=5.0, prescreen=False) -> best configurations columns" },
+        { "graphics_vary_devices_count", withKeywords<graphicsVaryDevicesCount>(), METH_VARARGS | METH_KEYWORDS,
+            "graphics_vary_devices_count(buffer_size, lambda_) -> (x, rejection_probability, workload)" },
+        { "graphics_vary_lambda", withKeywords<graphicsVaryLambda>(), METH_VARARGS | METH_KEYWORDS,
+            "graphics_vary_lambda(buffer_size, devices_count) -> (x, rejection_probability, workload)" },
+        { "graphics_vary_buffer_size", withKeywords<graphicsVaryBufferSize>(), METH_VARARGS | METH_KEYWORDS,
+            "graphics_vary_buffer_size(devices_count, lambda_) -> (x, rejection_probability, workload)" },
+        { nullptr, nullptr, 0, nullptr },
+    };
+
+    PyModuleDef moduleDef{ PyModuleDef_HEAD_INIT, "queueing_system",
+        "Bindings of the queueing system model and its sweeps. Results are columns\n"
+        "sharing memory with the C++ results, the simulation releases the GIL.",
+        -1, moduleMethods };
+}
+
+PyMODINIT_FUNC PyInit_queueing_system()
+{
+    auto module{ PyModule_Create(&moduleDef) };
+    if (!module)
+        return nullptr;
+
+    arrayType = reinterpret_cast<PyTypeObject*>(PyType_FromSpec(&arraySpec));
+    auto systemType{ PyType_FromSpec(&systemSpec) };
+    if (!arrayType || !systemType ||
+        PyModule_AddObjectRef(module, "Array", reinterpret_cast<PyObject*>(arrayType)) < 0 ||
+        PyModule_AddObjectRef(module, "QueueingSystem", systemType) < 0)
+    {
+        Py_XDECREF(systemType);
+        Py_DECREF(module);
+        return nullptr;
+    }
+    Py_DECREF(systemType);
+    return module;
+}
@@ -0,0 +1,35 @@
+# Builds the queueing_system extension from the engine sources of the
+# repository: python setup.py build_ext --inplace
+import sys
+from pathlib import Path
+
+from setuptools import Extension, setup
+
+ROOT = Path(__file__).resolve().parent.parent
+# The GUI and its entry point need ImGui and GLFW, the bindings do not
+GUI_SOURCES = {"main.cpp", "queueing_system_gui.cpp"}
+
+sources = ["queueing_system_module.cpp"] + sorted(
+    str(path) for path in ROOT.glob("*.cpp") if path.name not in GUI_SOURCES)
+
+if sys.platform == "win32":
+    compile_args = ["/std:c++20", "/O2", "/EHsc"]
+    libraries = ["ws2_32"]
+else:
+    compile_args = ["-std=c++20", "-O2"]
+    libraries = []
+
+setup(
+    name="queueing_system",
+    version="1.0",
+    description="Bindings of the queueing system model and its sweeps",
+    python_requires=">=3.10",
+    ext_modules=[Extension(
+        "queueing_system",
+        sources=sources,
+        include_dirs=[str(ROOT)],
+        extra_compile_args=compile_args,
+        libraries=libraries,
+        language="c++",
+    )],
+)
@@ -1,4 +1,5 @@
 #include "queueing_system.h"
+#include "entity_pool.h"
 
 #include <memory>
 #include <algorithm>
@@ -6,19 +7,46 @@
 
 namespace QS = QueueingSystem;
 
+namespace
+{
+    int getConfSourcesCount(const QS::SystemConfiguration& conf)
+    {
+        return conf.trace ? conf.trace->getSourcesCount() : conf.sourcesCount;
+    }
+}
+
+int QS::getConfRequestsLimit(const SystemConfiguration& conf)
+{
+    return conf.trace ? static_cast<int>(std::min<std::int64_t>(conf.requestsLimit,
+        conf.trace->getRecordsCount())) : conf.requestsLimit;
+}
+
 QS::QueueingSystem::QueueingSystem(const SystemConfiguration& conf):
-    sources_(conf.sourcesCount),
+    sources_(getConfSourcesCount(conf)),
     devices_(conf.devicesCount),
     buffer_(std::make_unique<Buffer>(conf.bufferSize)),
-    requestsLimit_(conf.requestsLimit)
+    requestsLimit_(getConfRequestsLimit(conf)),
+    arrivalDistribution_(conf.arrivalDistribution),
+    serviceDistribution_(conf.serviceDistribution),
+    trace_(conf.trace),
+    eventSetType_(conf.eventSet),
+    targetPrecision_(conf.targetPrecision)
 {
-    for (int i{ 0 }; i < conf.sourcesCount; ++i)
-        sources_[i] = std::make_unique<Source>(i);
+    for (int i{ 0 }; i < sources_.size(); ++i)
+    {
+        sources_[i] = makeSource(i, conf);
+        if (!trace_ && arrivalDistribution_)
+            sources_[i]->setDistribution(*arrivalDistribution_);
+    }
 
     for (int i{ 0 }; i < conf.devicesCount; ++i)
-        devices_[i] = std::make_unique<Device>(i);
+    {
+        devices_[i] = std::make_unique<Device>(i, conf.lambda);
+        if (serviceDistribution_)
+            devices_[i]->setDistribution(*serviceDistribution_);
+    }
 
-    calendarOfEvents_ = std::make_unique<CalendarOfEvents>(sources_, devices_);
+    calendarOfEvents_ = std::make_unique<CalendarOfEvents>(sources_, devices_, eventSetType_);
     stats_ = std::make_unique<Statistics>(sources_, devices_);
 }
 
@@ -43,7 +71,12 @@ QS::SystemFinalStats QueueingSystem::QueueingSystem::getSystemFinalStats() const
         rejectionProbability,
         stats_->getSystemWorkLoad(),
         static_cast<int>((1.643 * 1.643 * (1 - rejectionProbability)) /
-        (rejectionProbability * 0.1 * 0.1))
+        (rejectionProbability * 0.1 * 0.1)),
+        stats_->getRejectionEstimate(),
+        stats_->getWaitingTimeEstimate(),
+        stats_->getWaitingTimeHistogram(),
+        stats_->getSojournTimeHistogram(),
+        stats_->getTimeWindows()
     };
 }
 
@@ -52,6 +85,35 @@ int QS::QueueingSystem::getRequestsLimit() const
     return requestsLimit_;
 }
 
+int QS::QueueingSystem::getDevicesCount() const
+{
+    return static_cast<int>(devices_.size());
+}
+
+double QS::QueueingSystem::getTime() const
+{
+    return time_;
+}
+
+const QS::StepRecord& QS::QueueingSystem::getLastStep() const
+{
+    return lastStep_;
+}
+
+const std::vector<QS::TimeWindow>& QS::QueueingSystem::getTimeWindows() const
+{
+    return stats_->getTimeWindows();
+}
+
+void QS::QueueingSystem::reseed(std::mt19937& seeder)
+{
+    for (const auto& source : sources_)
+        source->reseed(seeder);
+
+    for (const auto& device : devices_)
+        device->reseed(seeder);
+}
+
 void QS::QueueingSystem::reset()
 {
     for (const auto& source : sources_)
@@ -64,50 +126,87 @@ void QS::QueueingSystem::reset()
 
     requestsCount_ = 0;
     deviceIndex_ = 0;
+    busyDevicesCount_ = 0;
+    precisionReached_ = false;
+    time_ = 0.0;
+    lastStep_ = StepRecord{};
 
+    calendarOfEvents_->reset();
     stats_->reset();
 }
 
 void QS::QueueingSystem::reset(const SystemConfiguration& conf)
 {
+    // Trace sources are replaced as a whole when the trace changes
+    bool traceChanged{ conf.trace != trace_ };
+    // With a prototype distribution the range and lambda are not used, so
+    // only the prototype decides whether sources and devices take it again
+    bool arrivalChanged{ conf.arrivalDistribution != arrivalDistribution_ ||
+        (!conf.arrivalDistribution &&
+            (sources_.empty() || sources_.front()->getDistributionRange() != conf.distrRange)) };
+    trace_ = conf.trace;
+    arrivalDistribution_ = conf.arrivalDistribution;
+
+    if (traceChanged)
+    {
+        sources_.clear();
+        spareSources_.clear();
+    }
+
+    // Sources taken back from the pool may hold an older arrival setting
     auto oldSourcesCount{ sources_.size() };
-    sources_.resize(conf.sourcesCount);
-    if (conf.sourcesCount > oldSourcesCount)
-        for (auto i{ oldSourcesCount }; i < conf.sourcesCount; ++i)
-            sources_[i] = std::make_unique<Source>(i);
+    auto sourcesCount{ static_cast<std::size_t>(getConfSourcesCount(conf)) };
+    resizeFromPool(sources_, spareSources_, sourcesCount,
+        [this, &conf](std::size_t i) { return makeSource(static_cast<int>(i), conf); });
 
-    if (sources_.front()->getDistributionRange() != conf.distrRange)
-        for (const auto& source : sources_)
-            source->setDistributionRange(conf.distrRange);
+    if (!trace_)
+        for (auto i{ arrivalChanged ? 0 : oldSourcesCount }; i < sourcesCount; ++i)
+            configureSource(*sources_[i], conf);
 
     buffer_->reset(conf.bufferSize);
 
     auto oldDevicesCount{ devices_.size() };
-    devices_.resize(conf.devicesCount);
-    if (conf.devicesCount > oldDevicesCount)
-        for (auto i{ oldDevicesCount }; i < conf.devicesCount; ++i)
-            devices_[i] = std::make_unique<Device>(i);
+    bool serviceChanged{ conf.serviceDistribution != serviceDistribution_ ||
+        (!conf.serviceDistribution && (devices_.empty() || devices_.front()->getLambda() != conf.lambda)) };
+    serviceDistribution_ = conf.serviceDistribution;
+    resizeFromPool(devices_, spareDevices_, conf.devicesCount,
+        [&conf](std::size_t i) { return std::make_unique<Device>(static_cast<int>(i), conf.lambda); });
 
-    if (devices_.front()->getLambda() != conf.lambda)
-        for (const auto& device : devices_)
-            device->setLambda(conf.lambda);
+    for (auto i{ serviceChanged ? 0 : oldDevicesCount }; i < devices_.size(); ++i)
+        configureDevice(*devices_[i], conf);
 
-    if (requestsLimit_ != conf.requestsLimit)
-        requestsLimit_ = conf.requestsLimit;
+    requestsLimit_ = getConfRequestsLimit(conf);
+    targetPrecision_ = conf.targetPrecision;
 
-    if (oldSourcesCount != conf.sourcesCount || oldDevicesCount != conf.devicesCount)
-    {
-        calendarOfEvents_ = std::make_unique<CalendarOfEvents>(sources_, devices_);
-        stats_ = std::make_unique<Statistics>(sources_, devices_);
-    }
+    if (eventSetType_ != conf.eventSet)
+        calendarOfEvents_ = std::make_unique<CalendarOfEvents>(sources_, devices_, conf.eventSet);
+    else if (traceChanged || oldSourcesCount != sourcesCount || oldDevicesCount != devices_.size())
+        calendarOfEvents_->resize(sources_, devices_);
+    eventSetType_ = conf.eventSet;
+
+    if (traceChanged || oldSourcesCount != sourcesCount || oldDevicesCount != devices_.size())
+        stats_->resize(sources_, devices_);
 
     reset();
 }
 
+void QS::QueueingSystem::reserve(const SystemConfiguration& conf)
+{
+    auto sourcesCount{ static_cast<std::size_t>(getConfSourcesCount(conf)) };
+    sources_.reserve(sourcesCount);
+    spareSources_.reserve(sourcesCount);
+    devices_.reserve(conf.devicesCount);
+    spareDevices_.reserve(conf.devicesCount);
+
+    buffer_->reserve(conf.bufferSize);
+    calendarOfEvents_->reserve(static_cast<int>(sourcesCount), conf.devicesCount);
+    stats_->reserve(static_cast<int>(sourcesCount), conf.devicesCount);
+}
+
 bool QS::QueueingSystem::makeStep()
 {
     auto nextDeviceEvent{ calendarOfEvents_->getNextEvent(EventType::deviceEvent) };
-    if (requestsCount_ >= requestsLimit_)
+    if (requestsCount_ >= requestsLimit_ || precisionReached_)
     {
         if (**nextDeviceEvent < 0.0)
             return false;
@@ -128,22 +227,74 @@ bool QS::QueueingSystem::makeStep()
     return true;
 }
 
+QS::SystemCheckpoint QS::QueueingSystem::getCheckpoint() const
+{
+    SystemCheckpoint checkpoint{};
+    checkpoint.sources.reserve(sources_.size());
+    for (const auto& source : sources_)
+        checkpoint.sources.push_back(source->getState());
+
+    checkpoint.devices.reserve(devices_.size());
+    for (const auto& device : devices_)
+        checkpoint.devices.push_back(device->getState());
+
+    checkpoint.buffer = buffer_->getState();
+    checkpoint.stats = stats_->getState();
+    checkpoint.deviceIndex = deviceIndex_;
+    checkpoint.busyDevicesCount = busyDevicesCount_;
+    checkpoint.requestsCount = requestsCount_;
+    checkpoint.precisionReached = precisionReached_;
+    checkpoint.time = time_;
+    return checkpoint;
+}
+
+void QS::QueueingSystem::restore(const SystemCheckpoint& checkpoint)
+{
+    for (std::size_t i{ 0 }; i < sources_.size(); ++i)
+        sources_[i]->restore(checkpoint.sources[i]);
+
+    for (std::size_t i{ 0 }; i < devices_.size(); ++i)
+        devices_[i]->restore(checkpoint.devices[i]);
+
+    buffer_->restore(checkpoint.buffer);
+    stats_->restore(checkpoint.stats);
+    deviceIndex_ = checkpoint.deviceIndex;
+    busyDevicesCount_ = checkpoint.busyDevicesCount;
+    requestsCount_ = checkpoint.requestsCount;
+    precisionReached_ = checkpoint.precisionReached;
+    time_ = checkpoint.time;
+
+    // Event sets order by time and index only, rebuilt from the entities
+    // they give the same next events
+    calendarOfEvents_->reset();
+}
+
 void QS::QueueingSystem::processEvent(const EventConstIter& eventIter, EventType eventType)
 {
     double time{ **eventIter };
     auto eventIndex{ calendarOfEvents_->getEventIndex(eventIter, eventType) };
+    time_ = time;
+    lastStep_.eventType = eventType;
+    lastStep_.entityId = eventIndex;
+    lastStep_.startedDeviceId = -1;
 
     if (eventType == EventType::sourceEvent)
     {
         auto request{ sources_[eventIndex]->generateRequest() };
+        calendarOfEvents_->update(EventType::sourceEvent, eventIndex);
 
         ++requestsCount_;
 
-        if (!buffer_->placeRequestInBuffer(request))
+        bool placed{ buffer_->placeRequestInBuffer(request) };
+        if (!placed)
         {
             auto rejectedRequest{ buffer_->getLastRejectedRequest() };
             stats_->incSourceRejectionsCount(rejectedRequest->id.sourceId);
         }
+        stats_->addArrival(time, !placed);
+
+        if (targetPrecision_ > 0.0 && requestsCount_ % PRECISION_CHECK_PERIOD == 0)
+            precisionReached_ = isPrecise(stats_->getRejectionEstimate(), targetPrecision_);
 
         tryProcessRequest(time);
     }
@@ -154,12 +305,41 @@ void QS::QueueingSystem::processEvent(const EventConstIter& eventIter, EventType
         stats_->addDeviceStats(eventIndex, device->getProcessingTime());
         stats_->addSourceServiceTime(device->getProcessingRequestSourceId(),
             device->getProcessingTime());
+        stats_->addSourceSojournTime(device->getProcessingRequestSourceId(),
+            time - device->getProcessingRequestGenerationTime());
 
         device->endProcessingRequest();
+        --busyDevicesCount_;
+        calendarOfEvents_->update(EventType::deviceEvent, eventIndex);
 
         if (!buffer_->isRequestsBufferEmpty())
             tryProcessRequest(time);
     }
+    lastStep_.bufferOccupancy = buffer_->getOccupancy();
+    stats_->setLevels(time, busyDevicesCount_, lastStep_.bufferOccupancy);
+}
+
+QS::USource QS::QueueingSystem::makeSource(int sourceId, const SystemConfiguration& conf) const
+{
+    if (trace_)
+        return std::make_unique<TraceSource>(sourceId, trace_);
+    return std::make_unique<Source>(sourceId, conf.distrRange);
+}
+
+void QS::QueueingSystem::configureSource(Source& source, const SystemConfiguration& conf) const
+{
+    if (arrivalDistribution_)
+        source.setDistribution(*arrivalDistribution_);
+    else
+        source.setDistributionRange(conf.distrRange);
+}
+
+void QS::QueueingSystem::configureDevice(Device& device, const SystemConfiguration& conf) const
+{
+    if (serviceDistribution_)
+        device.setDistribution(*serviceDistribution_);
+    else
+        device.setLambda(conf.lambda);
 }
 
 void QS::QueueingSystem::tryProcessRequest(double startTime)
@@ -172,8 +352,13 @@ void QS::QueueingSystem::tryProcessRequest(double startTime)
         if (startTime != request->generationTime)
             stats_->addSourceBufferTime(request->id.sourceId,
                 startTime - request->generationTime);
+        stats_->addWaitingTime(request->id.sourceId, startTime - request->generationTime);
 
         devices_[freeDeviceIndex]->processRequest(request, startTime);
+        ++busyDevicesCount_;
+        lastStep_.startedDeviceId = freeDeviceIndex;
+        lastStep_.serviceEndTime = *devices_[freeDeviceIndex]->getProcessingEndTimePtr();
+        calendarOfEvents_->update(EventType::deviceEvent, freeDeviceIndex);
 
         deviceIndex_ = freeDeviceIndex < devices_.size() - 1 ?
             freeDeviceIndex + 1 : deviceIndex_ = 0;
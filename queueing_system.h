@@ -6,12 +6,15 @@
 #include "device.h"
 #include "calendar_of_events.h"
 #include "statistics.h"
+#include "trace.h"
 
 #include <vector>
 #include <memory>
 
 namespace QueueingSystem
 {
+    inline constexpr int PRECISION_CHECK_PERIOD{ 1000 };
+
     struct SystemConfiguration
     {
         int sourcesCount{ 10 };
@@ -20,10 +23,49 @@ namespace QueueingSystem
         int devicesCount{ 90 };
         float lambda{ 0.05f };
         int requestsLimit{ 10000 };
+        SDistribution arrivalDistribution{};
+        SDistribution serviceDistribution{};
+        // Replaces the generated arrivals, sourcesCount and arrivalDistribution
+        // are then ignored and requestsLimit only caps the trace length
+        STraceFile trace{};
+        EventSetType eventSet{ EventSetType::linear };
+        // Arrivals stop before requestsLimit once the steady-state rejection
+        // probability is known within this relative half-width, 0 disables
+        double targetPrecision{};
     };
 
     using USystemConfiguration = std::unique_ptr<SystemConfiguration>;
 
+    // Arrivals in a run of conf, a trace may end before requestsLimit
+    int getConfRequestsLimit(const SystemConfiguration& conf);
+
+    // State of a QueueingSystem between two events, valid for the
+    // configuration it was taken with
+    struct SystemCheckpoint
+    {
+        std::vector<SourceState> sources{};
+        std::vector<DeviceState> devices{};
+        std::vector<Request> buffer{};
+        Statistics::State stats{};
+        int deviceIndex{};
+        int busyDevicesCount{};
+        int requestsCount{};
+        bool precisionReached{};
+        double time{};
+    };
+
+    // What the last event did, enough to follow the run from outside
+    struct StepRecord
+    {
+        EventType eventType{};
+        // Source or device the event belongs to
+        int entityId{};
+        // An event starts at most one service, -1 when it started none
+        int startedDeviceId{ -1 };
+        double serviceEndTime{};
+        int bufferOccupancy{};
+    };
+
     class QueueingSystem
     {
     public:
@@ -33,22 +75,55 @@ namespace QueueingSystem
         SystemFinalStats getSystemFinalStats() const;
 
         int getRequestsLimit() const;
+        int getDevicesCount() const;
+        // Time of the last processed event
+        double getTime() const;
+        const StepRecord& getLastStep() const;
+        // Windows of the run so far, the last one in progress
+        const std::vector<TimeWindow>& getTimeWindows() const;
+
+        // Seeds the sources, then the devices, one value of the seeder each;
+        // the streams of a generated model are then reproducible
+        void reseed(std::mt19937& seeder);
 
         void reset();
+        // Entities removed by a smaller configuration are kept for a larger
+        // one, so a sweep constructs every source and device once
         void reset(const SystemConfiguration& conf);
+        // Capacity for the largest configuration a sweep is going to reach
+        void reserve(const SystemConfiguration& conf);
 
         bool makeStep();
 
+        SystemCheckpoint getCheckpoint() const;
+        // Continues from the checkpoint exactly as the system did after it was
+        // taken. Entities are overwritten in place, so a SystemStatus stays valid.
+        void restore(const SystemCheckpoint& checkpoint);
+
     private:
         void processEvent(const EventConstIter& eventIter, EventType eventType);
         void tryProcessRequest(double startTime);
+        USource makeSource(int sourceId, const SystemConfiguration& conf) const;
+        void configureSource(Source& source, const SystemConfiguration& conf) const;
+        void configureDevice(Device& device, const SystemConfiguration& conf) const;
 
         std::vector<USource> sources_;
         std::vector<UDevice> devices_;
+        std::vector<USource> spareSources_;
+        std::vector<UDevice> spareDevices_;
         std::unique_ptr<Buffer> buffer_;
         int deviceIndex_{};
+        int busyDevicesCount_{};
         int requestsCount_{};
         int requestsLimit_;
+        SDistribution arrivalDistribution_;
+        SDistribution serviceDistribution_;
+        STraceFile trace_;
+        EventSetType eventSetType_;
+        double targetPrecision_;
+        bool precisionReached_{};
+        double time_{};
+        StepRecord lastStep_{};
         std::unique_ptr<CalendarOfEvents> calendarOfEvents_;
         std::unique_ptr<Statistics> stats_;
     };
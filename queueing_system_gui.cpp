@@ -1,5 +1,10 @@
 #include "queueing_system_gui.h"
 #include "queueing_system_research.h"
+#include "distributed_sweep.h"
+#include "simulation_service.h"
+#include "surrogate_search.h"
+#include "simulation_engine.h"
+#include "downsampling.h"
 
 #include <imgui.h>
 #include <implot.h>
@@ -8,6 +13,12 @@
 #include <memory>
 #include <array>
 #include <charconv>
+#include <string>
+#include <exception>
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <fstream>
 
 namespace QS = QueueingSystem;
 namespace QSGui = QueueingSystemGui;
@@ -182,6 +193,52 @@ void QSGui::sourcesResultsTable(const std::vector<QS::USourceFinalStats>& source
     }
 }
 
+void QSGui::percentilesTable(const QS::SystemFinalStats& finalStats, bool sojournTime)
+{
+    constexpr int percentilesCount{ static_cast<int>(std::size(QS::REPORTED_PERCENTILES)) };
+    if (ImGui::BeginTable("Percentiles", percentilesCount + 3, tableFlags))
+    {
+        ImGui::TableSetupColumn(u8"#");
+        ImGui::TableSetupColumn(u8"");
+        for (double percentile : QS::REPORTED_PERCENTILES)
+        {
+            char header[16]{};
+            std::snprintf(header, sizeof(header), "p%g", percentile);
+            ImGui::TableSetupColumn(header);
+        }
+        ImGui::TableSetupColumn(u8"");
+        ImGui::TableHeadersRow();
+
+        auto histogramRow{ [](const char* name, const QS::LatencyHistogram& histogram)
+            {
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%s", name);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", histogram.getMean());
+                for (double percentile : QS::REPORTED_PERCENTILES)
+                {
+                    ImGui::TableNextColumn();
+                    ImGui::Text("%.3f", histogram.getPercentile(percentile));
+                }
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", histogram.getMax());
+            } };
+
+        histogramRow(u8"", sojournTime ? finalStats.sojournTimeHistogram : finalStats.waitingTimeHistogram);
+        for (int row{}; row < finalStats.sourcesFinalStats.size(); ++row)
+        {
+            const auto& sourceFinalStats{ *finalStats.sourcesFinalStats[row] };
+            char name[16]{};
+            std::snprintf(name, sizeof(name), u8"%d", row);
+            histogramRow(name, sojournTime ? sourceFinalStats.sojournTimeHistogram :
+                sourceFinalStats.waitingTimeHistogram);
+        }
+
+        ImGui::EndTable();
+    }
+}
+
 void QSGui::devicesResultsTable(const std::vector<QS::UDeviceFinalStats>& devicesFinalStats)
 {
     if (ImGui::BeginTable("SourcesFinalStats", 4, tableFlags))
@@ -215,7 +272,7 @@ void QSGui::devicesResultsTable(const std::vector<QS::UDeviceFinalStats>& device
     }
 }
 
-void QSGui::configuration(QS::QueueingSystem& system, QS::SystemConfiguration& conf, QS::SystemStatus& status)
+void QSGui::configuration(QS::SimulationTimeline& timeline, QS::SystemConfiguration& conf, QS::SystemStatus& status)
 {
     ImGui::Begin(u8" ");
 
@@ -225,13 +282,15 @@ void QSGui::configuration(QS::QueueingSystem& system, QS::SystemConfiguration& c
     ImGui::Text(u8" : %d", conf.devicesCount);
     ImGui::Text(u8"  : %.3f", conf.lambda);
     ImGui::Text(u8".  : %d", conf.requestsLimit);
+    if (conf.trace)
+        ImGui::Text(u8"  : %lld", static_cast<long long>(conf.trace->getRecordsCount()));
 
     static bool configCange{ false };
     if (ImGui::Button(u8""))
         configCange = true;
 
     if (configCange)
-        configurationChanges(system, conf, status, configCange);
+        configurationChanges(timeline, conf, status, configCange);
 
     ImGui::SameLine();
 
@@ -240,12 +299,12 @@ void QSGui::configuration(QS::QueueingSystem& system, QS::SystemConfiguration& c
         research = true;
 
     if (research)
-        researchSystem(system, research);
+        researchSystem(timeline.getSystem(), research);
 
     ImGui::End();
 }
 
-void QSGui::configurationChanges(QS::QueueingSystem& system, QS::SystemConfiguration& conf,
+void QSGui::configurationChanges(QS::SimulationTimeline& timeline, QS::SystemConfiguration& conf,
     QS::SystemStatus& status, bool& configChange)
 {
     ImGui::Begin(u8"  ", &configChange);
@@ -268,17 +327,52 @@ void QSGui::configurationChanges(QS::QueueingSystem& system, QS::SystemConfigura
     static int requestsLimit{ conf.requestsLimit };
     ImGui::SliderInt(u8".  ", &requestsLimit, 1, 100000, "%d", sliderFlags);
 
+    static float targetPrecision{ static_cast<float>(conf.targetPrecision) };
+    ImGui::SliderFloat(u8"   (0 -   )", &targetPrecision,
+        0.0, 0.5, "%.3f", sliderFlags);
+
+    static char tracePath[260]{};
+    static std::string traceError{};
+    ImGui::InputText(u8"  (.csv  .qstrace)", tracePath, sizeof(tracePath));
+    if (!traceError.empty())
+        ImGui::Text("%s", traceError.c_str());
+
     if (ImGui::Button(u8""))
     {
+        try
+        {
+            conf.trace = tracePath[0] ? QS::openTrace(tracePath) : nullptr;
+            traceError.clear();
+        }
+        catch (const std::exception& e)
+        {
+            conf.trace = nullptr;
+            traceError = e.what();
+        }
+
+        if (conf.trace)
+            sourcesCount = conf.trace->getSourcesCount();
+
         conf.sourcesCount = sourcesCount;
         conf.distrRange = distrRange;
         conf.bufferSize = bufferSize;
         conf.devicesCount = devicesCount;
         conf.lambda = lambda;
         conf.requestsLimit = requestsLimit;
+        conf.targetPrecision = targetPrecision;
 
-        system.reset(conf);
-        status = system.getSystemStatus();
+        // The trace times are checked as they are read, the first ones here
+        try
+        {
+            timeline.reset(conf);
+        }
+        catch (const std::exception& e)
+        {
+            conf.trace = nullptr;
+            traceError = e.what();
+            timeline.reset(conf);
+        }
+        status = timeline.getSystem().getSystemStatus();
     }
 
     ImGui::SameLine();
@@ -291,6 +385,7 @@ void QSGui::configurationChanges(QS::QueueingSystem& system, QS::SystemConfigura
         devicesCount = conf.devicesCount;
         lambda = conf.lambda;
         requestsLimit = conf.requestsLimit;
+        targetPrecision = static_cast<float>(conf.targetPrecision);
     }
 
     ImGui::End();
@@ -301,31 +396,101 @@ void QSGui::researchSystem(QS::QueueingSystem& system, bool& research)
     ImGui::Begin(u8" ", &research);
 
     static QS::ResearchedConfStats sysConfs{};
+    static QS::ResearchedConfStats paretoConfs{};
     static bool showResearchedResults{};
 
     static QS::GraphicsData varyDevCountGraphics{};
     static QS::GraphicsData varyLambdaGraphics{};
     static QS::GraphicsData varyBufferSizeGraphics{};
 
-    if (!showResearchedResults && ImGui::Button(u8""))
+    static int workersCount{ 1 };
+    static bool useService{};
+    static bool prescreen{ true };
+    static bool surrogate{};
+    static int simulationsBudget{ 300 };
+    static bool storedResults{};
+    static float maxRejectionProbability{ static_cast<float>(QS::REJECT_PROB_CONSTRAINT) };
+    static float minWorkload{ static_cast<float>(QS::WORKLOAD_CONSTRAINT) };
+    static bool minMaxDownsampling{};
+    static bool heatmapStale{ true };
+    static std::string researchError{};
+    if (!showResearchedResults)
     {
-        sysConfs = QS::researchQueueingSystem(10, 5.0);//  (5, 2.5)  (15, 7.5)
-        showResearchedResults = true;
+        ImGui::Checkbox(u8" ", &useService);
+        if (!useService)
+            ImGui::SliderInt(u8" ", &workersCount, 1, 64, "%d", sliderFlags);
+        ImGui::Checkbox(u8" ", &prescreen);
+        ImGui::Checkbox(u8" ", &surrogate);
+        if (surrogate)
+            ImGui::SliderInt(u8" ", &simulationsBudget, 50, 2000, "%d", sliderFlags);
+    }
 
-        const auto& bestConf{ **sysConfs.cbegin() };
-        int fixedBufferSize{ bestConf.conf->bufferSize };
-        int fixedDevicesCount{ bestConf.conf->devicesCount };
-        float fixedLamda{ bestConf.conf->lambda };
+    if (!showResearchedResults && ImGui::Button(u8""))
+    {
+        QS::SweepRunner runner{ QS::runSweep };
+        if (useService)
+            runner = QS::SimulationClient{};
+        else if (workersCount > 1)
+        {
+            QS::DistributedSweepConfiguration distributedConf{};
+            distributedConf.workersCount = workersCount;
+            runner = QS::SweepCoordinator{ distributedConf };
+        }
 
-        varyDevCountGraphics = QS::getGraphicsDataVaryDevicesCount(fixedBufferSize, fixedLamda);
-        varyLambdaGraphics = QS::getGraphicsDataVaryLambda(fixedBufferSize, fixedDevicesCount);
-        varyBufferSizeGraphics = QS::getGraphicsDataVaryBufferSize(fixedDevicesCount, fixedLamda);
+        // The service or a worker can fail mid-sweep, the results are dropped then
+        try
+        {
+            if (surrogate)
+            {
+                QS::SurrogateSearchConfiguration search{};
+                search.simulationsBudget = simulationsBudget;
+                sysConfs = std::move(QS::searchBySurrogate(search).confStats);
+            }
+            else
+                sysConfs = QS::researchQueueingSystem(10, 5.0, runner, prescreen, QS::RESEARCH_STORE_PATH);//  (5, 2.5)  (15, 7.5)
+            storedResults = !surrogate;
+            heatmapStale = true;
+            if (storedResults)
+                paretoConfs = QS::makeParetoConfStats(QS::ResultStore{ QS::RESEARCH_STORE_PATH },
+                    QS::makeConstraintsQuery(maxRejectionProbability, minWorkload));
+            showResearchedResults = true;
+
+            //     ,   
+            if (!sysConfs.empty())
+            {
+                const auto& bestConf{ sysConfs.front() };
+                int fixedBufferSize{ bestConf.conf.bufferSize };
+                int fixedDevicesCount{ bestConf.conf.devicesCount };
+                float fixedLamda{ bestConf.conf.lambda };
+
+                varyDevCountGraphics = QS::getGraphicsDataVaryDevicesCount(fixedBufferSize, fixedLamda, runner);
+                varyLambdaGraphics = QS::getGraphicsDataVaryLambda(fixedBufferSize, fixedDevicesCount, runner);
+                varyBufferSizeGraphics = QS::getGraphicsDataVaryBufferSize(fixedDevicesCount, fixedLamda, runner);
+            }
+            else
+            {
+                varyDevCountGraphics = {};
+                varyLambdaGraphics = {};
+                varyBufferSizeGraphics = {};
+            }
+            researchError.clear();
+        }
+        catch (const std::exception& e)
+        {
+            researchError = e.what();
+            showResearchedResults = false;
+            sysConfs.clear();
+            paretoConfs.clear();
+        }
     }
+    if (!researchError.empty())
+        ImGui::Text("%s", researchError.c_str());
 
     if (showResearchedResults && ImGui::Button(u8""))
     {
         showResearchedResults = false;
         sysConfs.clear();
+        paretoConfs.clear();
 
         varyDevCountGraphics.first.clear();
         varyDevCountGraphics.second.first.clear();
@@ -340,16 +505,62 @@ void QSGui::researchSystem(QS::QueueingSystem& system, bool& research)
         varyBufferSizeGraphics.second.second.clear();
     }
 
+    if (showResearchedResults && storedResults)
+    {
+        ImGui::SliderFloat(u8".  ", &maxRejectionProbability, 0.0f, 1.0f, "%.3f", sliderFlags);
+        ImGui::SliderFloat(u8". ", &minWorkload, 0.0f, 1.0f, "%.3f", sliderFlags);
+
+        //     ,  
+        if (ImGui::Button(u8" "))
+        {
+            QS::ResultStore store{ QS::RESEARCH_STORE_PATH };
+            auto query{ QS::makeConstraintsQuery(maxRejectionProbability, minWorkload) };
+            sysConfs = QS::makeResearchedConfStats(store, query);
+            paretoConfs = QS::makeParetoConfStats(store, query);
+            heatmapStale = true;
+
+            if (!sysConfs.empty())
+            {
+                const auto& bestConf{ sysConfs.front().conf };
+                QS::ColumnRange bufferSize{ QS::ResultColumn::bufferSize, static_cast<double>(bestConf.bufferSize),
+                    static_cast<double>(bestConf.bufferSize) };
+                QS::ColumnRange devicesCount{ QS::ResultColumn::devicesCount, static_cast<double>(bestConf.devicesCount),
+                    static_cast<double>(bestConf.devicesCount) };
+                QS::ColumnRange lambda{ QS::ResultColumn::lambda, bestConf.lambda, bestConf.lambda };
+                //      ,    
+                QS::ColumnRange simulated{ QS::ResultColumn::simulated, 1.0 };
+
+                varyDevCountGraphics = QS::makeGraphicsData(store, QS::ResultColumn::devicesCount,
+                    QS::ResultQuery{ { simulated, bufferSize, lambda } });
+                varyLambdaGraphics = QS::makeGraphicsData(store, QS::ResultColumn::lambda,
+                    QS::ResultQuery{ { simulated, bufferSize, devicesCount } });
+                varyBufferSizeGraphics = QS::makeGraphicsData(store, QS::ResultColumn::bufferSize,
+                    QS::ResultQuery{ { simulated, devicesCount, lambda } });
+            }
+        }
+    }
+
     if (showResearchedResults)
     {
         ImGui::SeparatorText(u8"  10 ");
         bestConfigurationsTable(sysConfs);
 
+        if (!paretoConfs.empty())
+        {
+            ImGui::SeparatorText(u8"-:  , ,  + ");
+            bestConfigurationsTable(paretoConfs);
+        }
+
+        if (storedResults)
+            researchHeatmap(heatmapStale);
+
+        ImGui::SeparatorText(u8" ");
+        ImGui::Checkbox(u8" / ( LTTB)", &minMaxDownsampling);
+
         if (ImPlot::BeginPlot(u8"     ", ImVec2(ImGui::GetContentRegionAvail().x * 0.5f, 0)))
         {
             ImPlot::SetupAxes(u8" ", u8" ");
-            ImPlot::PlotLine("", varyDevCountGraphics.first.data(),
-                varyDevCountGraphics.second.first.data(), varyDevCountGraphics.first.size());
+            downsampledLine("", varyDevCountGraphics.first, varyDevCountGraphics.second.first, minMaxDownsampling);
             ImPlot::EndPlot();
         }
 
@@ -358,16 +569,14 @@ void QSGui::researchSystem(QS::QueueingSystem& system, bool& research)
         if (ImPlot::BeginPlot(u8"     "))
         {
             ImPlot::SetupAxes(u8" ", u8" ");
-            ImPlot::PlotLine("", varyDevCountGraphics.first.data(),
-                varyDevCountGraphics.second.second.data(), varyDevCountGraphics.first.size());
+            downsampledLine("", varyDevCountGraphics.first, varyDevCountGraphics.second.second, minMaxDownsampling);
             ImPlot::EndPlot();
         }
 
         if (ImPlot::BeginPlot(u8"    ", ImVec2(ImGui::GetContentRegionAvail().x * 0.5f, 0)))
         {
             ImPlot::SetupAxes(u8"", u8" ");
-            ImPlot::PlotLine("", varyLambdaGraphics.first.data(),
-                varyLambdaGraphics.second.first.data(), varyLambdaGraphics.first.size());
+            downsampledLine("", varyLambdaGraphics.first, varyLambdaGraphics.second.first, minMaxDownsampling);
             ImPlot::EndPlot();
         }
 
@@ -376,16 +585,14 @@ void QSGui::researchSystem(QS::QueueingSystem& system, bool& research)
         if (ImPlot::BeginPlot(u8"    "))
         {
             ImPlot::SetupAxes(u8"", u8" ");
-            ImPlot::PlotLine("", varyLambdaGraphics.first.data(),
-                varyLambdaGraphics.second.second.data(), varyLambdaGraphics.first.size());
+            downsampledLine("", varyLambdaGraphics.first, varyLambdaGraphics.second.second, minMaxDownsampling);
             ImPlot::EndPlot();
         }
 
         if (ImPlot::BeginPlot(u8"     ", ImVec2(ImGui::GetContentRegionAvail().x * 0.5f, 0)))
         {
             ImPlot::SetupAxes(u8" ", u8" ");
-            ImPlot::PlotLine("", varyBufferSizeGraphics.first.data(),
-                varyBufferSizeGraphics.second.first.data(), varyBufferSizeGraphics.first.size());
+            downsampledLine("", varyBufferSizeGraphics.first, varyBufferSizeGraphics.second.first, minMaxDownsampling);
             ImPlot::EndPlot();
         }
 
@@ -394,8 +601,7 @@ void QSGui::researchSystem(QS::QueueingSystem& system, bool& research)
         if (ImPlot::BeginPlot(u8"     "))
         {
             ImPlot::SetupAxes(u8" ", u8" ");
-            ImPlot::PlotLine("", varyBufferSizeGraphics.first.data(),
-                varyBufferSizeGraphics.second.second.data(), varyBufferSizeGraphics.first.size());
+            downsampledLine("", varyBufferSizeGraphics.first, varyBufferSizeGraphics.second.second, minMaxDownsampling);
             ImPlot::EndPlot();
         }
     }
@@ -403,6 +609,95 @@ void QSGui::researchSystem(QS::QueueingSystem& system, bool& research)
     ImGui::End();
 }
 
+void QSGui::researchHeatmap(bool& stale)
+{
+    ImGui::SeparatorText(u8"   ");
+
+    const char* axes[]{ u8" ", u8" ", u8"" };
+    const char* metrics[]{ u8" ", u8" " };
+    static int xAxis{ 1 };
+    static int yAxis{ 0 };
+    static int sliceIndex{};
+    static int metric{};
+    static QS::Heatmap heatmap{};
+
+    stale |= ImGui::Combo(u8" X", &xAxis, axes, 3);
+    stale |= ImGui::Combo(u8" Y", &yAxis, axes, 3);
+    ImGui::Combo(u8"", &metric, metrics, 2);
+    if (xAxis == yAxis)
+    {
+        ImGui::Text(u8" X  Y  ");
+        return;
+    }
+
+    int sliceAxis{ 3 - xAxis - yAxis };
+    stale |= ImGui::SliderInt(axes[sliceAxis], &sliceIndex, 0, QS::RESEARCH_AXIS_POINTS - 1, "%d", sliderFlags);
+    ImGui::SameLine();
+    ImGui::Text("= %.3f", QS::getResearchAxisValue(static_cast<QS::ResearchAxis>(sliceAxis), sliceIndex));
+
+    if (stale)
+    {
+        heatmap = QS::makeHeatmap(QS::ResultStore{ QS::RESEARCH_STORE_PATH },
+            static_cast<QS::ResearchAxis>(xAxis), static_cast<QS::ResearchAxis>(yAxis), sliceIndex);
+        stale = false;
+    }
+
+    const auto& values{ metric ? heatmap.workload : heatmap.rejectionProbability };
+    ImPlot::PushColormap(ImPlotColormap_Viridis);
+    if (ImPlot::BeginPlot(u8"## ", ImVec2(ImGui::GetContentRegionAvail().x - 100.0f, 400)))
+    {
+        ImPlot::SetupAxes(axes[xAxis], axes[yAxis]);
+        ImPlot::SetupAxisLimits(ImAxis_X1, heatmap.xMin, heatmap.xMax, ImPlotCond_Always);
+        ImPlot::SetupAxisLimits(ImAxis_Y1, heatmap.yMin, heatmap.yMax, ImPlotCond_Always);
+        ImPlot::PlotHeatmap(metrics[metric], values.data(), heatmap.rowsCount, heatmap.columnsCount,
+            0.0, 1.0, nullptr, ImPlotPoint(heatmap.xMin, heatmap.yMin), ImPlotPoint(heatmap.xMax, heatmap.yMax));
+        ImPlot::EndPlot();
+    }
+    ImGui::SameLine();
+    ImPlot::ColormapScale("##", 0.0, 1.0, ImVec2(90, 400));
+    ImPlot::PopColormap();
+
+    if (heatmap.approximatedCount)
+        ImGui::Text(u8"      : %d", heatmap.approximatedCount);
+}
+
+void QSGui::downsampledLine(const char* label, const std::vector<float>& xs, const std::vector<float>& ys,
+    bool minMax)
+{
+    if (xs.empty())
+        return;
+
+    // The visible part with a point past each edge, reduced to about two
+    // points a pixel
+    auto limits{ ImPlot::GetPlotLimits() };
+    auto first{ std::lower_bound(xs.cbegin(), xs.cend(), static_cast<float>(limits.X.Min)) - xs.cbegin() };
+    auto last{ std::upper_bound(xs.cbegin(), xs.cend(), static_cast<float>(limits.X.Max)) - xs.cbegin() };
+    first = std::max<std::ptrdiff_t>(first - 1, 0);
+    last = std::min<std::ptrdiff_t>(last + 1, xs.size());
+    auto pixels{ static_cast<std::size_t>(std::max(ImPlot::GetPlotSize().x, 1.0f)) };
+
+    static std::vector<float> plotXs{};
+    static std::vector<float> plotYs{};
+    if (minMax)
+        QS::downsampleMinMax(xs.data() + first, ys.data() + first, last - first, pixels, plotXs, plotYs);
+    else
+        QS::downsampleLttb(xs.data() + first, ys.data() + first, last - first, 2 * pixels, plotXs, plotYs);
+
+    // The ends of the whole curve lie off screen and keep fitting the axes to all of it
+    if (first > 0)
+    {
+        plotXs.insert(plotXs.begin(), xs.front());
+        plotYs.insert(plotYs.begin(), ys.front());
+    }
+    if (last < static_cast<std::ptrdiff_t>(xs.size()))
+    {
+        plotXs.push_back(xs.back());
+        plotYs.push_back(ys.back());
+    }
+
+    ImPlot::PlotLine(label, plotXs.data(), plotYs.data(), static_cast<int>(plotXs.size()));
+}
+
 void QSGui::bestConfigurationsTable(const QS::ResearchedConfStats& data)
 {
     if (ImGui::BeginTable("BestConfigurations", 8, tableFlags))
@@ -417,7 +712,7 @@ void QSGui::bestConfigurationsTable(const QS::ResearchedConfStats& data)
         ImGui::TableSetupColumn("Workload");
         ImGui::TableHeadersRow();
 
-        static int counter{};
+        int counter{};
         for (const auto& point : data)
         {
             ++counter;
@@ -428,75 +723,128 @@ void QSGui::bestConfigurationsTable(const QS::ResearchedConfStats& data)
             ImGui::Text(u8"%d", counter);
 
             ImGui::TableNextColumn();
-            ImGui::Text("%d", point->conf->sourcesCount);
+            ImGui::Text("%d", point.conf.sourcesCount);
 
             ImGui::TableNextColumn();
-            ImGui::Text("[0.0, %.3f]", point->conf->distrRange);
+            ImGui::Text("[0.0, %.3f]", point.conf.distrRange);
 
             ImGui::TableNextColumn();
-            ImGui::Text("%d", point->conf->bufferSize);
+            ImGui::Text("%d", point.conf.bufferSize);
 
             ImGui::TableNextColumn();
-            ImGui::Text("%d", point->conf->devicesCount);
+            ImGui::Text("%d", point.conf.devicesCount);
 
             ImGui::TableNextColumn();
-            ImGui::Text("%.3f", point->conf->lambda);
+            ImGui::Text("%.3f", point.conf.lambda);
 
             ImGui::TableNextColumn();
-            ImGui::Text("%.3f", point->rejectionProbability);
+            ImGui::Text("%.3f", point.rejectionProbability);
 
             ImGui::TableNextColumn();
-            ImGui::Text("%.3f", point->workload);
-
-            if (counter == 10)
-            {
-                counter = 0;
-                break;
-            }
+            ImGui::Text("%.3f", point.workload);
         }
 
         ImGui::EndTable();
     }
 }
 
-void QSGui::controls(QS::QueueingSystem& system, bool& showResultsWindow, QS::USystemFinalStats& finalStats)
+void QSGui::controls(QS::SimulationTimeline& timeline, const QS::SystemConfiguration& conf,
+    bool& showResultsWindow, QS::USystemFinalStats& finalStats)
 {
     ImGui::Begin(u8"");
 
     //auto sz = ImVec2(-FLT_MIN, 0.0f);
 
-    if (ImGui::Button(u8""))
+    // A trace with decreasing times fails only when the run reaches them
+    static std::string runError{};
+    try
     {
-        if (!showResultsWindow && !system.makeStep())
+        if (ImGui::Button(u8""))
         {
-            finalStats = std::make_unique<QS::SystemFinalStats>(system.getSystemFinalStats());
+            if (!showResultsWindow && !timeline.makeStep())
+            {
+                finalStats = std::make_unique<QS::SystemFinalStats>(timeline.getSystem().getSystemFinalStats());
+                showResultsWindow = true;
+            }
+        }
+        ImGui::SameLine();
+        ImGui::Text(u8"-  ");
+        ImGui::Spacing();
+
+        if (ImGui::Button(u8""))
+        {
+            while (!showResultsWindow && timeline.makeStep());
+            finalStats = std::make_unique<QS::SystemFinalStats>(timeline.getSystem().getSystemFinalStats());
             showResultsWindow = true;
         }
-    }
-    ImGui::SameLine();
-    ImGui::Text(u8"-  ");
-    ImGui::Spacing();
+        ImGui::SameLine();
+        ImGui::Text(u8"-  ");
+        ImGui::Spacing();
+
+        //   ,   
+        if (ImGui::Button(u8""))
+        {
+            auto engine{ QS::makeSimulationEngine(conf) };
+            engine->run();
+            finalStats = std::make_unique<QS::SystemFinalStats>(engine->getSystemFinalStats());
+            showResultsWindow = true;
+        }
+        ImGui::SameLine();
+        ImGui::Text(u8"-   ");
+        ImGui::Spacing();
+
+        if (ImGui::Button(u8""))
+        {
+            timeline.reset();
+            showResultsWindow = false;
+            runError.clear();
+        }
+        ImGui::SameLine();
+        ImGui::Text(u8"-    ");
+        ImGui::Spacing();
 
-    if (ImGui::Button(u8""))
+        timelineControls(timeline);
+    }
+    catch (const std::exception& e)
     {
-        while (!showResultsWindow && system.makeStep());
-        finalStats = std::make_unique<QS::SystemFinalStats>(system.getSystemFinalStats());
-        showResultsWindow = true;
+        runError = e.what();
     }
+    if (!runError.empty())
+        ImGui::Text("%s", runError.c_str());
+
+    ImGui::End();
+}
+
+void QSGui::timelineControls(QS::SimulationTimeline& timeline)
+{
+    ImGui::SeparatorText(u8" ");
+
+    // The slider reaches as far as the run has gone; while it is not over
+    // a little further, so the scrubber can also move ahead
+    long long eventIndex{ timeline.getEventIndex() };
+    long long maxEventIndex{ timeline.isFinished() ? timeline.getEventsCount() :
+        timeline.getEventsCount() + QS::INITIAL_CHECKPOINT_INTERVAL };
+    const long long minEventIndex{ 0 };
+    if (ImGui::SliderScalar(u8"", ImGuiDataType_S64, &eventIndex, &minEventIndex, &maxEventIndex,
+        "%lld", sliderFlags))
+        timeline.seekEvent(eventIndex);
+
+    if (ImGui::Button("<<"))
+        timeline.seekEvent(timeline.getEventIndex() - 1);
     ImGui::SameLine();
-    ImGui::Text(u8"-  ");
-    ImGui::Spacing();
+    if (ImGui::Button(">>"))
+        timeline.seekEvent(timeline.getEventIndex() + 1);
+    ImGui::SameLine();
+    ImGui::Text(u8": %.3f", timeline.getTime());
 
-    if (ImGui::Button(u8""))
-    {
-        system.reset();
-        showResultsWindow = false;
-    }
+    static double time{};
+    ImGui::InputDouble(u8" ", &time, 0.0, 0.0, "%.3f");
     ImGui::SameLine();
-    ImGui::Text(u8"-    ");
-    ImGui::Spacing();
+    if (ImGui::Button(u8""))
+        timeline.seekTime(time);
 
-    ImGui::End();
+    ImGui::Text(u8" : %zu,  %lld ",
+        timeline.getCheckpointsCount(), timeline.getCheckpointInterval());
 }
 
 void QSGui::stepStatistics(const QS::SystemStatus& systemStatus)
@@ -528,6 +876,192 @@ void QSGui::stepStatistics(const QS::SystemStatus& systemStatus)
     ImGui::End();
 }
 
+void QSGui::busyTimeline(const QS::BusyTimeline& timeline, double time)
+{
+    ImGui::Begin(u8" ");
+
+    // Both plots show the same time span
+    static double viewMin{ 0.0 };
+    static double viewMax{ 1.0 };
+    if (ImGui::Button(u8" "))
+    {
+        viewMin = 0.0;
+        viewMax = std::max(timeline.getEndTime(), 1.0);
+    }
+
+    const ImU32 timeColor{ ImGui::GetColorU32(ImVec4(1.0f, 0.2f, 0.2f, 1.0f)) };
+
+    if (ImPlot::BeginPlot(u8"##", ImVec2(-1, ImGui::GetContentRegionAvail().y * 0.65f),
+        ImPlotFlags_NoLegend))
+    {
+        int devicesCount{ timeline.getDevicesCount() };
+        ImPlot::SetupAxes(u8"", u8"", 0, ImPlotAxisFlags_NoGridLines);
+        ImPlot::SetupAxisLinks(ImAxis_X1, &viewMin, &viewMax);
+        ImPlot::SetupAxisLimits(ImAxis_Y1, 0.0, devicesCount);
+
+        auto limits{ ImPlot::GetPlotLimits() };
+        auto plotSize{ ImPlot::GetPlotSize() };
+        double from{ std::max(limits.X.Min, 0.0) };
+        double to{ std::max(limits.X.Max, 0.0) };
+        int level{ timeline.getLevel((limits.X.Max - limits.X.Min) / std::max(plotSize.x, 1.0f)) };
+
+        // Rows thinner than a pixel are merged, a drawn row stands for the
+        // mean of its devices
+        int firstDevice{ std::clamp(static_cast<int>(limits.Y.Min), 0, devicesCount) };
+        int lastDevice{ std::clamp(static_cast<int>(limits.Y.Max) + 1, 0, devicesCount) };
+        int rowSize{ std::max(1, static_cast<int>((limits.Y.Max - limits.Y.Min) / std::max(plotSize.y, 1.0f))) };
+        firstDevice -= firstDevice % rowSize;
+
+        auto drawList{ ImPlot::GetPlotDrawList() };
+        ImPlot::PushPlotClipRect();
+
+        static std::vector<float> rowFractions{};
+        for (int row{ firstDevice }; row < lastDevice; row += rowSize)
+        {
+            int rowEnd{ std::min(row + rowSize, devicesCount) };
+            if (level < 0)
+            {
+                // Deep zoom: the periods themselves, of the first device of the row
+                auto [first, last] { timeline.getBusyPeriods(row, from, to) };
+                for (auto period{ first }; period != last; ++period)
+                    drawList->AddRectFilled(ImPlot::PlotToPixels(period->start, row + 0.1),
+                        ImPlot::PlotToPixels(period->end, rowEnd - 0.1),
+                        ImGui::GetColorU32(ImVec4(0.9f, 0.6f, 0.1f, 1.0f)));
+                continue;
+            }
+
+            double width{ timeline.getBucketWidth(level) };
+            auto lastBucket{ std::min(static_cast<std::size_t>(to / width) + 1,
+                static_cast<std::size_t>(timeline.getBucketsCount(level))) };
+            auto firstBucket{ std::min(static_cast<std::size_t>(from / width), lastBucket) };
+            rowFractions.assign(lastBucket - firstBucket, 0.0f);
+            for (int deviceId{ row }; deviceId < rowEnd; ++deviceId)
+            {
+                const auto& fractions{ timeline.getBusyFractions(level, deviceId) };
+                for (auto bucket{ firstBucket }; bucket < std::min(lastBucket, fractions.size()); ++bucket)
+                    rowFractions[bucket - firstBucket] += fractions[bucket] / (rowEnd - row);
+            }
+
+            for (std::size_t i{ 0 }; i < rowFractions.size(); ++i)
+                if (rowFractions[i] > 0.0f)
+                    drawList->AddRectFilled(ImPlot::PlotToPixels((firstBucket + i) * width, row + 0.1),
+                        ImPlot::PlotToPixels((firstBucket + i + 1) * width, rowEnd - 0.1),
+                        ImGui::GetColorU32(ImVec4(0.9f, 0.6f, 0.1f, std::min(rowFractions[i], 1.0f))));
+        }
+
+        drawList->AddLine(ImPlot::PlotToPixels(time, limits.Y.Min), ImPlot::PlotToPixels(time, limits.Y.Max),
+            timeColor);
+        ImPlot::PopPlotClipRect();
+        ImPlot::EndPlot();
+    }
+
+    if (ImPlot::BeginPlot(u8"##", ImVec2(-1, -1), ImPlotFlags_NoLegend))
+    {
+        ImPlot::SetupAxes(u8"", u8"  ");
+        ImPlot::SetupAxisLinks(ImAxis_X1, &viewMin, &viewMax);
+
+        auto limits{ ImPlot::GetPlotLimits() };
+        double from{ std::max(limits.X.Min, 0.0) };
+        double to{ std::max(limits.X.Max, 0.0) };
+        int level{ timeline.getLevel((limits.X.Max - limits.X.Min) /
+            std::max(ImPlot::GetPlotSize().x, 1.0f)) };
+
+        static std::vector<double> xs{};
+        static std::vector<double> mins{};
+        static std::vector<double> maxs{};
+        xs.clear();
+        mins.clear();
+        maxs.clear();
+
+        if (level < 0)
+        {
+            auto [first, last] { timeline.getOccupancyChanges(from, to) };
+            for (auto change{ first }; change != last; ++change)
+            {
+                xs.push_back(change->time);
+                mins.push_back(change->occupancy);
+            }
+            xs.push_back(std::min(to, timeline.getEndTime()));
+            mins.push_back(mins.back());
+            ImPlot::PlotStairs(u8"  ", xs.data(), mins.data(), static_cast<int>(xs.size()));
+        }
+        else
+        {
+            // Occupancy range of every bucket
+            double width{ timeline.getBucketWidth(level) };
+            const auto& ranges{ timeline.getOccupancyRanges(level) };
+            auto lastBucket{ std::min(static_cast<std::size_t>(to / width) + 1, ranges.size()) };
+            for (auto bucket{ static_cast<std::size_t>(from / width) }; bucket < lastBucket; ++bucket)
+            {
+                xs.push_back((bucket + 0.5) * width);
+                mins.push_back(ranges[bucket].min);
+                maxs.push_back(ranges[bucket].max);
+            }
+            ImPlot::PlotShaded(u8"  ", xs.data(), mins.data(), maxs.data(), static_cast<int>(xs.size()));
+        }
+
+        auto drawList{ ImPlot::GetPlotDrawList() };
+        ImPlot::PushPlotClipRect();
+        drawList->AddLine(ImPlot::PlotToPixels(time, limits.Y.Min), ImPlot::PlotToPixels(time, limits.Y.Max),
+            timeColor);
+        ImPlot::PopPlotClipRect();
+        ImPlot::EndPlot();
+    }
+
+    ImGui::End();
+}
+
+void QSGui::timeWindows(const std::vector<QS::TimeWindow>& windows, int devicesCount)
+{
+    ImGui::Begin(u8"  ");
+
+    // Stairs over the window starts, closed by the end of the last one
+    static std::vector<double> starts{};
+    static std::vector<double> rejectionRates{};
+    static std::vector<double> utilizations{};
+    static std::vector<double> occupancies{};
+    starts.clear();
+    rejectionRates.clear();
+    utilizations.clear();
+    occupancies.clear();
+    for (const auto& window : windows)
+    {
+        starts.push_back(window.start);
+        rejectionRates.push_back(window.getRejectionRate());
+        utilizations.push_back(window.getUtilization(devicesCount));
+        occupancies.push_back(window.getMeanOccupancy());
+    }
+    starts.push_back(windows.back().start + windows.back().duration);
+    rejectionRates.push_back(rejectionRates.back());
+    utilizations.push_back(utilizations.back());
+    occupancies.push_back(occupancies.back());
+    auto count{ static_cast<int>(starts.size()) };
+
+    ImGui::Text(u8": %d", static_cast<int>(windows.size()));
+
+    float plotHeight{ ImGui::GetContentRegionAvail().y / 3.0f - ImGui::GetTextLineHeightWithSpacing() };
+    if (ImPlot::BeginPlot(u8" ", ImVec2(-1, plotHeight), ImPlotFlags_NoLegend))
+    {
+        ImPlot::SetupAxes(u8"", u8" ");
+        ImPlot::PlotStairs(u8" ", starts.data(), rejectionRates.data(), count);
+        ImPlot::EndPlot();
+    }
+    if (ImPlot::BeginPlot(u8" ", ImVec2(-1, plotHeight), ImPlotFlags_NoLegend))
+    {
+        ImPlot::SetupAxes(u8"", u8"");
+        ImPlot::PlotStairs(u8"", starts.data(), utilizations.data(), count);
+        ImPlot::EndPlot();
+    }
+    if (ImPlot::BeginPlot(u8" ", ImVec2(-1, plotHeight), ImPlotFlags_NoLegend))
+    {
+        ImPlot::SetupAxes(u8"", u8"  ");
+        ImPlot::PlotStairs(u8"  ", starts.data(), occupancies.data(), count);
+        ImPlot::EndPlot();
+    }
+
+    ImGui::End();
+}
+
 void QSGui::finalStatistics(const QS::SystemFinalStats& finalStats, bool& showReslutsWindow)
 {
     ImGui::Begin(u8"", &showReslutsWindow);
@@ -551,5 +1085,46 @@ void QSGui::finalStatistics(const QS::SystemFinalStats& finalStats, bool& showRe
         finalStats.workload);
     ImGui::Text(u8"  : %d", finalStats.requiredRequestsCount);
 
+    ImGui::SeparatorText(u8"  (95%  )");
+    const auto& rejection{ finalStats.rejectionEstimate };
+    ImGui::Text(u8" : %.4f  %.4f, : %lld ",
+        rejection.mean, rejection.halfWidth, rejection.warmupCount);
+    const auto& waitingTime{ finalStats.waitingTimeEstimate };
+    ImGui::Text(u8" : %.3f  %.3f, : %lld ",
+        waitingTime.mean, waitingTime.halfWidth, waitingTime.warmupCount);
+
+    if (ImGui::Button(u8"     CSV"))
+    {
+        std::ofstream out{ QS::TIME_WINDOWS_CSV_PATH };
+        QS::writeTimeWindowsCsv(out, finalStats.timeWindows,
+            static_cast<int>(finalStats.deviceFinalStats.size()));
+    }
+    ImGui::SameLine();
+    ImGui::Text("%s", QS::TIME_WINDOWS_CSV_PATH);
+
+    ImGui::SeparatorText(u8" ");
+    static int timeKind{ 1 };
+    const char* timeKinds[]{ u8"  ", u8"  " };
+    ImGui::Combo(u8"", &timeKind, timeKinds, 2);
+    QSGui::percentilesTable(finalStats, timeKind == 1);
+
+    if (ImPlot::BeginPlot(u8"  ", ImVec2(-1, 300)))
+    {
+        ImPlot::SetupAxes(u8"", u8" ");
+        for (int kind{}; kind < 2; ++kind)
+        {
+            const auto& histogram{ kind ? finalStats.sojournTimeHistogram : finalStats.waitingTimeHistogram };
+            std::vector<double> times{};
+            std::vector<double> shares{};
+            for (const auto& [time, share] : histogram.getCdf())
+            {
+                times.push_back(time);
+                shares.push_back(share);
+            }
+            ImPlot::PlotStairs(timeKinds[kind], times.data(), shares.data(), static_cast<int>(times.size()));
+        }
+        ImPlot::EndPlot();
+    }
+
     ImGui::End();
 }
@@ -3,6 +3,7 @@
 
 #include "queueing_system.h"
 #include "queueing_system_research.h"
+#include "simulation_timeline.h"
 
 #include <imgui.h>
 
@@ -24,17 +25,31 @@ namespace QueueingSystemGui
 
     void sourcesResultsTable(const std::vector<QS::USourceFinalStats>& sourcesFinalStats);
     void devicesResultsTable(const std::vector<QS::UDeviceFinalStats>& devicesFinalStats);
+    // Waiting or sojourn time percentiles, system-wide and per source
+    void percentilesTable(const QS::SystemFinalStats& finalStats, bool sojournTime);
 
-    void configuration(QS::QueueingSystem& system, QS::SystemConfiguration& conf,
+    void configuration(QS::SimulationTimeline& timeline, QS::SystemConfiguration& conf,
         QS::SystemStatus& status);
-    void configurationChanges(QS::QueueingSystem& system, QS::SystemConfiguration& conf,
+    void configurationChanges(QS::SimulationTimeline& timeline, QS::SystemConfiguration& conf,
         QS::SystemStatus& status, bool& configChange);
 
     void researchSystem(QS::QueueingSystem& system, bool& research);
     void bestConfigurationsTable(const QS::ResearchedConfStats& data);
-
-    void controls(QS::QueueingSystem& system, bool& showResultsWindow, QS::USystemFinalStats& finalStats);
+    // Slice of the stored research grid, rebuilt when stale
+    void researchHeatmap(bool& stale);
+    // Plots the part of the curve in view of the current plot, downsampled by
+    // LTTB or to the min and max of every pixel column; xs are ordered
+    void downsampledLine(const char* label, const std::vector<float>& xs, const std::vector<float>& ys,
+        bool minMax);
+
+    void controls(QS::SimulationTimeline& timeline, const QS::SystemConfiguration& conf,
+        bool& showResultsWindow, QS::USystemFinalStats& finalStats);
+    void timelineControls(QS::SimulationTimeline& timeline);
     void stepStatistics(const QS::SystemStatus& systemStatus);
+    // Gantt chart of the devices and the buffer occupancy of the run so far
+    void busyTimeline(const QS::BusyTimeline& timeline, double time);
+    // Rejection rate, utilization and buffer occupancy by time windows
+    void timeWindows(const std::vector<QS::TimeWindow>& windows, int devicesCount);
     void finalStatistics(const QS::SystemFinalStats& finalStats, bool& showReslutsWindow);
 
 }
@@ -1,151 +1,625 @@
 #include "queueing_system_research.h"
+#include "basic_queueing_system.h"
+#include "simulation_engine.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <utility>
+#include <limits>
+#include <stdexcept>
 
 namespace QS = QueueingSystem;
 
+namespace
+{
+    constexpr int VARY_DEVICES_COUNT_POINTS{ 1000 };
+    constexpr int VARY_LAMBDA_POINTS{ 1000 };
+    constexpr int VARY_BUFFER_SIZE_POINTS{ 500 };
+
+    // Weight of the axis digit in a research sweep index
+    int getResearchAxisWeight(QS::ResearchAxis axis)
+    {
+        switch (axis)
+        {
+        case QS::ResearchAxis::bufferSize:
+            return QS::RESEARCH_AXIS_POINTS * QS::RESEARCH_AXIS_POINTS;
+        case QS::ResearchAxis::devicesCount:
+            return QS::RESEARCH_AXIS_POINTS;
+        default: //QS::ResearchAxis::lambda
+            return 1;
+        }
+    }
+
+    int getResearchAxisIndex(int sweepIndex, QS::ResearchAxis axis)
+    {
+        return sweepIndex / getResearchAxisWeight(axis) % QS::RESEARCH_AXIS_POINTS;
+    }
+}
+
 bool QS::confSatisfyConstraints(const SystemFinalStats& stats)
 {
-    return stats.rejectionProbability < REJECT_PROB_CONSTRAINT && stats.workload > WORKLOAD_CONSTRAINT;
+    return confSatisfyConstraints(stats.rejectionProbability, stats.workload);
+}
+
+bool QS::confSatisfyConstraints(double rejectionProbability, double workload)
+{
+    return rejectionProbability < REJECT_PROB_CONSTRAINT && workload > WORKLOAD_CONSTRAINT;
 }
 
-bool QS::USysConfStatsCmp(const USysConfStats& left, const USysConfStats& right)
+QS::ScreeningVerdict QS::screenConfiguration(const ApproximateStats& stats, const ScreeningMargins& margins)
 {
-    return (left->workload > right->workload) ||
-        (left->workload == right->workload && left->conf->devicesCount < right->conf->devicesCount) ||
-        (left->workload == right->workload && left->conf->devicesCount == right->conf->devicesCount &&
-         left->conf->bufferSize < right->conf->bufferSize);
+    if (stats.rejectionProbability > REJECT_PROB_CONSTRAINT * (1.0 + margins.rejectionProbability) ||
+        stats.workload < WORKLOAD_CONSTRAINT - margins.workload)
+        return ScreeningVerdict::infeasible;
+
+    return ScreeningVerdict::uncertain;
 }
 
-QS::ResearchedConfStats QS::researchQueueingSystem(int sourcesCount, float distrRange)
+QS::ScreeningVerdict QS::screenConfiguration(const SystemConfiguration& conf, const ScreeningMargins& margins)
 {
-    ResearchedConfStats sysConfigurations{ &USysConfStatsCmp };
+    if (conf.trace)
+        return ScreeningVerdict::uncertain;
+    return screenConfiguration(approximateSystem(conf), margins);
+}
+
+int QS::getSweepPointsCount(SweepKind kind)
+{
+    switch (kind)
+    {
+    case SweepKind::research:
+        return RESEARCH_AXIS_POINTS * RESEARCH_AXIS_POINTS * RESEARCH_AXIS_POINTS;
+    case SweepKind::varyDevicesCount:
+        return VARY_DEVICES_COUNT_POINTS;
+    case SweepKind::varyLambda:
+        return VARY_LAMBDA_POINTS;
+    default: //SweepKind::varyBufferSize
+        return VARY_BUFFER_SIZE_POINTS;
+    }
+}
 
-    auto sysConf{ std::make_unique<SystemConfiguration>() };
-    sysConf->sourcesCount = sourcesCount;
-    sysConf->distrRange = distrRange;
+QS::SystemConfiguration QS::getSweepPointConfiguration(const SweepSpec& spec, int index)
+{
+    auto sysConf{ spec.baseConf };
 
-    auto system{ std::make_unique<QueueingSystem>(*sysConf) };
+    switch (spec.kind)
+    {
+    case SweepKind::research:
+    {
+        int bufferSize{ index / (RESEARCH_AXIS_POINTS * RESEARCH_AXIS_POINTS) + 1 };//1 - 51
+        int devicesCount{ index / RESEARCH_AXIS_POINTS % RESEARCH_AXIS_POINTS + 1 };
+        int lambda{ index % RESEARCH_AXIS_POINTS + 1 };//0 - 51
+
+        sysConf.bufferSize = bufferSize * 10;
+        sysConf.devicesCount = devicesCount * 10;
+        sysConf.lambda = 0.02f + lambda * 0.001f;
+        break;
+    }
+    case SweepKind::varyDevicesCount:
+        sysConf.devicesCount = index + 1;
+        break;
+    case SweepKind::varyLambda:
+        sysConf.lambda = (index + 1) * 0.0001;
+        break;
+    default: //SweepKind::varyBufferSize
+        sysConf.bufferSize = index + 1;
+        break;
+    }
 
-    USystemFinalStats finalStats{};
+    return sysConf;
+}
 
-    for (int bufferSize{ 1 }; bufferSize < 51; ++bufferSize)//1 - 51
+namespace
+{
+    // Points within the constraints into a TopConfigurations or ParetoFrontier
+    template <class Collector>
+    void collectConfigurations(const QS::SweepSpec& spec, const std::vector<QS::SweepPointStats>& points,
+        Collector& collector)
     {
-        for (int devicesCount{ 1 }; devicesCount < 51; ++devicesCount)
+        QS::SystemConfigurationStats stats{};
+        for (const auto& point : points)
         {
-            for (int lambda{ 1 }; lambda < 51; ++lambda)//0 - 51
+            if (point.simulated && QS::confSatisfyConstraints(point.rejectionProbability, point.workload))
             {
-                sysConf->bufferSize = bufferSize * 10;
-                sysConf->devicesCount = devicesCount * 10;
-                sysConf->lambda = 0.02f + lambda * 0.001f;
-                //sysConf->lambda = 0.05f;
-                system->reset(*sysConf);
+                stats.conf = QS::getSweepPointConfiguration(spec, point.index);
+                stats.rejectionProbability = point.rejectionProbability;
+                stats.workload = point.workload;
+                collector.add(stats);
+            }
+        }
+    }
+
+    QS::SystemConfigurationStats getStoredConfigurationStats(const QS::ResultStore& store, std::int64_t row)
+    {
+        QS::SystemConfigurationStats stats{};
+        stats.conf.sourcesCount = static_cast<int>(store.getValue(row, QS::ResultColumn::sourcesCount));
+        stats.conf.distrRange = static_cast<float>(store.getValue(row, QS::ResultColumn::distrRange));
+        stats.conf.bufferSize = static_cast<int>(store.getValue(row, QS::ResultColumn::bufferSize));
+        stats.conf.devicesCount = static_cast<int>(store.getValue(row, QS::ResultColumn::devicesCount));
+        stats.conf.lambda = static_cast<float>(store.getValue(row, QS::ResultColumn::lambda));
+        stats.rejectionProbability = store.getValue(row, QS::ResultColumn::rejectionProbability);
+        stats.workload = store.getValue(row, QS::ResultColumn::workload);
+        return stats;
+    }
+
+    QS::SweepPointStats makeSweepPointStats(int index, const QS::SystemFinalStats& finalStats)
+    {
+        QS::SweepPointStats point{ index, finalStats.rejectionProbability, finalStats.workload };
+        point.requiredRequestsCount = finalStats.requiredRequestsCount;
+
+        int requestsCount{};
+        for (const auto& sourceStats : finalStats.sourcesFinalStats)
+        {
+            // A source that served nothing has no times to average
+            if (std::isnan(sourceStats->averageBufferTime))
+                continue;
+
+            requestsCount += sourceStats->requestsCount;
+            point.averageBufferTime += sourceStats->averageBufferTime * sourceStats->requestsCount;
+            point.averageServiceTime += sourceStats->averageServiceTime * sourceStats->requestsCount;
+        }
+        if (requestsCount)
+        {
+            point.averageBufferTime /= requestsCount;
+            point.averageServiceTime /= requestsCount;
+        }
+
+        if (!finalStats.deviceFinalStats.empty())
+        {
+            auto [minDevice, maxDevice]{ std::minmax_element(finalStats.deviceFinalStats.cbegin(),
+                finalStats.deviceFinalStats.cend(),
+                [](const auto& left, const auto& right)
+                {
+                    return left->utilizationFactor < right->utilizationFactor;
+                }) };
+            point.minUtilization = (*minDevice)->utilizationFactor;
+            point.maxUtilization = (*maxDevice)->utilizationFactor;
+        }
+
+        point.rejectionHalfWidth = finalStats.rejectionEstimate.halfWidth;
+        point.averageWaitingTime = finalStats.waitingTimeEstimate.mean;
+        point.waitingTimeHalfWidth = finalStats.waitingTimeEstimate.halfWidth;
+        return point;
+    }
+
+    // Largest entity counts over the points of the chunk
+    QS::SystemConfiguration getSweepCapacity(const QS::SweepSpec& spec, int begin, int end)
+    {
+        auto capacity{ spec.baseConf };
+        for (int index{ begin }; index < end; ++index)
+        {
+            auto conf{ QS::getSweepPointConfiguration(spec, index) };
+            capacity.sourcesCount = std::max(capacity.sourcesCount, conf.sourcesCount);
+            capacity.bufferSize = std::max(capacity.bufferSize, conf.bufferSize);
+            capacity.devicesCount = std::max(capacity.devicesCount, conf.devicesCount);
+        }
+        return capacity;
+    }
+
+    // Steps instead of run only while observed, the check of the period is
+    // the whole cost between publications
+    template <class System>
+    void runObserved(System& system, QS::TelemetryPublisher& telemetry)
+    {
+        auto& snapshot{ telemetry.getSnapshot() };
+        snapshot.requestsLimit = system.getRequestsLimit();
+
+        long long stepsCount{};
+        while (system.makeStep())
+        {
+            if (++stepsCount % QS::TELEMETRY_PUBLISH_PERIOD)
+                continue;
+
+            snapshot.eventsCount += QS::TELEMETRY_PUBLISH_PERIOD;
+            snapshot.requestsCount = system.getRequestsCount();
+            snapshot.rejectionProbability = snapshot.requestsCount ?
+                static_cast<double>(system.getRejectionsCount()) / snapshot.requestsCount : 0.0;
+            snapshot.workload = system.getWorkload();
+            telemetry.publish();
+        }
+        snapshot.eventsCount += stepsCount % QS::TELEMETRY_PUBLISH_PERIOD;
+    }
 
-                while (system->makeStep());
-                finalStats = std::make_unique<QS::SystemFinalStats>(system->getSystemFinalStats());
+    template <class System>
+    std::vector<QS::SweepPointStats> runSweepChunkOn(const QS::SweepSpec& spec, int begin, int end,
+        QS::TelemetryPublisher* telemetry)
+    {
+        std::vector<QS::SweepPointStats> points{};
+        points.reserve(end - begin);
+
+        auto system{ std::make_unique<System>(spec.baseConf) };
+        system->reserve(getSweepCapacity(spec, begin, end));
 
-                if (confSatisfyConstraints(*finalStats))
+        for (int index{ begin }; index < end; ++index)
+        {
+            auto conf{ QS::getSweepPointConfiguration(spec, index) };
+            if (spec.prescreen)
+            {
+                auto approximation{ QS::approximateSystem(conf) };
+                if (QS::screenConfiguration(approximation, spec.margins) != QS::ScreeningVerdict::uncertain)
                 {
-                    sysConfigurations.insert(std::make_unique<SystemConfigurationStats>(
-                        SystemConfigurationStats
-                        {
-                            std::make_unique<SystemConfiguration>(*sysConf),
-                            finalStats->rejectionProbability,
-                            finalStats->workload
-                        }
-                    ));
+                    points.push_back(QS::SweepPointStats{ index, approximation.rejectionProbability,
+                        approximation.workload, false });
+                    continue;
                 }
             }
+
+            system->reset(conf);
+
+            if (telemetry)
+            {
+                auto& snapshot{ telemetry->getSnapshot() };
+                snapshot.sweepPoint = index;
+                snapshot.sweepBegin = begin;
+                snapshot.sweepEnd = end;
+                runObserved(*system, *telemetry);
+            }
+            else
+                system->run();
+            points.push_back(makeSweepPointStats(index, system->getSystemFinalStats()));
+
+            if (telemetry)
+            {
+                auto& snapshot{ telemetry->getSnapshot() };
+                snapshot.requestsCount = system->getRequestsCount();
+                snapshot.rejectionProbability = points.back().rejectionProbability;
+                snapshot.workload = points.back().workload;
+                telemetry->publish();
+            }
         }
+
+        return points;
     }
+}
 
-    return sysConfigurations;
+std::vector<QS::SweepPointStats> QS::runSweepChunk(const SweepSpec& spec, int begin, int end,
+    TelemetryPublisher* telemetry)
+{
+    // The batch engines draw the arrivals, they cannot replay a trace
+    if (spec.baseConf.trace)
+        throw std::invalid_argument{ "A sweep cannot replay a trace" };
+    if (spec.baseConf.arrivalDistribution || spec.baseConf.serviceDistribution)
+        return runSweepChunkOn<DistributionQueueingSystem>(spec, begin, end, telemetry);
+    return runSweepChunkOn<DefaultQueueingSystem>(spec, begin, end, telemetry);
 }
 
-QS::GraphicsData QS::getGraphicsDataVaryDevicesCount(int bufferSize, float lambda)
+QS::SweepPointStats QS::runConfiguration(const SystemConfiguration& conf)
 {
-    auto sysConf{ std::make_unique<SystemConfiguration>() };
-    sysConf->bufferSize = bufferSize;
-    sysConf->lambda = lambda;
+    if (conf.trace)
+        throw std::invalid_argument{ "A sweep cannot replay a trace" };
+    auto engine{ makeSimulationEngine(conf) };
+    engine->run();
+    return makeSweepPointStats(0, engine->getSystemFinalStats());
+}
 
-    auto system{ std::make_unique<QueueingSystem>(*sysConf) };
+std::vector<QS::SweepPointStats> QS::runSweep(const SweepSpec& spec)
+{
+    TelemetryPublisher telemetry{ 0 };
+    return runSweepChunk(spec, 0, getSweepPointsCount(spec.kind), telemetry.isOpen() ? &telemetry : nullptr);
+}
 
-    USystemFinalStats finalStats{};
+QS::ResearchedConfStats QS::makeResearchedConfStats(const SweepSpec& spec,
+    const std::vector<SweepPointStats>& points)
+{
+    TopConfigurations top{};
+    collectConfigurations(spec, points, top);
+    return top.getSorted();
+}
 
+QS::ResearchedConfStats QS::makeParetoConfStats(const SweepSpec& spec,
+    const std::vector<SweepPointStats>& points)
+{
+    ParetoFrontier frontier{};
+    collectConfigurations(spec, points, frontier);
+    return frontier.getSorted();
+}
+
+QS::GraphicsData QS::makeGraphicsData(const SweepSpec& spec,
+    const std::vector<SweepPointStats>& points)
+{
     std::vector<float> dataX{};
     std::vector<float> dataYRejProb{};
     std::vector<float> dataYWorkload{};
 
-    for (int devicesCount{ 1 }; devicesCount < 1001; ++devicesCount)
+    for (const auto& point : points)
     {
-        sysConf->devicesCount = devicesCount;
-        system->reset(*sysConf);
+        auto sysConf{ getSweepPointConfiguration(spec, point.index) };
 
-        while (system->makeStep());
-        finalStats = std::make_unique<QS::SystemFinalStats>(system->getSystemFinalStats());
+        if (spec.kind == SweepKind::varyDevicesCount)
+            dataX.push_back(sysConf.devicesCount);
+        else if (spec.kind == SweepKind::varyLambda)
+            dataX.push_back(sysConf.lambda);
+        else //SweepKind::varyBufferSize
+            dataX.push_back(sysConf.bufferSize);
 
-        dataX.push_back(sysConf->devicesCount);
-        dataYRejProb.push_back(finalStats->rejectionProbability);
-        dataYWorkload.push_back(finalStats->workload);
+        dataYRejProb.push_back(point.rejectionProbability);
+        dataYWorkload.push_back(point.workload);
     }
 
     return std::make_pair(dataX, std::make_pair(dataYRejProb, dataYWorkload));
 }
 
-QS::GraphicsData QS::getGraphicsDataVaryLambda(int bufferSize, int devicesCount)
+QS::ResultRow QS::makeResultRow(const SweepSpec& spec, const SweepPointStats& point)
+{
+    auto conf{ getSweepPointConfiguration(spec, point.index) };
+
+    ResultRow row{};
+    auto set{ [&row](ResultColumn column, double value)
+        {
+            row[static_cast<int>(column)] = value;
+        } };
+
+    set(ResultColumn::sweepIndex, point.index);
+    set(ResultColumn::sourcesCount, conf.sourcesCount);
+    set(ResultColumn::distrRange, conf.distrRange);
+    set(ResultColumn::bufferSize, conf.bufferSize);
+    set(ResultColumn::devicesCount, conf.devicesCount);
+    set(ResultColumn::lambda, conf.lambda);
+    set(ResultColumn::simulated, point.simulated);
+    set(ResultColumn::rejectionProbability, point.rejectionProbability);
+    set(ResultColumn::workload, point.workload);
+    set(ResultColumn::requiredRequestsCount, point.requiredRequestsCount);
+    set(ResultColumn::averageBufferTime, point.averageBufferTime);
+    set(ResultColumn::averageServiceTime, point.averageServiceTime);
+    set(ResultColumn::minUtilization, point.minUtilization);
+    set(ResultColumn::maxUtilization, point.maxUtilization);
+    set(ResultColumn::rejectionHalfWidth, point.rejectionHalfWidth);
+    set(ResultColumn::averageWaitingTime, point.averageWaitingTime);
+    set(ResultColumn::waitingTimeHalfWidth, point.waitingTimeHalfWidth);
+    return row;
+}
+
+void QS::writeResultStore(const std::filesystem::path& path, const SweepSpec& spec,
+    const std::vector<SweepPointStats>& points)
+{
+    std::vector<ResultRow> rows{};
+    rows.reserve(points.size());
+    for (const auto& point : points)
+        rows.push_back(makeResultRow(spec, point));
+
+    writeResultStore(path, rows);
+}
+
+QS::ResultQuery QS::makeConstraintsQuery(double maxRejectionProbability, double minWorkload,
+    std::size_t limit)
+{
+    // The constraints are strict, the ranges closed. Prescreened points only
+    // have the approximation and are left out.
+    ResultQuery query{};
+    query.filters = {
+        ColumnRange{ ResultColumn::simulated, 1.0 },
+        ColumnRange{ ResultColumn::workload, std::nextafter(minWorkload, 2.0) },
+        ColumnRange{ ResultColumn::rejectionProbability, -1.0, std::nextafter(maxRejectionProbability, -1.0) },
+    };
+    query.orderBy = {
+        ColumnOrder{ ResultColumn::workload, true },
+        ColumnOrder{ ResultColumn::devicesCount },
+        ColumnOrder{ ResultColumn::bufferSize },
+    };
+    query.limit = limit;
+    return query;
+}
+
+QS::ResearchedConfStats QS::makeResearchedConfStats(const ResultStore& store, const ResultQuery& query)
+{
+    ResearchedConfStats sysConfigurations{};
+    for (auto row : store.select(query))
+        sysConfigurations.push_back(getStoredConfigurationStats(store, row));
+
+    return sysConfigurations;
+}
+
+QS::ResearchedConfStats QS::makeParetoConfStats(const ResultStore& store, const ResultQuery& query)
 {
-    auto sysConf{ std::make_unique<SystemConfiguration>() };
-    sysConf->bufferSize = bufferSize;
-    sysConf->devicesCount = devicesCount;
+    auto unlimited{ query };
+    unlimited.orderBy.clear();
+    unlimited.limit = std::numeric_limits<std::size_t>::max();
 
-    auto system{ std::make_unique<QueueingSystem>(*sysConf) };
+    ParetoFrontier frontier{};
+    for (auto row : store.select(unlimited))
+        frontier.add(getStoredConfigurationStats(store, row));
 
-    USystemFinalStats finalStats{};
+    return frontier.getSorted();
+}
+
+QS::GraphicsData QS::makeGraphicsData(const ResultStore& store, ResultColumn x, const ResultQuery& query)
+{
+    auto ordered{ query };
+    ordered.orderBy.insert(ordered.orderBy.begin(), ColumnOrder{ x });
 
     std::vector<float> dataX{};
     std::vector<float> dataYRejProb{};
     std::vector<float> dataYWorkload{};
 
-    for (int lambda{ 1 }; lambda < 1001; ++lambda)
+    for (auto row : store.select(ordered))
+    {
+        dataX.push_back(static_cast<float>(store.getValue(row, x)));
+        dataYRejProb.push_back(static_cast<float>(store.getValue(row, ResultColumn::rejectionProbability)));
+        dataYWorkload.push_back(static_cast<float>(store.getValue(row, ResultColumn::workload)));
+    }
+
+    return std::make_pair(dataX, std::make_pair(dataYRejProb, dataYWorkload));
+}
+
+double QS::getResearchAxisValue(ResearchAxis axis, int index)
+{
+    auto sysConf{ getSweepPointConfiguration(SweepSpec{ SweepKind::research },
+        index * getResearchAxisWeight(axis)) };
+
+    switch (axis)
     {
-        sysConf->lambda = lambda * 0.0001;
-        system->reset(*sysConf);
+    case ResearchAxis::bufferSize:
+        return sysConf.bufferSize;
+    case ResearchAxis::devicesCount:
+        return sysConf.devicesCount;
+    default: //ResearchAxis::lambda
+        return sysConf.lambda;
+    }
+}
 
-        while (system->makeStep());
-        finalStats = std::make_unique<QS::SystemFinalStats>(system->getSystemFinalStats());
+QS::Heatmap QS::makeHeatmap(const ResultStore& store, ResearchAxis x, ResearchAxis y, int sliceIndex, int maxSide)
+{
+    auto slice{ static_cast<ResearchAxis>(3 - static_cast<int>(x) - static_cast<int>(y)) };
+    int blockSize{ (RESEARCH_AXIS_POINTS + maxSide - 1) / maxSide };
+    int side{ (RESEARCH_AXIS_POINTS + blockSize - 1) / blockSize };
+
+    Heatmap heatmap{ side, side };
+    heatmap.rejectionProbability.assign(static_cast<std::size_t>(side) * side, 0.0);
+    heatmap.workload.assign(static_cast<std::size_t>(side) * side, 0.0);
+    std::vector<int> counts(static_cast<std::size_t>(side) * side);
+
+    const double* sweepIndices{ store.getColumn(ResultColumn::sweepIndex) };
+    const double* rejectionProbabilities{ store.getColumn(ResultColumn::rejectionProbability) };
+    const double* workloads{ store.getColumn(ResultColumn::workload) };
+    const double* simulated{ store.getColumn(ResultColumn::simulated) };
+    for (std::int64_t row{ 0 }; row < store.getRowsCount(); ++row)
+    {
+        auto sweepIndex{ static_cast<int>(sweepIndices[row]) };
+        if (getResearchAxisIndex(sweepIndex, slice) != sliceIndex)
+            continue;
+        if (!simulated[row])
+        {
+            ++heatmap.approximatedCount;
+            continue;
+        }
 
-        dataX.push_back(sysConf->lambda);
-        dataYRejProb.push_back(finalStats->rejectionProbability);
-        dataYWorkload.push_back(finalStats->workload);
+        int column{ getResearchAxisIndex(sweepIndex, x) / blockSize };
+        int cellRow{ side - 1 - getResearchAxisIndex(sweepIndex, y) / blockSize };
+        auto cell{ static_cast<std::size_t>(cellRow) * side + column };
+        heatmap.rejectionProbability[cell] += rejectionProbabilities[row];
+        heatmap.workload[cell] += workloads[row];
+        ++counts[cell];
     }
 
-    return std::make_pair(dataX, std::make_pair(dataYRejProb, dataYWorkload));
+    for (std::size_t cell{ 0 }; cell < counts.size(); ++cell)
+        if (counts[cell])
+        {
+            heatmap.rejectionProbability[cell] /= counts[cell];
+            heatmap.workload[cell] /= counts[cell];
+        }
+
+    // Cells are centred on the axis values
+    double xStep{ getResearchAxisValue(x, 1) - getResearchAxisValue(x, 0) };
+    double yStep{ getResearchAxisValue(y, 1) - getResearchAxisValue(y, 0) };
+    heatmap.xMin = getResearchAxisValue(x, 0) - xStep / 2;
+    heatmap.xMax = getResearchAxisValue(x, RESEARCH_AXIS_POINTS - 1) + xStep / 2;
+    heatmap.yMin = getResearchAxisValue(y, 0) - yStep / 2;
+    heatmap.yMax = getResearchAxisValue(y, RESEARCH_AXIS_POINTS - 1) + yStep / 2;
+    return heatmap;
 }
 
-QS::GraphicsData QS::getGraphicsDataVaryBufferSize(int devicesCount, float lambda)
+QS::ResearchedConfStats QS::researchQueueingSystem(int sourcesCount, float distrRange,
+    const SweepRunner& runner, bool prescreen, const std::filesystem::path& storePath)
 {
-    auto sysConf{ std::make_unique<SystemConfiguration>() };
-    sysConf->devicesCount = devicesCount;
-    sysConf->lambda = lambda;
+    SweepSpec spec{ SweepKind::research };
+    spec.prescreen = prescreen;
+    spec.baseConf.sourcesCount = sourcesCount;
+    spec.baseConf.distrRange = distrRange;
+    //spec.baseConf.lambda = 0.05f;
 
-    auto system{ std::make_unique<QueueingSystem>(*sysConf) };
+    auto points{ runner(spec) };
+    if (!storePath.empty())
+        writeResultStore(storePath, spec, points);
 
-    USystemFinalStats finalStats{};
+    return makeResearchedConfStats(spec, points);
+}
 
-    std::vector<float> dataX{};
-    std::vector<float> dataYRejProb{};
-    std::vector<float> dataYWorkload{};
+QS::GraphicsData QS::getGraphicsDataVaryDevicesCount(int bufferSize, float lambda,
+    const SweepRunner& runner)
+{
+    SweepSpec spec{ SweepKind::varyDevicesCount };
+    spec.baseConf.bufferSize = bufferSize;
+    spec.baseConf.lambda = lambda;
+
+    return makeGraphicsData(spec, runner(spec));
+}
+
+QS::GraphicsData QS::getGraphicsDataVaryLambda(int bufferSize, int devicesCount,
+    const SweepRunner& runner)
+{
+    SweepSpec spec{ SweepKind::varyLambda };
+    spec.baseConf.bufferSize = bufferSize;
+    spec.baseConf.devicesCount = devicesCount;
+
+    return makeGraphicsData(spec, runner(spec));
+}
+
+QS::GraphicsData QS::getGraphicsDataVaryBufferSize(int devicesCount, float lambda,
+    const SweepRunner& runner)
+{
+    SweepSpec spec{ SweepKind::varyBufferSize };
+    spec.baseConf.devicesCount = devicesCount;
+    spec.baseConf.lambda = lambda;
 
-    for (int bufferSize{ 1 }; bufferSize < 501; ++bufferSize)
+    return makeGraphicsData(spec, runner(spec));
+}
+
+QS::ApproximationReport QS::compareWithSimulation(const SweepSpec& spec,
+    const std::vector<SweepPointStats>& simulated)
+{
+    ApproximationReport report{};
+
+    for (const auto& point : simulated)
     {
-        sysConf->bufferSize = bufferSize;
-        system->reset(*sysConf);
+        auto approximation{ approximateSystem(getSweepPointConfiguration(spec, point.index)) };
+        auto verdict{ screenConfiguration(approximation, spec.margins) };
+
+        auto& errors{ verdict == ScreeningVerdict::infeasible ? report.infeasible : report.uncertain };
 
-        while (system->makeStep());
-        finalStats = std::make_unique<QS::SystemFinalStats>(system->getSystemFinalStats());
+        double rejectionError{ std::abs(approximation.rejectionProbability - point.rejectionProbability) };
+        double workloadError{ std::abs(approximation.workload - point.workload) };
 
-        dataX.push_back(sysConf->bufferSize);
-        dataYRejProb.push_back(finalStats->rejectionProbability);
-        dataYWorkload.push_back(finalStats->workload);
+        ++errors.pointsCount;
+        errors.rejectionMeanError += rejectionError;
+        errors.rejectionMaxError = std::max(errors.rejectionMaxError, rejectionError);
+        errors.workloadMeanError += workloadError;
+        errors.workloadMaxError = std::max(errors.workloadMaxError, workloadError);
+
+        bool satisfied{ confSatisfyConstraints(point.rejectionProbability, point.workload) };
+        if (verdict == ScreeningVerdict::infeasible && satisfied)
+            ++errors.misclassifiedCount;
     }
 
-    return std::make_pair(dataX, std::make_pair(dataYRejProb, dataYWorkload));
+    for (auto* errors : { &report.infeasible, &report.uncertain })
+    {
+        if (errors->pointsCount)
+        {
+            errors->rejectionMeanError /= errors->pointsCount;
+            errors->workloadMeanError /= errors->pointsCount;
+        }
+    }
+
+    return report;
+}
+
+int QS::runApproximationReport(std::ostream& out, int stride)
+{
+    SweepSpec spec{ SweepKind::research };
+
+    std::vector<SweepPointStats> simulated{};
+    for (int index{ 0 }; index < getSweepPointsCount(spec.kind); index += std::max(stride, 1))
+    {
+        auto point{ runSweepChunk(spec, index, index + 1) };
+        simulated.insert(simulated.end(), point.cbegin(), point.cend());
+    }
+
+    auto report{ compareWithSimulation(spec, simulated) };
+
+    out << std::setw(12) << "verdict" << std::setw(8) << "points" << std::setw(12) << "P_rej mean"
+        << std::setw(12) << "P_rej max" << std::setw(12) << "load mean" << std::setw(12) << "load max"
+        << std::setw(14) << "misclassified" << '\n';
+
+    const std::pair<const char*, const ApproximationErrors*> rows[]{
+        { "infeasible", &report.infeasible },
+        { "uncertain", &report.uncertain },
+    };
+    for (const auto& [name, errors] : rows)
+    {
+        out << std::setw(12) << name << std::setw(8) << errors->pointsCount << std::fixed << std::setprecision(4)
+            << std::setw(12) << errors->rejectionMeanError << std::setw(12) << errors->rejectionMaxError
+            << std::setw(12) << errors->workloadMeanError << std::setw(12) << errors->workloadMaxError
+            << std::setw(14) << errors->misclassifiedCount << std::endl;
+    }
+
+    return 0;
 }
@@ -2,37 +2,188 @@
 #define QUEUEING_SYSTEM_RESEARCH_H
 
 #include "queueing_system.h"
+#include "analytical_approximation.h"
+#include "result_store.h"
+#include "configuration_collectors.h"
+#include "telemetry.h"
 
-#include <set>
 #include <functional>
 #include <vector>
+#include <ostream>
+#include <filesystem>
 
 namespace QueueingSystem
 {
     inline constexpr double REJECT_PROB_CONSTRAINT{ 0.05 };
     inline constexpr double WORKLOAD_CONSTRAINT{ 0.95 };
+    inline constexpr const char* APPROXIMATION_REPORT_FLAG{ "--approximation-report" };
+    inline constexpr const char* RESEARCH_STORE_PATH{ "research.qsresults" };
+    inline constexpr int RESEARCH_AXIS_POINTS{ 50 };
+    // Cells along a side of a heatmap, larger grids are averaged in blocks
+    inline constexpr int HEATMAP_MAX_SIDE{ 256 };
 
-    struct SystemConfigurationStats
+    bool confSatisfyConstraints(const SystemFinalStats& stats);
+    bool confSatisfyConstraints(double rejectionProbability, double workload);
+
+    // Best first
+    using ResearchedConfStats = std::vector<SystemConfigurationStats>;
+    using GraphicsData = std::pair<std::vector<float>, std::pair<std::vector<float>, std::vector<float>>>;
+
+    enum class SweepKind
+    {
+        research,
+        varyDevicesCount,
+        varyLambda,
+        varyBufferSize,
+    };
+
+    // There is no clear feasible verdict: the points that may satisfy the
+    // constraints are the candidates for the best ones and are always simulated
+    enum class ScreeningVerdict
+    {
+        infeasible,
+        uncertain,
+    };
+
+    // A point is clearly infeasible when its approximate rejection probability
+    // is over the constraint by the relative margin or its workload under it
+    // by the absolute one
+    struct ScreeningMargins
     {
-        USystemConfiguration conf{};
+        double rejectionProbability{ 0.5 };
+        double workload{ 0.05 };
+    };
+
+    ScreeningVerdict screenConfiguration(const ApproximateStats& stats, const ScreeningMargins& margins);
+    ScreeningVerdict screenConfiguration(const SystemConfiguration& conf, const ScreeningMargins& margins);
+
+    struct SweepSpec
+    {
+        SweepKind kind{};
+        SystemConfiguration baseConf{};
+        // Clearly infeasible points take the analytical approximation, the rest are simulated
+        bool prescreen{};
+        ScreeningMargins margins{};
+    };
+
+    struct SweepPointStats
+    {
+        int index{};
         double rejectionProbability{};
         double workload{};
+        bool simulated{ true };
+        // Summary of the rest of SystemFinalStats, zero for approximated points
+        int requiredRequestsCount{};
+        double averageBufferTime{};
+        double averageServiceTime{};
+        double minUtilization{};
+        double maxUtilization{};
+        double rejectionHalfWidth{};
+        double averageWaitingTime{};
+        double waitingTimeHalfWidth{};
     };
 
-    inline bool confSatisfyConstraints(const SystemFinalStats& stats);
+    using SweepRunner = std::function<std::vector<SweepPointStats>(const SweepSpec& spec)>;
 
-    using USysConfStats = std::unique_ptr<SystemConfigurationStats>;
+    int getSweepPointsCount(SweepKind kind);
+    SystemConfiguration getSweepPointConfiguration(const SweepSpec& spec, int index);
 
-    inline bool USysConfStatsCmp(const USysConfStats& left, const USysConfStats& right);
+    // A publisher, when given, shows the progress of the chunk to external monitors.
+    // The sweeps and runConfiguration throw std::invalid_argument for a trace
+    std::vector<SweepPointStats> runSweepChunk(const SweepSpec& spec, int begin, int end,
+        TelemetryPublisher* telemetry = nullptr);
+    std::vector<SweepPointStats> runSweep(const SweepSpec& spec);
+    // Summary of a single configuration, as a sweep point with index 0
+    SweepPointStats runConfiguration(const SystemConfiguration& conf);
 
-    using ResearchedConfStats = std::set<USysConfStats, decltype(&USysConfStatsCmp)>;
-    using GraphicsData = std::pair<std::vector<float>, std::pair<std::vector<float>, std::vector<float>>>;
+    // The BEST_CONFIGURATIONS_COUNT best points within the constraints
+    ResearchedConfStats makeResearchedConfStats(const SweepSpec& spec,
+        const std::vector<SweepPointStats>& points);
+    // Frontier of the points within the constraints, cheapest first
+    ResearchedConfStats makeParetoConfStats(const SweepSpec& spec,
+        const std::vector<SweepPointStats>& points);
+    GraphicsData makeGraphicsData(const SweepSpec& spec,
+        const std::vector<SweepPointStats>& points);
+
+    ResultRow makeResultRow(const SweepSpec& spec, const SweepPointStats& point);
+    void writeResultStore(const std::filesystem::path& path, const SweepSpec& spec,
+        const std::vector<SweepPointStats>& points);
+
+    // Simulated points within the constraints, best workload first
+    ResultQuery makeConstraintsQuery(double maxRejectionProbability = REJECT_PROB_CONSTRAINT,
+        double minWorkload = WORKLOAD_CONSTRAINT, std::size_t limit = BEST_CONFIGURATIONS_COUNT);
+
+    ResearchedConfStats makeResearchedConfStats(const ResultStore& store, const ResultQuery& query);
+    ResearchedConfStats makeParetoConfStats(const ResultStore& store, const ResultQuery& query);
+    // Rows of the query ordered by the x column
+    GraphicsData makeGraphicsData(const ResultStore& store, ResultColumn x, const ResultQuery& query);
+
+    // Axes of the research grid, in the order of the sweep index digits
+    enum class ResearchAxis
+    {
+        bufferSize,
+        devicesCount,
+        lambda,
+    };
+
+    double getResearchAxisValue(ResearchAxis axis, int index);
+
+    // Slice of the research grid over two axes at one point of the third.
+    // Rows go from the largest y down, as ImPlot::PlotHeatmap draws them.
+    struct Heatmap
+    {
+        int rowsCount{};
+        int columnsCount{};
+        std::vector<double> rejectionProbability{};
+        std::vector<double> workload{};
+        double xMin{};
+        double xMax{};
+        double yMin{};
+        double yMax{};
+        // Points of the slice left out as they only have the analytical approximation
+        int approximatedCount{};
+    };
+
+    // One pass over the sweep index column of the stored grid
+    Heatmap makeHeatmap(const ResultStore& store, ResearchAxis x, ResearchAxis y, int sliceIndex,
+        int maxSide = HEATMAP_MAX_SIDE);
+
+    // An empty storePath keeps the points in memory only
+    ResearchedConfStats researchQueueingSystem(int sourcesCount, float distrRange,
+        const SweepRunner& runner = runSweep, bool prescreen = false,
+        const std::filesystem::path& storePath = {});
+
+    GraphicsData getGraphicsDataVaryDevicesCount(int bufferSize, float lambda,
+        const SweepRunner& runner = runSweep);
+    GraphicsData getGraphicsDataVaryLambda(int bufferSize, int devicesCount,
+        const SweepRunner& runner = runSweep);
+    GraphicsData getGraphicsDataVaryBufferSize(int devicesCount, float lambda,
+        const SweepRunner& runner = runSweep);
+
+    struct ApproximationErrors
+    {
+        int pointsCount{};
+        double rejectionMeanError{};
+        double rejectionMaxError{};
+        double workloadMeanError{};
+        double workloadMaxError{};
+        // Clear verdicts contradicted by the simulated constraints
+        int misclassifiedCount{};
+    };
+
+    // Errors of the approximation against simulated points of the sweep,
+    // by the verdict the point gets with the margins
+    struct ApproximationReport
+    {
+        ApproximationErrors infeasible{};
+        ApproximationErrors uncertain{};
+    };
 
-    ResearchedConfStats researchQueueingSystem(int sourcesCount, float distrRange);
+    ApproximationReport compareWithSimulation(const SweepSpec& spec,
+        const std::vector<SweepPointStats>& simulated);
 
-    GraphicsData getGraphicsDataVaryDevicesCount(int bufferSize, float lambda);
-    GraphicsData getGraphicsDataVaryLambda(int bufferSize, int devicesCount);
-    GraphicsData getGraphicsDataVaryBufferSize(int devicesCount, float lambda);
+    // Report over every stride-th point of the research sweep
+    int runApproximationReport(std::ostream& out, int stride);
 }
 
 #endif
@@ -0,0 +1,221 @@
+#include "rare_event_splitting.h"
+#include "basic_queueing_system.h"
+
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+#include <cmath>
+#include <limits>
+#include <functional>
+#include <memory>
+#include <iomanip>
+
+namespace QS = QueueingSystem;
+
+namespace
+{
+    constexpr int REPORT_REQUESTS_LIMIT{ 10000 };
+    constexpr int REPORT_BUFFER_SIZES[]{ 12, 16, 20 };
+
+    template <class System>
+    class SplittingTrials
+    {
+    public:
+        SplittingTrials(const QS::SystemConfiguration& conf, const QS::SplittingConfiguration& splitting,
+            long long eventsBudget, std::mt19937& seeder):
+            thresholds_(splitting.thresholds),
+            retrials_(splitting.retrials),
+            requestsLimit_(conf.requestsLimit),
+            eventsBudget_(eventsBudget),
+            seeder_(seeder)
+        {
+            weights_.push_back(1.0);
+            for (int retrials : retrials_)
+                weights_.push_back(weights_.back() / retrials);
+
+            // One system per level holds its retrials in turn, so a split is a
+            // copy into already allocated storage
+            for (std::size_t i{ 0 }; i < retrials_.size(); ++i)
+                retrialSystems_.push_back(std::make_unique<System>(conf));
+        }
+
+        // Runs a trial of the level until the main trial arrivals are over or,
+        // for a retrial, until the occupancy falls below thresholds[level - 1]
+        void run(System& system, int level)
+        {
+            ++trialsCount_;
+            int region{ getRegion(system.getBufferOccupancy()) };
+
+            while (system.getRequestsCount() < requestsLimit_)
+            {
+                long long rejectionsCount{ system.getRejectionsCount() };
+                if (!system.makeStep())
+                    return;
+                if (++eventsCount_ > eventsBudget_)
+                    throw std::runtime_error{ "Splitting exceeded its events budget" };
+
+                int newRegion{ getRegion(system.getBufferOccupancy()) };
+                weightedRejections_ += (system.getRejectionsCount() - rejectionsCount) * weights_[newRegion];
+
+                if (newRegion > region)
+                {
+                    region = newRegion;
+                    auto& retrial{ *retrialSystems_[region - 1] };
+                    for (int i{ 1 }; i < retrials_[region - 1]; ++i)
+                    {
+                        retrial = system;
+                        retrial.reseed(seeder_);
+                        run(retrial, region);
+                    }
+                }
+                else if (newRegion < region)
+                {
+                    region = newRegion;
+                    if (region < level)
+                        return;
+                }
+            }
+        }
+
+        double getWeightedRejections() const
+        {
+            return weightedRejections_;
+        }
+
+        long long getEventsCount() const
+        {
+            return eventsCount_;
+        }
+
+        long long getTrialsCount() const
+        {
+            return trialsCount_;
+        }
+
+    private:
+        // Number of thresholds not above the occupancy
+        int getRegion(int occupancy) const
+        {
+            return static_cast<int>(std::upper_bound(thresholds_.cbegin(), thresholds_.cend(), occupancy) -
+                thresholds_.cbegin());
+        }
+
+        const std::vector<int>& thresholds_;
+        const std::vector<int>& retrials_;
+        std::vector<double> weights_;
+        int requestsLimit_;
+        long long eventsBudget_;
+        std::mt19937& seeder_;
+        std::vector<std::unique_ptr<System>> retrialSystems_;
+
+        double weightedRejections_{};
+        long long eventsCount_{};
+        long long trialsCount_{};
+    };
+
+    template <class System>
+    QS::SplittingResult runSplitting(const QS::SystemConfiguration& conf, const QS::SplittingConfiguration& splitting)
+    {
+        std::mt19937 seeder{ splitting.seed };
+        std::vector<double> estimates{};
+        QS::SplittingResult result{};
+
+        for (int i{ 0 }; i < splitting.replicationsCount; ++i)
+        {
+            System system{ conf };
+            system.reseed(seeder);
+
+            SplittingTrials<System> trials{ conf, splitting, splitting.eventsBudget - result.eventsCount, seeder };
+            trials.run(system, 0);
+
+            estimates.push_back(trials.getWeightedRejections() / conf.requestsLimit);
+            result.eventsCount += trials.getEventsCount();
+            result.trialsCount += trials.getTrialsCount();
+        }
+
+        // Replications are independent, their means give the confidence interval
+        double mean{};
+        for (double estimate : estimates)
+            mean += estimate / estimates.size();
+
+        double variance{};
+        for (double estimate : estimates)
+            variance += estimates.size() > 1 ? (estimate - mean) * (estimate - mean) / (estimates.size() - 1) : 0.0;
+
+        result.rejectionProbability = QS::SteadyStateEstimate{
+            mean,
+            estimates.size() > 1 ? QS::getStudentQuantile(static_cast<int>(estimates.size()) - 1) *
+                std::sqrt(variance / estimates.size()) : std::numeric_limits<double>::infinity(),
+            0,
+            static_cast<int>(estimates.size()),
+            conf.requestsLimit
+        };
+        return result;
+    }
+}
+
+QS::SplittingConfiguration QS::makeSplittingConfiguration(const SystemConfiguration& conf,
+    int levelsCount, int retrials)
+{
+    levelsCount = std::clamp(levelsCount, 1, conf.bufferSize);
+
+    SplittingConfiguration splitting{};
+    for (int level{ 1 }; level <= levelsCount; ++level)
+    {
+        splitting.thresholds.push_back(conf.bufferSize * level / levelsCount);
+        splitting.retrials.push_back(retrials);
+    }
+    return splitting;
+}
+
+QS::SplittingResult QS::estimateRejectionBySplitting(const SystemConfiguration& conf,
+    const SplittingConfiguration& splitting)
+{
+    const auto& thresholds{ splitting.thresholds };
+    if (thresholds.size() != splitting.retrials.size() || thresholds.empty() ||
+        std::adjacent_find(thresholds.cbegin(), thresholds.cend(), std::greater_equal<int>{}) != thresholds.cend() ||
+        thresholds.front() < 1 || thresholds.back() > conf.bufferSize ||
+        *std::min_element(splitting.retrials.cbegin(), splitting.retrials.cend()) < 1 ||
+        splitting.replicationsCount < 1 || splitting.eventsBudget < 1)
+        throw std::invalid_argument{ "Invalid splitting configuration" };
+
+    if (conf.arrivalDistribution || conf.serviceDistribution)
+        return runSplitting<DistributionQueueingSystem>(conf, splitting);
+    return runSplitting<DefaultQueueingSystem>(conf, splitting);
+}
+
+int QS::runSplittingReport(std::ostream& out, int levelsCount)
+{
+    // About 0.88 load, plain runs of this length stop seeing rejections
+    SystemConfiguration conf{};
+    conf.devicesCount = 25;
+    conf.lambda = 2.0f;
+    conf.requestsLimit = REPORT_REQUESTS_LIMIT;
+
+    out << std::setw(8) << "buffer" << std::setw(14) << "simulated" << std::setw(14) << "splitting"
+        << std::setw(14) << "half-width" << std::setw(12) << "trials" << std::setw(14) << "events" << '\n';
+
+    for (int bufferSize : REPORT_BUFFER_SIZES)
+    {
+        conf.bufferSize = bufferSize;
+
+        DefaultQueueingSystem system{ conf };
+        system.run();
+        out << std::setw(8) << bufferSize << std::scientific << std::setprecision(3)
+            << std::setw(14) << system.getSystemFinalStats().rejectionProbability;
+
+        try
+        {
+            auto result{ estimateRejectionBySplitting(conf, makeSplittingConfiguration(conf, levelsCount)) };
+            out << std::setw(14) << result.rejectionProbability.mean << std::setw(14)
+                << result.rejectionProbability.halfWidth << std::setw(12) << result.trialsCount
+                << std::setw(14) << result.eventsCount << std::endl;
+        }
+        catch (const std::runtime_error& e)
+        {
+            out << "  " << e.what() << std::endl;
+        }
+    }
+
+    return 0;
+}
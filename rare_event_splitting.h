@@ -0,0 +1,56 @@
+#ifndef RARE_EVENT_SPLITTING_H
+#define RARE_EVENT_SPLITTING_H
+
+#include "queueing_system.h"
+
+#include <vector>
+#include <cstdint>
+#include <ostream>
+
+namespace QueueingSystem
+{
+    inline constexpr int DEFAULT_SPLITTING_LEVELS{ 6 };
+    inline constexpr int DEFAULT_RETRIALS{ 4 };
+    inline constexpr int DEFAULT_SPLITTING_REPLICATIONS{ 10 };
+    inline constexpr long long DEFAULT_SPLITTING_EVENTS_BUDGET{ 100000000 };
+    inline constexpr const char* SPLITTING_REPORT_FLAG{ "--splitting-report" };
+
+    // RESTART on the buffer occupancy: a trial crossing thresholds[i] upwards
+    // is continued by retrials[i] - 1 extra copies of its state, the copies
+    // die when the occupancy falls back below thresholds[i]. A rejection only
+    // happens on a full buffer and is weighted by 1 / (retrials[0] * ... *
+    // retrials[m - 1]), which keeps the estimate unbiased when the last
+    // threshold does not exceed the buffer size.
+    struct SplittingConfiguration
+    {
+        std::vector<int> thresholds{};
+        std::vector<int> retrials{};
+        int replicationsCount{ DEFAULT_SPLITTING_REPLICATIONS };
+        std::uint32_t seed{};
+        // Events of all the trials of all the replications. Every crossing
+        // multiplies the work, an overloaded system can split without end.
+        long long eventsBudget{ DEFAULT_SPLITTING_EVENTS_BUDGET };
+    };
+
+    struct SplittingResult
+    {
+        // Over the replications, each of conf.requestsLimit main trial arrivals
+        SteadyStateEstimate rejectionProbability{};
+        long long eventsCount{};
+        long long trialsCount{};
+    };
+
+    // Thresholds evenly spread up to the buffer size with the same retrials
+    SplittingConfiguration makeSplittingConfiguration(const SystemConfiguration& conf,
+        int levelsCount = DEFAULT_SPLITTING_LEVELS, int retrials = DEFAULT_RETRIALS);
+
+    // Throws std::runtime_error once the trials exceed splitting.eventsBudget
+    SplittingResult estimateRejectionBySplitting(const SystemConfiguration& conf,
+        const SplittingConfiguration& splitting);
+
+    // Rejection probability of configurations rejecting ever more rarely: plain
+    // simulation against splitting with levelsCount levels
+    int runSplittingReport(std::ostream& out, int levelsCount);
+}
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef REPLICATIONS_H
+#define REPLICATIONS_H
+
+#include "queueing_system.h"
+#include "lockstep_queueing_system.h"
+
+#include <vector>
+#include <ostream>
+#include <cstdint>
+
+namespace QueueingSystem
+{
+    inline constexpr const char* REPLICATIONS_BENCHMARK_FLAG{ "--benchmark-replications" };
+    inline constexpr int REPLICATION_LANES_COUNT{ 8 };
+    inline constexpr int DEFAULT_REPLICATIONS_COUNT{ 32 };
+
+    struct ReplicationsConfiguration
+    {
+        int replicationsCount{ DEFAULT_REPLICATIONS_COUNT };
+        std::uint32_t seed{};
+        // Replications of the default model run REPLICATION_LANES_COUNT at a
+        // time in a LockstepQueueingSystem, otherwise one after another
+        bool lockstep{ true };
+    };
+
+    struct ReplicationsResult
+    {
+        // Means over the replications with the Student 95% half-width
+        SteadyStateEstimate rejectionProbability{};
+        SteadyStateEstimate workload{};
+        std::vector<ReplicationStats> replications{};
+        // Merged over the replications
+        LatencyHistogram waitingTimeHistogram{};
+        LatencyHistogram sojournTimeHistogram{};
+    };
+
+    // Independent runs of conf.requestsLimit arrivals each; targetPrecision is
+    // not applied, every replication has the same length. For the same seed
+    // both modes simulate the same event sequences; the statistics are equal
+    // up to the summation order, so the workload may differ in the last bits.
+    ReplicationsResult runReplications(const SystemConfiguration& conf,
+        const ReplicationsConfiguration& replications);
+
+    int runReplicationsBenchmark(std::ostream& out, int replicationsCount);
+}
+
+#endif
@@ -0,0 +1,180 @@
+#include "result_store.h"
+
+#include <fstream>
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <cstring>
+#include <cmath>
+#include <string>
+#include <utility>
+
+namespace QS = QueueingSystem;
+namespace fs = std::filesystem;
+
+namespace
+{
+    std::size_t getColumnOffset(std::uint64_t rowsCount, QS::ResultColumn column)
+    {
+        return sizeof(QS::ResultStoreHeader) + static_cast<std::size_t>(column) * rowsCount * sizeof(double);
+    }
+}
+
+void QS::writeResultStore(const fs::path& path, const std::vector<ResultRow>& rows)
+{
+    ResultStoreHeader header{};
+    std::memcpy(header.magic, RESULT_STORE_MAGIC, sizeof(RESULT_STORE_MAGIC));
+    header.columnsCount = RESULT_COLUMNS_COUNT;
+    header.rowsCount = rows.size();
+
+    // NaN is neither less nor greater than anything, which breaks the strict
+    // weak ordering the sorts of select rely on
+    for (std::size_t row{}; row < rows.size(); ++row)
+    {
+        if (std::any_of(rows[row].cbegin(), rows[row].cend(), [](double value) { return std::isnan(value); }))
+            throw std::invalid_argument{ "NaN in row " + std::to_string(row) + " of " + path.string() };
+    }
+
+    {
+        std::ofstream out{ path, std::ios::binary | std::ios::trunc };
+        if (!out)
+            throw std::runtime_error{ "Cannot create " + path.string() };
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    }
+    fs::resize_file(path, getColumnOffset(header.rowsCount, ResultColumn::count));
+
+    if (rows.empty())
+        return;
+
+    MappedFile file{ path, MappingMode::readWrite };
+    auto columns{ reinterpret_cast<double*>(file.getData() + sizeof(ResultStoreHeader)) };
+
+    for (int column{}; column < RESULT_COLUMNS_COUNT; ++column)
+    {
+        auto values{ columns + column * rows.size() };
+        for (std::size_t row{}; row < rows.size(); ++row)
+            values[row] = rows[row][column];
+    }
+}
+
+QS::ResultStore::ResultStore(const fs::path& path):
+    file_(path)
+{
+    if (file_.getSize() < sizeof(ResultStoreHeader))
+        throw std::runtime_error{ "Invalid result store " + path.string() };
+
+    header_ = reinterpret_cast<const ResultStoreHeader*>(file_.getData());
+    columns_ = reinterpret_cast<const double*>(header_ + 1);
+
+    if (std::memcmp(header_->magic, RESULT_STORE_MAGIC, sizeof(RESULT_STORE_MAGIC)) ||
+        header_->columnsCount != RESULT_COLUMNS_COUNT ||
+        file_.getSize() != getColumnOffset(header_->rowsCount, ResultColumn::count))
+        throw std::runtime_error{ "Invalid result store " + path.string() };
+}
+
+std::int64_t QS::ResultStore::getRowsCount() const
+{
+    return static_cast<std::int64_t>(header_->rowsCount);
+}
+
+const double* QS::ResultStore::getColumn(ResultColumn column) const
+{
+    return columns_ + static_cast<std::size_t>(column) * header_->rowsCount;
+}
+
+double QS::ResultStore::getValue(std::int64_t row, ResultColumn column) const
+{
+    return getColumn(column)[row];
+}
+
+QS::ResultRow QS::ResultStore::getRow(std::int64_t row) const
+{
+    ResultRow values{};
+    for (int column{}; column < RESULT_COLUMNS_COUNT; ++column)
+        values[column] = getValue(row, static_cast<ResultColumn>(column));
+    return values;
+}
+
+std::vector<std::int64_t> QS::ResultStore::select(const ResultQuery& query) const
+{
+    std::int64_t rowsCount{ getRowsCount() };
+    std::vector<std::int64_t> rows(rowsCount);
+    std::int64_t selectedCount{};
+
+    // Branch-free compaction: every row is written, only the passing ones
+    // advance the end of the selection. The first filter scans its whole
+    // column, the rest test only the rows still selected.
+    if (query.filters.empty())
+    {
+        std::iota(rows.begin(), rows.end(), 0);
+        selectedCount = rowsCount;
+    }
+    else
+    {
+        const auto& first{ query.filters.front() };
+        auto values{ getColumn(first.column) };
+        for (std::int64_t row{}; row < rowsCount; ++row)
+        {
+            rows[selectedCount] = row;
+            selectedCount += (values[row] >= first.min) & (values[row] <= first.max);
+        }
+
+        for (std::size_t i{ 1 }; i < query.filters.size(); ++i)
+        {
+            const auto& filter{ query.filters[i] };
+            values = getColumn(filter.column);
+
+            std::int64_t keptCount{};
+            for (std::int64_t j{}; j < selectedCount; ++j)
+            {
+                auto row{ rows[j] };
+                rows[keptCount] = row;
+                keptCount += (values[row] >= filter.min) & (values[row] <= filter.max);
+            }
+            selectedCount = keptCount;
+        }
+    }
+    rows.resize(selectedCount);
+
+    std::size_t limit{ std::min(query.limit, rows.size()) };
+    if (query.orderBy.empty())
+    {
+        rows.resize(limit);
+        return rows;
+    }
+
+    // The first key is gathered next to the row, so ranking reads contiguous
+    // memory; the other keys are looked up on ties only
+    const auto& primary{ query.orderBy.front() };
+    auto primaryValues{ getColumn(primary.column) };
+
+    std::vector<std::pair<double, std::int64_t>> keys(rows.size());
+    for (std::size_t i{}; i < rows.size(); ++i)
+        keys[i] = { primary.descending ? -primaryValues[rows[i]] : primaryValues[rows[i]], rows[i] };
+
+    auto isEarlier{ [this, &query](const auto& left, const auto& right)
+        {
+            if (left.first != right.first)
+                return left.first < right.first;
+
+            for (std::size_t i{ 1 }; i < query.orderBy.size(); ++i)
+            {
+                const auto& order{ query.orderBy[i] };
+                auto values{ getColumn(order.column) };
+                if (values[left.second] != values[right.second])
+                    return order.descending ? values[left.second] > values[right.second] :
+                        values[left.second] < values[right.second];
+            }
+            return left.second < right.second;
+        } };
+
+    if (limit < keys.size())
+        std::partial_sort(keys.begin(), keys.begin() + limit, keys.end(), isEarlier);
+    else
+        std::sort(keys.begin(), keys.end(), isEarlier);
+
+    rows.resize(limit);
+    for (std::size_t i{}; i < limit; ++i)
+        rows[i] = keys[i].second;
+    return rows;
+}
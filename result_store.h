@@ -0,0 +1,100 @@
+#ifndef RESULT_STORE_H
+#define RESULT_STORE_H
+
+#include "mapped_file.h"
+
+#include <filesystem>
+#include <array>
+#include <vector>
+#include <limits>
+#include <cstdint>
+
+namespace QueueingSystem
+{
+    inline constexpr char RESULT_STORE_MAGIC[8]{ 'Q', 'S', 'R', 'E', 'S', 'U', 'L', 'T' };
+
+    enum class ResultColumn
+    {
+        sweepIndex,
+        sourcesCount,
+        distrRange,
+        bufferSize,
+        devicesCount,
+        lambda,
+        // 0 for points taken from the analytical approximation
+        simulated,
+        rejectionProbability,
+        workload,
+        requiredRequestsCount,
+        averageBufferTime,
+        averageServiceTime,
+        minUtilization,
+        maxUtilization,
+        rejectionHalfWidth,
+        averageWaitingTime,
+        waitingTimeHalfWidth,
+        count,
+    };
+
+    inline constexpr int RESULT_COLUMNS_COUNT{ static_cast<int>(ResultColumn::count) };
+
+    using ResultRow = std::array<double, RESULT_COLUMNS_COUNT>;
+
+    // Binary layout: ResultStoreHeader, then RESULT_COLUMNS_COUNT columns of
+    // rowsCount doubles each, so a filter reads only the columns it tests.
+    struct ResultStoreHeader
+    {
+        char magic[8];
+        std::uint32_t columnsCount;
+        std::uint32_t reserved;
+        std::uint64_t rowsCount;
+    };
+
+    // Rows holding NaN are rejected, select cannot order them
+    void writeResultStore(const std::filesystem::path& path, const std::vector<ResultRow>& rows);
+
+    // Closed range, equal bounds select one value
+    struct ColumnRange
+    {
+        ResultColumn column{};
+        double min{ -std::numeric_limits<double>::infinity() };
+        double max{ std::numeric_limits<double>::infinity() };
+    };
+
+    struct ColumnOrder
+    {
+        ResultColumn column{};
+        bool descending{};
+    };
+
+    struct ResultQuery
+    {
+        std::vector<ColumnRange> filters{};
+        // Lexicographic, rows keep the stored order on full ties
+        std::vector<ColumnOrder> orderBy{};
+        std::size_t limit{ std::numeric_limits<std::size_t>::max() };
+    };
+
+    class ResultStore
+    {
+    public:
+        explicit ResultStore(const std::filesystem::path& path);
+
+        std::int64_t getRowsCount() const;
+        const double* getColumn(ResultColumn column) const;
+        double getValue(std::int64_t row, ResultColumn column) const;
+        ResultRow getRow(std::int64_t row) const;
+
+        // Rows passing every filter, ranked and cut to the limit. Filters
+        // narrow a selection vector one column at a time; only the selected
+        // rows are ranked, by partial sort when the limit is short.
+        std::vector<std::int64_t> select(const ResultQuery& query) const;
+
+    private:
+        MappedFile file_;
+        const ResultStoreHeader* header_{};
+        const double* columns_{};
+    };
+}
+
+#endif
@@ -0,0 +1,12 @@
+#include "simulation_engine.h"
+
+namespace QS = QueueingSystem;
+
+QS::USimulationEngine QS::makeSimulationEngine(const SystemConfiguration& conf)
+{
+    if (conf.trace)
+        return std::make_unique<SimulationEngineModel<QueueingSystem>>(conf);
+    if (conf.arrivalDistribution || conf.serviceDistribution)
+        return std::make_unique<SimulationEngineModel<DistributionQueueingSystem>>(conf);
+    return std::make_unique<SimulationEngineModel<DefaultQueueingSystem>>(conf);
+}
@@ -0,0 +1,88 @@
+#ifndef SIMULATION_ENGINE_H
+#define SIMULATION_ENGINE_H
+
+#include "queueing_system.h"
+#include "basic_queueing_system.h"
+
+#include <memory>
+
+namespace QueueingSystem
+{
+    // One run of a configuration behind a common interface, so a caller that
+    // only needs the final stats gets the specialized event loop
+    class SimulationEngine
+    {
+    public:
+        virtual ~SimulationEngine() = default;
+
+        virtual SystemFinalStats getSystemFinalStats() const = 0;
+        virtual int getRequestsLimit() const = 0;
+
+        virtual void reset() = 0;
+        virtual void reset(const SystemConfiguration& conf) = 0;
+        virtual void reserve(const SystemConfiguration& conf) = 0;
+
+        virtual bool makeStep() = 0;
+        virtual void run() = 0;
+    };
+
+    template <class System>
+    class SimulationEngineModel final : public SimulationEngine
+    {
+    public:
+        explicit SimulationEngineModel(const SystemConfiguration& conf):
+            system_(conf)
+        {}
+
+        SystemFinalStats getSystemFinalStats() const override
+        {
+            return system_.getSystemFinalStats();
+        }
+
+        int getRequestsLimit() const override
+        {
+            return system_.getRequestsLimit();
+        }
+
+        void reset() override
+        {
+            system_.reset();
+        }
+
+        void reset(const SystemConfiguration& conf) override
+        {
+            system_.reset(conf);
+        }
+
+        void reserve(const SystemConfiguration& conf) override
+        {
+            system_.reserve(conf);
+        }
+
+        bool makeStep() override
+        {
+            return system_.makeStep();
+        }
+
+        void run() override
+        {
+            while (system_.makeStep());
+        }
+
+        System& getSystem()
+        {
+            return system_;
+        }
+
+    private:
+        System system_;
+    };
+
+    using USimulationEngine = std::unique_ptr<SimulationEngine>;
+
+    // The specialized BasicQueueingSystem for conf, QueueingSystem for a trace,
+    // which the batch engines cannot replay
+    USimulationEngine makeSimulationEngine(const SystemConfiguration& conf);
+}
+
+#endif
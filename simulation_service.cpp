@@ -0,0 +1,898 @@
+#include "simulation_service.h"
+#include "distributed_sweep.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <list>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <winsock2.h>
+#include <afunix.h>
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace QS = QueueingSystem;
+namespace fs = std::filesystem;
+
+namespace
+{
+    using Socket = std::intptr_t;
+    constexpr Socket NO_SOCKET{ -1 };
+    constexpr int LISTEN_BACKLOG{ 16 };
+    constexpr int RECEIVE_BUFFER_SIZE{ 4096 };
+    constexpr int JOB_LINES_COUNT{ 4 };
+
+#ifdef _WIN32
+
+    bool startSockets()
+    {
+        static const bool started{ []
+            {
+                WSADATA data{};
+                return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+            }() };
+        return started;
+    }
+
+    void closeSocket(Socket socket)
+    {
+        closesocket(static_cast<SOCKET>(socket));
+    }
+
+    void interruptSocket(Socket socket)
+    {
+        shutdown(static_cast<SOCKET>(socket), SD_BOTH);
+    }
+
+    constexpr int SEND_FLAGS{};
+
+#else
+
+    bool startSockets()
+    {
+        return true;
+    }
+
+    void closeSocket(Socket socket)
+    {
+        close(static_cast<int>(socket));
+    }
+
+    void interruptSocket(Socket socket)
+    {
+        shutdown(static_cast<int>(socket), SHUT_RDWR);
+    }
+
+    // A client gone in the middle of a reply must not kill the service with SIGPIPE
+#ifdef MSG_NOSIGNAL
+    constexpr int SEND_FLAGS{ MSG_NOSIGNAL };
+#else
+    constexpr int SEND_FLAGS{};
+#endif
+
+#endif
+
+    bool makeAddress(const fs::path& path, sockaddr_un& address)
+    {
+        auto name{ path.string() };
+        if (name.size() >= sizeof(address.sun_path))
+            return false;
+
+        address = sockaddr_un{};
+        address.sun_family = AF_UNIX;
+        std::copy(name.cbegin(), name.cend(), address.sun_path);
+        return true;
+    }
+
+    Socket connectTo(const fs::path& path)
+    {
+        sockaddr_un address{};
+        if (!startSockets() || !makeAddress(path, address))
+            return NO_SOCKET;
+
+        auto client{ static_cast<Socket>(socket(AF_UNIX, SOCK_STREAM, 0)) };
+        if (client == NO_SOCKET)
+            return NO_SOCKET;
+
+        if (connect(client, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+        {
+            closeSocket(client);
+            return NO_SOCKET;
+        }
+        return client;
+    }
+
+    // A socket file nobody answers on is left by a service that died and is
+    // replaced; a live service keeps its socket
+    Socket listenOn(const fs::path& path)
+    {
+        sockaddr_un address{};
+        if (!startSockets() || !makeAddress(path, address))
+            return NO_SOCKET;
+
+        std::error_code ec{};
+        if (fs::exists(path, ec))
+        {
+            auto other{ connectTo(path) };
+            if (other != NO_SOCKET)
+            {
+                closeSocket(other);
+                return NO_SOCKET;
+            }
+            fs::remove(path, ec);
+        }
+
+        auto server{ static_cast<Socket>(socket(AF_UNIX, SOCK_STREAM, 0)) };
+        if (server == NO_SOCKET)
+            return NO_SOCKET;
+
+        if (bind(server, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0 ||
+            listen(server, LISTEN_BACKLOG) != 0)
+        {
+            closeSocket(server);
+            return NO_SOCKET;
+        }
+        return server;
+    }
+
+    bool sendAll(Socket socket, const std::string& message)
+    {
+        std::size_t sent{};
+        while (sent < message.size())
+        {
+            auto count{ send(socket, message.data() + sent, static_cast<int>(message.size() - sent), SEND_FLAGS) };
+            if (count <= 0)
+                return false;
+            sent += static_cast<std::size_t>(count);
+        }
+        return true;
+    }
+
+    class LineReader
+    {
+    public:
+        explicit LineReader(Socket socket):
+            socket_(socket)
+        {}
+
+        // False once the peer is gone, a partial last line is dropped
+        bool readLine(std::string& line)
+        {
+            while (true)
+            {
+                auto end{ buffer_.find('\n', scanned_) };
+                if (end != std::string::npos)
+                {
+                    line.assign(buffer_, 0, end);
+                    buffer_.erase(0, end + 1);
+                    scanned_ = 0;
+                    return true;
+                }
+                scanned_ = buffer_.size();
+
+                char chunk[RECEIVE_BUFFER_SIZE];
+                auto count{ recv(socket_, chunk, RECEIVE_BUFFER_SIZE, 0) };
+                if (count <= 0)
+                    return false;
+                buffer_.append(chunk, static_cast<std::size_t>(count));
+            }
+        }
+
+        bool readLines(std::string& text, int linesCount)
+        {
+            std::string line{};
+            for (int i{}; i < linesCount; ++i)
+            {
+                if (!readLine(line))
+                    return false;
+                text += line;
+                text += '\n';
+            }
+            return true;
+        }
+
+    private:
+        Socket socket_;
+        std::string buffer_;
+        std::size_t scanned_{};
+    };
+
+    std::string makeJobText(const QS::SweepSpec& spec, int begin, int end)
+    {
+        std::ostringstream out{};
+        QS::writeSweepJob(out, spec, begin, end);
+        return out.str();
+    }
+
+    std::string makePointText(const QS::SweepPointStats& point)
+    {
+        std::ostringstream out{};
+        out.precision(std::numeric_limits<double>::max_digits10);
+        QS::writeSweepPoint(out, point);
+        return out.str();
+    }
+
+    // Replies are queued and written by the connection's own thread, so the
+    // workers never block on a client while holding a job or the service
+    // lock. A client that lets SERVICE_OUTGOING_CAPACITY bytes pile up is
+    // dropped.
+    struct Connection
+    {
+        explicit Connection(Socket socket):
+            socket(socket),
+            writer([this] { write(); })
+        {}
+
+        ~Connection()
+        {
+            close();
+        }
+
+        Connection(const Connection&) = delete;
+        Connection& operator=(const Connection&) = delete;
+
+        bool send(std::string message)
+        {
+            bool queued{};
+            {
+                std::lock_guard lock{ mutex };
+                if (stopped)
+                    return false;
+                queued = outgoingSize + message.size() <= QS::SERVICE_OUTGOING_CAPACITY;
+                if (queued)
+                {
+                    outgoingSize += message.size();
+                    outgoing.push_back(std::move(message));
+                }
+                else
+                    stop();
+            }
+            outgoingReady.notify_one();
+            return queued;
+        }
+
+        // A closed socket is never touched again, as its descriptor may
+        // already be reused
+        void close()
+        {
+            {
+                std::lock_guard lock{ mutex };
+                if (closed)
+                    return;
+                closed = true;
+                stop();
+            }
+            outgoingReady.notify_one();
+            writer.join();
+            closeSocket(socket);
+        }
+
+        void interrupt()
+        {
+            std::lock_guard lock{ mutex };
+            if (!closed)
+                interruptSocket(socket);
+        }
+
+        Socket socket;
+        std::mutex mutex;
+        std::condition_variable outgoingReady;
+        std::deque<std::string> outgoing;
+        std::size_t outgoingSize{};
+        bool stopped{};
+        bool closed{};
+        std::atomic<bool> finished{};
+        std::thread writer;
+
+    private:
+        // Called under the mutex, wakes the reader so the session ends
+        void stop()
+        {
+            if (!stopped)
+                interruptSocket(socket);
+            stopped = true;
+        }
+
+        void write()
+        {
+            std::unique_lock lock{ mutex };
+            while (true)
+            {
+                outgoingReady.wait(lock, [this] { return stopped || !outgoing.empty(); });
+                if (stopped)
+                    return;
+
+                auto message{ std::move(outgoing.front()) };
+                outgoing.pop_front();
+                outgoingSize -= message.size();
+
+                lock.unlock();
+                bool sent{ sendAll(socket, message) };
+                lock.lock();
+                if (!sent)
+                    stop();
+            }
+        }
+    };
+
+    struct Subscriber
+    {
+        std::shared_ptr<Connection> connection;
+        long long jobId{};
+    };
+
+    enum class JobType
+    {
+        sweep,
+        configuration,
+    };
+
+    // One per distinct request text, shared by all the clients asking for it
+    struct Job
+    {
+        std::string key;
+        JobType type{};
+        QS::SweepSpec spec{};
+
+        std::mutex mutex;
+        std::vector<QS::SweepPointStats> points;
+        std::vector<Subscriber> subscribers;
+        int pendingTasksCount{};
+        bool failed{};
+        // Every subscriber left before the end, the tasks left are skipped
+        bool cancelled{};
+    };
+
+    struct Task
+    {
+        std::shared_ptr<Job> job;
+        int begin{};
+        int end{};
+    };
+
+    void sendPoints(const Subscriber& subscriber, const std::vector<std::string>& pointsText)
+    {
+        auto prefix{ "point " + std::to_string(subscriber.jobId) + ' ' };
+        for (const auto& text : pointsText)
+            subscriber.connection->send(prefix + text);
+    }
+
+    void sendEnd(const Subscriber& subscriber, bool failed)
+    {
+        subscriber.connection->send((failed ? "error " : "done ") + std::to_string(subscriber.jobId) + '\n');
+    }
+
+    std::vector<std::string> makePointsText(const std::vector<QS::SweepPointStats>& points)
+    {
+        std::vector<std::string> pointsText{};
+        pointsText.reserve(points.size());
+        for (const auto& point : points)
+            pointsText.push_back(makePointText(point));
+        return pointsText;
+    }
+
+    bool isValidJob(JobType type, const QS::SweepSpec& spec, int begin, int end)
+    {
+        const auto& conf{ spec.baseConf };
+        if (conf.sourcesCount <= 0 || conf.devicesCount <= 0 || conf.bufferSize <= 0 || conf.requestsLimit <= 0)
+            return false;
+        if (type == JobType::configuration)
+            return true;
+
+        int kind{ static_cast<int>(spec.kind) };
+        return kind >= static_cast<int>(QS::SweepKind::research) &&
+            kind <= static_cast<int>(QS::SweepKind::varyBufferSize) &&
+            begin >= 0 && begin < end && end <= QS::getSweepPointsCount(spec.kind);
+    }
+
+    // Streams the points of a sweep over a connected client socket and closes it
+    std::vector<QS::SweepPointStats> receiveSweep(Socket client, const QS::SweepSpec& spec,
+        const QS::SweepPointCallback& onPoint)
+    {
+        std::vector<QS::SweepPointStats> points{};
+        bool done{};
+        if (sendAll(client, "sweep 0\n" + makeJobText(spec, 0, QS::getSweepPointsCount(spec.kind))))
+        {
+            LineReader reader{ client };
+            std::string line{};
+            while (reader.readLine(line))
+            {
+                std::istringstream fields{ line };
+                std::string reply{};
+                long long jobId{};
+                fields >> reply >> jobId;
+                fields.get();
+
+                QS::SweepPointStats point{};
+                if (reply == "point" && QS::readSweepPoint(fields, point))
+                {
+                    if (onPoint)
+                        onPoint(point);
+                    points.push_back(point);
+                }
+                else
+                {
+                    done = reply == "done";
+                    break;
+                }
+            }
+        }
+        closeSocket(client);
+
+        if (!done)
+            throw std::runtime_error{ "The simulation service failed the sweep" };
+
+        std::sort(points.begin(), points.end(),
+            [](const auto& left, const auto& right)
+            {
+                return left.index < right.index;
+            });
+        return points;
+    }
+}
+
+struct QS::SimulationService::State
+{
+    // Worker w publishes the progress of its chunks in telemetry slot w + 1
+    void work(int slot);
+    void serve(const std::shared_ptr<Connection>& connection, std::uint64_t clientId);
+    void submit(const std::shared_ptr<Connection>& connection, std::uint64_t clientId, long long jobId,
+        JobType type, const SweepSpec& spec, int begin, int end);
+    void finish(const std::shared_ptr<Job>& job);
+    void unsubscribe(const std::shared_ptr<Connection>& connection);
+
+    std::size_t cacheCapacity{};
+
+    std::mutex mutex;
+    std::condition_variable tasksReady;
+    bool stopping{};
+
+    // Fair queuing: every client has its own queue of tasks and the clients
+    // with tasks wait in clientsTurn, the one served goes to the back
+    std::unordered_map<std::uint64_t, std::deque<Task>> clientsTasks;
+    std::deque<std::uint64_t> clientsTurn;
+
+    std::unordered_map<std::string, std::shared_ptr<Job>> jobsInFlight;
+    // Most recently requested first
+    std::list<std::pair<std::string, std::vector<SweepPointStats>>> cache;
+    std::unordered_map<std::string, decltype(cache)::iterator> cacheIndex;
+
+    std::atomic<Socket> listenSocket{ NO_SOCKET };
+};
+
+void QS::SimulationService::State::work(int slot)
+{
+    TelemetryPublisher telemetry{ slot + 1 };
+    while (true)
+    {
+        Task task{};
+        {
+            std::unique_lock lock{ mutex };
+            tasksReady.wait(lock, [this] { return stopping || !clientsTurn.empty(); });
+            if (stopping)
+                return;
+
+            auto clientId{ clientsTurn.front() };
+            clientsTurn.pop_front();
+            auto& tasks{ clientsTasks[clientId] };
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            if (tasks.empty())
+                clientsTasks.erase(clientId);
+            else
+                clientsTurn.push_back(clientId);
+        }
+
+        auto& job{ *task.job };
+        {
+            std::lock_guard lock{ job.mutex };
+            if (job.cancelled)
+                continue;
+        }
+
+        std::vector<SweepPointStats> points{};
+        bool failed{};
+        try
+        {
+            if (job.type == JobType::configuration)
+                points.push_back(runConfiguration(job.spec.baseConf));
+            else
+                points = runSweepChunk(job.spec, task.begin, task.end, telemetry.isOpen() ? &telemetry : nullptr);
+        }
+        catch (const std::exception&)
+        {
+            failed = true;
+        }
+
+        auto pointsText{ makePointsText(points) };
+        bool finished{};
+        {
+            // Points and the end of the job go out under the job lock, so
+            // nobody gets the end before a point
+            std::lock_guard lock{ job.mutex };
+            job.points.insert(job.points.end(), points.cbegin(), points.cend());
+            job.failed = job.failed || failed;
+            for (const auto& subscriber : job.subscribers)
+                sendPoints(subscriber, pointsText);
+
+            finished = !--job.pendingTasksCount;
+            if (finished)
+                for (const auto& subscriber : job.subscribers)
+                    sendEnd(subscriber, job.failed);
+        }
+
+        if (finished)
+            finish(task.job);
+    }
+}
+
+void QS::SimulationService::State::finish(const std::shared_ptr<Job>& job)
+{
+    std::lock_guard lock{ mutex };
+
+    auto inFlight{ jobsInFlight.find(job->key) };
+    if (inFlight != jobsInFlight.end() && inFlight->second == job)
+        jobsInFlight.erase(inFlight);
+
+    if (job->failed || !cacheCapacity)
+        return;
+
+    // The points are no longer written to once the job is finished
+    cache.emplace_front(job->key, job->points);
+    cacheIndex[job->key] = cache.begin();
+    if (cache.size() > cacheCapacity)
+    {
+        cacheIndex.erase(cache.back().first);
+        cache.pop_back();
+    }
+}
+
+void QS::SimulationService::State::submit(const std::shared_ptr<Connection>& connection, std::uint64_t clientId,
+    long long jobId, JobType type, const SweepSpec& spec, int begin, int end)
+{
+    Subscriber subscriber{ connection, jobId };
+    auto key{ (type == JobType::configuration ? "configuration\n" : "sweep\n") + makeJobText(spec, begin, end) };
+
+    std::shared_ptr<Job> job{};
+    {
+        std::lock_guard lock{ mutex };
+
+        auto cached{ cacheIndex.find(key) };
+        if (cached != cacheIndex.end())
+        {
+            cache.splice(cache.begin(), cache, cached->second);
+            auto pointsText{ makePointsText(cached->second->second) };
+            sendPoints(subscriber, pointsText);
+            sendEnd(subscriber, false);
+            return;
+        }
+
+        auto inFlight{ jobsInFlight.find(key) };
+        if (inFlight != jobsInFlight.end())
+            job = inFlight->second;
+        else
+        {
+            job = std::make_shared<Job>();
+            job->key = key;
+            job->type = type;
+            job->spec = spec;
+            job->subscribers.push_back(subscriber);
+
+            auto& tasks{ clientsTasks[clientId] };
+            if (tasks.empty())
+                clientsTurn.push_back(clientId);
+            for (int taskBegin{ begin }; taskBegin < end; taskBegin += SERVICE_TASK_POINTS)
+                tasks.push_back(Task{ job, taskBegin, std::min(taskBegin + SERVICE_TASK_POINTS, end) });
+            job->pendingTasksCount = (end - begin + SERVICE_TASK_POINTS - 1) / SERVICE_TASK_POINTS;
+
+            jobsInFlight.emplace(key, job);
+            tasksReady.notify_all();
+            return;
+        }
+    }
+
+    // Joins the job in flight with what it has simulated so far; a job that
+    // has just finished is still answered in full
+    std::lock_guard lock{ job->mutex };
+    sendPoints(subscriber, makePointsText(job->points));
+    if (job->pendingTasksCount)
+        job->subscribers.push_back(subscriber);
+    else
+        sendEnd(subscriber, job->failed);
+}
+
+void QS::SimulationService::State::unsubscribe(const std::shared_ptr<Connection>& connection)
+{
+    std::lock_guard lock{ mutex };
+    for (auto job{ jobsInFlight.begin() }; job != jobsInFlight.end();)
+    {
+        bool cancelled{};
+        {
+            auto& subscribers{ job->second->subscribers };
+            std::lock_guard jobLock{ job->second->mutex };
+            subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(),
+                [&connection](const Subscriber& subscriber)
+                {
+                    return subscriber.connection == connection;
+                }), subscribers.end());
+            // A finished job stays until finish moves it to the cache
+            cancelled = subscribers.empty() && job->second->pendingTasksCount;
+            job->second->cancelled = cancelled;
+        }
+
+        if (cancelled)
+            job = jobsInFlight.erase(job);
+        else
+            ++job;
+    }
+}
+
+void QS::SimulationService::State::serve(const std::shared_ptr<Connection>& connection, std::uint64_t clientId)
+{
+    LineReader reader{ connection->socket };
+    std::string header{};
+
+    while (reader.readLine(header))
+    {
+        std::istringstream fields{ header };
+        std::string type{};
+        long long jobId{};
+        fields >> type >> jobId;
+
+        std::string jobText{};
+        if (!fields || (type != "sweep" && type != "configuration") || !reader.readLines(jobText, JOB_LINES_COUNT))
+            break;
+
+        SweepSpec spec{};
+        int begin{};
+        int end{};
+        std::istringstream in{ jobText };
+        auto jobType{ type == "sweep" ? JobType::sweep : JobType::configuration };
+        if (!readSweepJob(in, spec, begin, end) || !isValidJob(jobType, spec, begin, end))
+        {
+            connection->send("error " + std::to_string(jobId) + '\n');
+            continue;
+        }
+
+        // A configuration is a job of one point whatever the sweep fields say,
+        // so equal configurations share the key
+        if (jobType == JobType::configuration)
+        {
+            spec.kind = SweepKind::research;
+            spec.prescreen = false;
+            spec.margins = ScreeningMargins{};
+            begin = 0;
+            end = 1;
+        }
+        submit(connection, clientId, jobId, jobType, spec, begin, end);
+    }
+
+    unsubscribe(connection);
+    connection->close();
+    connection->finished = true;
+}
+
+QS::SimulationService::SimulationService(const SimulationServiceConfiguration& conf):
+    conf_(conf),
+    state_(std::make_unique<State>())
+{
+    state_->cacheCapacity = conf_.cacheCapacity;
+}
+
+QS::SimulationService::~SimulationService() = default;
+
+bool QS::SimulationService::run()
+{
+    auto server{ listenOn(conf_.socketPath) };
+    if (server == NO_SOCKET)
+        return false;
+    state_->listenSocket = server;
+
+    int workersCount{ conf_.workersCount > 0 ? conf_.workersCount :
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency())) };
+    std::vector<std::thread> workers{};
+    for (int i{}; i < workersCount; ++i)
+        workers.emplace_back([this, i] { state_->work(i); });
+
+    struct Session
+    {
+        std::shared_ptr<Connection> connection;
+        std::thread thread;
+    };
+    std::vector<Session> sessions{};
+    std::uint64_t clientsCount{};
+
+    while (true)
+    {
+        auto client{ static_cast<Socket>(accept(server, nullptr, nullptr)) };
+        {
+            std::lock_guard lock{ state_->mutex };
+            if (state_->stopping)
+            {
+                if (client != NO_SOCKET)
+                    closeSocket(client);
+                break;
+            }
+        }
+        if (client == NO_SOCKET)
+            continue;
+
+        for (auto session{ sessions.begin() }; session != sessions.end();)
+        {
+            if (session->connection->finished)
+            {
+                session->thread.join();
+                session = sessions.erase(session);
+            }
+            else
+                ++session;
+        }
+
+        auto connection{ std::make_shared<Connection>(client) };
+        auto clientId{ clientsCount++ };
+        sessions.push_back(Session{ connection,
+            std::thread{ [this, connection, clientId] { state_->serve(connection, clientId); } } });
+    }
+
+    for (auto& worker : workers)
+        worker.join();
+    for (auto& session : sessions)
+    {
+        session.connection->interrupt();
+        session.thread.join();
+    }
+
+#ifndef _WIN32
+    closeSocket(server);
+#endif
+    std::error_code ec{};
+    fs::remove(conf_.socketPath, ec);
+    return true;
+}
+
+void QS::SimulationService::stop()
+{
+    {
+        std::lock_guard lock{ state_->mutex };
+        state_->stopping = true;
+    }
+    state_->tasksReady.notify_all();
+
+    // Closing is the only way to wake a blocked accept on Windows
+    auto server{ state_->listenSocket.exchange(NO_SOCKET) };
+    if (server == NO_SOCKET)
+        return;
+#ifdef _WIN32
+    closeSocket(server);
+#else
+    interruptSocket(server);
+#endif
+}
+
+fs::path QS::getServiceSocketPath()
+{
+    std::error_code ec{};
+    auto directory{ fs::temp_directory_path(ec) };
+    return (ec ? fs::path{} : directory) / "qs_service.sock";
+}
+
+int QS::runSimulationService(const SimulationServiceConfiguration& conf)
+{
+    SimulationService service{ conf };
+    return service.run() ? 0 : 1;
+}
+
+QS::SimulationClient::SimulationClient(const fs::path& socketPath):
+    socketPath_(socketPath)
+{}
+
+bool QS::SimulationClient::isAvailable() const
+{
+    auto client{ connectTo(socketPath_) };
+    if (client == NO_SOCKET)
+        return false;
+    closeSocket(client);
+    return true;
+}
+
+std::vector<QS::SweepPointStats> QS::SimulationClient::runSweep(const SweepSpec& spec,
+    const SweepPointCallback& onPoint) const
+{
+    if (spec.baseConf.trace)
+        throw std::invalid_argument{ "A trace cannot be sent to the simulation service" };
+
+    auto client{ connectTo(socketPath_) };
+    if (client == NO_SOCKET)
+        throw std::runtime_error{ "Cannot connect to the simulation service at " + socketPath_.string() };
+    return receiveSweep(client, spec, onPoint);
+}
+
+QS::SweepPointStats QS::SimulationClient::runConfiguration(const SystemConfiguration& conf) const
+{
+    if (conf.trace)
+        throw std::invalid_argument{ "A trace cannot be sent to the simulation service" };
+
+    auto client{ connectTo(socketPath_) };
+    if (client == NO_SOCKET)
+        throw std::runtime_error{ "Cannot connect to the simulation service at " + socketPath_.string() };
+
+    SweepSpec spec{};
+    spec.baseConf = conf;
+
+    SweepPointStats point{};
+    bool received{};
+    bool done{};
+    if (sendAll(client, "configuration 0\n" + makeJobText(spec, 0, 1)))
+    {
+        LineReader reader{ client };
+        std::string line{};
+        while (reader.readLine(line))
+        {
+            std::istringstream fields{ line };
+            std::string reply{};
+            long long jobId{};
+            fields >> reply >> jobId;
+            fields.get();
+
+            if (reply != "point")
+            {
+                done = reply == "done";
+                break;
+            }
+            received = readSweepPoint(fields, point);
+        }
+    }
+    closeSocket(client);
+
+    if (!done || !received)
+        throw std::runtime_error{ "The simulation service failed the configuration" };
+    return point;
+}
+
+std::vector<QS::SweepPointStats> QS::SimulationClient::operator()(const SweepSpec& spec) const
+{
+    if (spec.baseConf.trace)
+        return QS::runSweep(spec);
+
+    auto client{ connectTo(socketPath_) };
+    if (client == NO_SOCKET)
+        return QS::runSweep(spec);
+    return receiveSweep(client, spec, {});
+}
+
+int QS::runServiceSweep(std::ostream& out, SweepKind kind)
+{
+    SweepSpec spec{};
+    spec.kind = kind;
+
+    out.precision(std::numeric_limits<double>::max_digits10);
+    try
+    {
+        SimulationClient{}.runSweep(spec,
+            [&out](const SweepPointStats& point)
+            {
+                writeSweepPoint(out, point);
+                out.flush();
+            });
+    }
+    catch (const std::runtime_error& error)
+    {
+        out << error.what() << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,96 @@
+#ifndef SIMULATION_SERVICE_H
+#define SIMULATION_SERVICE_H
+
+#include "queueing_system_research.h"
+
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <vector>
+#include <ostream>
+#include <cstdint>
+
+namespace QueueingSystem
+{
+    inline constexpr const char* SIMULATION_SERVICE_FLAG{ "--service" };
+    inline constexpr const char* SERVICE_SWEEP_FLAG{ "--service-sweep" };
+    // Points of a sweep job scheduled at once, a long sweep yields the
+    // workers to other clients between its tasks
+    inline constexpr int SERVICE_TASK_POINTS{ 10 };
+    // Finished jobs kept for reuse, least recently requested dropped first
+    inline constexpr std::size_t SERVICE_CACHE_CAPACITY{ 64 };
+    // Bytes of replies a client may leave unread before it is dropped
+    inline constexpr std::size_t SERVICE_OUTGOING_CAPACITY{ 16 << 20 };
+
+    std::filesystem::path getServiceSocketPath();
+
+    struct SimulationServiceConfiguration
+    {
+        std::filesystem::path socketPath{ getServiceSocketPath() };
+        // 0 takes a worker per hardware thread
+        int workersCount{};
+        std::size_t cacheCapacity{ SERVICE_CACHE_CAPACITY };
+    };
+
+    // Long-running simulation service on a Unix domain socket. Clients submit
+    // sweep and single configuration jobs over a line protocol:
+    //   sweep <id> | configuration <id>, then the four lines of writeSweepJob
+    // and get back, as the points are simulated:
+    //   point <id> <writeSweepPoint fields> ... done <id> | error <id>
+    // Jobs are split into tasks of SERVICE_TASK_POINTS points queued per
+    // client, and the workers take the clients in turn, so one large sweep
+    // does not hold back everybody else. A job identical to one in flight
+    // joins it, one already finished is answered from the cache. Job results
+    // are not reproducible run to run, the reused answer is the first one.
+    class SimulationService
+    {
+    public:
+        explicit SimulationService(const SimulationServiceConfiguration& conf = {});
+        ~SimulationService();
+
+        SimulationService(const SimulationService&) = delete;
+        SimulationService& operator=(const SimulationService&) = delete;
+
+        // Serves until stop, false when the socket cannot be bound
+        bool run();
+        void stop();
+
+    private:
+        struct State;
+
+        SimulationServiceConfiguration conf_;
+        std::unique_ptr<State> state_;
+    };
+
+    int runSimulationService(const SimulationServiceConfiguration& conf);
+
+    using SweepPointCallback = std::function<void(const SweepPointStats& point)>;
+
+    // Thin client, connects for every job. Copies share nothing, so it can
+    // be handed around as a SweepRunner.
+    class SimulationClient
+    {
+    public:
+        explicit SimulationClient(const std::filesystem::path& socketPath = getServiceSocketPath());
+
+        bool isAvailable() const;
+
+        // Points come to onPoint as they are simulated and are returned
+        // sorted by index; throws std::runtime_error if the service fails
+        // and std::invalid_argument for a trace
+        std::vector<SweepPointStats> runSweep(const SweepSpec& spec, const SweepPointCallback& onPoint = {}) const;
+        SweepPointStats runConfiguration(const SystemConfiguration& conf) const;
+
+        // Runs the sweep locally when the service cannot be connected to;
+        // a trace is rejected by runSweep without connecting
+        std::vector<SweepPointStats> operator()(const SweepSpec& spec) const;
+
+    private:
+        std::filesystem::path socketPath_;
+    };
+
+    // Streams the points of a sweep of the default configuration through the service
+    int runServiceSweep(std::ostream& out, SweepKind kind);
+}
+
+#endif
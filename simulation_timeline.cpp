@@ -0,0 +1,189 @@
+#include "simulation_timeline.h"
+
+#include <algorithm>
+
+namespace QS = QueueingSystem;
+
+namespace
+{
+    // Memory held by a checkpoint, the distributions are small next to the
+    // generators and are left out
+    std::size_t getCheckpointSize(const QS::SystemCheckpoint& checkpoint)
+    {
+        std::size_t histogramsSize{};
+        for (const auto& sourceStats : checkpoint.stats.sourcesStats)
+            histogramsSize += sourceStats.waitingTime.getMemorySize() + sourceStats.sojournTime.getMemorySize();
+
+        return sizeof(checkpoint) + histogramsSize +
+            checkpoint.sources.size() * sizeof(QS::SourceState) +
+            checkpoint.devices.size() * sizeof(QS::DeviceState) +
+            checkpoint.buffer.size() * sizeof(QS::Request) +
+            checkpoint.stats.sourcesStats.size() * sizeof(QS::Statistics::SourceStats) +
+            checkpoint.stats.devicesStats.size() * sizeof(QS::Statistics::DeviceStats) +
+            2 * QS::SERIES_CAPACITY * sizeof(double);
+    }
+}
+
+QS::SimulationTimeline::SimulationTimeline(QueueingSystem& system, std::size_t memoryLimit):
+    system_(system),
+    memoryLimit_(memoryLimit)
+{
+    reset();
+}
+
+QS::QueueingSystem& QS::SimulationTimeline::getSystem()
+{
+    return system_;
+}
+
+void QS::SimulationTimeline::reset()
+{
+    system_.reset();
+    restart();
+}
+
+void QS::SimulationTimeline::reset(const SystemConfiguration& conf)
+{
+    system_.reset(conf);
+    restart();
+}
+
+bool QS::SimulationTimeline::makeStep()
+{
+    if (!system_.makeStep())
+    {
+        finished_ = true;
+        return false;
+    }
+
+    ++eventIndex_;
+    if (eventIndex_ > eventsCount_)
+    {
+        eventsCount_ = eventIndex_;
+
+        const auto& step{ system_.getLastStep() };
+        if (step.startedDeviceId >= 0)
+            busyTimeline_.addBusyPeriod(step.startedDeviceId, getTime(), step.serviceEndTime);
+        busyTimeline_.addBufferOccupancy(getTime(), step.bufferOccupancy);
+
+        if (eventIndex_ % interval_ == 0)
+            addCheckpoint();
+    }
+    return true;
+}
+
+long long QS::SimulationTimeline::getEventIndex() const
+{
+    return eventIndex_;
+}
+
+long long QS::SimulationTimeline::getEventsCount() const
+{
+    return eventsCount_;
+}
+
+bool QS::SimulationTimeline::isFinished() const
+{
+    return finished_;
+}
+
+double QS::SimulationTimeline::getTime() const
+{
+    return system_.getTime();
+}
+
+void QS::SimulationTimeline::seekEvent(long long eventIndex)
+{
+    eventIndex = std::max(eventIndex, 0LL);
+    if (finished_)
+        eventIndex = std::min(eventIndex, eventsCount_);
+
+    // Replaying from the current state is as good while no checkpoint lies
+    // between it and the target
+    auto next{ std::upper_bound(checkpoints_.cbegin(), checkpoints_.cend(), eventIndex,
+        [](long long index, const Checkpoint& checkpoint)
+        {
+            return index < checkpoint.eventIndex;
+        }) };
+    const auto& checkpoint{ *(next - 1) };
+    if (eventIndex < eventIndex_ || checkpoint.eventIndex > eventIndex_)
+        restore(checkpoint);
+
+    while (eventIndex_ < eventIndex && makeStep());
+}
+
+void QS::SimulationTimeline::seekTime(double time)
+{
+    auto next{ std::upper_bound(checkpoints_.cbegin(), checkpoints_.cend(), time,
+        [](double time, const Checkpoint& checkpoint)
+        {
+            return time < checkpoint.state.time;
+        }) };
+    const auto& checkpoint{ next != checkpoints_.cbegin() ? *(next - 1) : checkpoints_.front() };
+    if (time < getTime() || checkpoint.eventIndex > eventIndex_)
+        restore(checkpoint);
+
+    // The time of the next event is known only after it is processed
+    while (makeStep())
+        if (getTime() > time)
+        {
+            seekEvent(eventIndex_ - 1);
+            return;
+        }
+}
+
+std::size_t QS::SimulationTimeline::getCheckpointsCount() const
+{
+    return checkpoints_.size();
+}
+
+long long QS::SimulationTimeline::getCheckpointInterval() const
+{
+    return interval_;
+}
+
+const QS::BusyTimeline& QS::SimulationTimeline::getBusyTimeline() const
+{
+    return busyTimeline_;
+}
+
+void QS::SimulationTimeline::restart()
+{
+    checkpoints_.clear();
+    checkpointsSize_ = 0;
+    interval_ = INITIAL_CHECKPOINT_INTERVAL;
+    eventIndex_ = 0;
+    eventsCount_ = 0;
+    finished_ = false;
+    busyTimeline_.reset(system_.getDevicesCount());
+    addCheckpoint();
+}
+
+void QS::SimulationTimeline::addCheckpoint()
+{
+    Checkpoint checkpoint{ eventIndex_, system_.getCheckpoint() };
+    checkpoint.size = getCheckpointSize(checkpoint.state);
+    checkpointsSize_ += checkpoint.size;
+    checkpoints_.push_back(std::move(checkpoint));
+
+    // The checkpoints stay on the multiples of the interval, the one of the
+    // first event included
+    while (checkpointsSize_ > memoryLimit_ && checkpoints_.size() > MIN_CHECKPOINTS_COUNT)
+    {
+        interval_ *= 2;
+        checkpoints_.erase(std::remove_if(checkpoints_.begin(), checkpoints_.end(),
+            [this](const Checkpoint& checkpoint)
+            {
+                bool dropped{ checkpoint.eventIndex % interval_ != 0 };
+                if (dropped)
+                    checkpointsSize_ -= checkpoint.size;
+                return dropped;
+            }), checkpoints_.end());
+    }
+}
+
+void QS::SimulationTimeline::restore(const Checkpoint& checkpoint)
+{
+    system_.restore(checkpoint.state);
+    eventIndex_ = checkpoint.eventIndex;
+}
@@ -0,0 +1,78 @@
+#ifndef SIMULATION_TIMELINE_H
+#define SIMULATION_TIMELINE_H
+
+#include "queueing_system.h"
+#include "busy_timeline.h"
+
+#include <vector>
+#include <cstddef>
+
+namespace QueueingSystem
+{
+    inline constexpr std::size_t TIMELINE_MEMORY_LIMIT{ 64 << 20 };
+    inline constexpr long long INITIAL_CHECKPOINT_INTERVAL{ 256 };
+    inline constexpr std::size_t MIN_CHECKPOINTS_COUNT{ 4 };
+
+    // Step-by-step run of a QueueingSystem that can go back. The system is
+    // checkpointed on every interval-th event; a seek restores the nearest
+    // checkpoint before the target and replays the events after it, which the
+    // fixed random streams of the checkpoint make the same as the first time.
+    // When the checkpoints outgrow the memory limit every other one is dropped
+    // and the interval doubles, so a seek replays at most one interval.
+    class SimulationTimeline
+    {
+    public:
+        explicit SimulationTimeline(QueueingSystem& system, std::size_t memoryLimit = TIMELINE_MEMORY_LIMIT);
+
+        QueueingSystem& getSystem();
+
+        // Have to replace QueueingSystem::reset, the checkpoints belong to a run
+        void reset();
+        void reset(const SystemConfiguration& conf);
+
+        bool makeStep();
+
+        // Events processed up to the current state
+        long long getEventIndex() const;
+        // Furthest event reached so far, the length of the run once finished
+        long long getEventsCount() const;
+        bool isFinished() const;
+        double getTime() const;
+
+        // State right after eventIndex events, or the end of a shorter run
+        void seekEvent(long long eventIndex);
+        // State after the last event not later than time
+        void seekTime(double time);
+
+        std::size_t getCheckpointsCount() const;
+        long long getCheckpointInterval() const;
+
+        // Busy periods and buffer occupancy of the whole run reached so far,
+        // replayed events are not added again
+        const BusyTimeline& getBusyTimeline() const;
+
+    private:
+        struct Checkpoint
+        {
+            long long eventIndex{};
+            SystemCheckpoint state{};
+            std::size_t size{};
+        };
+
+        void restart();
+        void addCheckpoint();
+        void restore(const Checkpoint& checkpoint);
+
+        QueueingSystem& system_;
+        std::size_t memoryLimit_;
+        std::vector<Checkpoint> checkpoints_;
+        std::size_t checkpointsSize_{};
+        long long interval_{ INITIAL_CHECKPOINT_INTERVAL };
+        long long eventIndex_{};
+        long long eventsCount_{};
+        bool finished_{};
+        BusyTimeline busyTimeline_;
+    };
+}
+
+#endif
@@ -6,7 +6,8 @@ namespace QS = QueueingSystem;
 
 QS::Source::Source(int sourceId, double distrRange):
     sourceId_(sourceId),
-    distribution_(0.0, distrRange)
+    distrRange_(distrRange),
+    distribution_(std::make_unique<UniformDistribution>(0.0, distrRange))
 {}
 
 const double* QueueingSystem::Source::getNextGenerationTimePtr() const
@@ -21,12 +22,18 @@ const int* QueueingSystem::Source::getRequestsCountPtr() const
 
 void QS::Source::setDistributionRange(double distrRange)
 {
-    distribution_ = std::uniform_real_distribution<double>{ 0.0, distrRange };
+    distrRange_ = distrRange;
+    distribution_ = std::make_unique<UniformDistribution>(0.0, distrRange);
 }
 
 double QS::Source::getDistributionRange() const
 {
-    return distribution_.b();
+    return distrRange_;
+}
+
+void QS::Source::setDistribution(const Distribution& distribution)
+{
+    distribution_ = distribution.clone();
 }
 
 std::unique_ptr<QS::Request> QS::Source::generateRequest()
@@ -39,14 +46,32 @@ std::unique_ptr<QS::Request> QS::Source::generateRequest()
         nextGenerationTime_
     };
 
-    nextGenerationTime_ += distribution_(generator_);
+    nextGenerationTime_ += (*distribution_)(generator_);
 
     return std::make_unique<Request>(newRequest);
 }
 
+void QS::Source::reseed(std::mt19937& seeder)
+{
+    generator_.seed(seeder());
+}
+
 void QS::Source::reset()
 {
     nextGenerationTime_ = 0.0;
     requestsCount_ = 0;
-    distribution_.reset();
+    distribution_->reset();
+}
+
+QS::SourceState QS::Source::getState() const
+{
+    return SourceState{ nextGenerationTime_, requestsCount_, generator_, distribution_->clone() };
+}
+
+void QS::Source::restore(const SourceState& state)
+{
+    nextGenerationTime_ = state.nextGenerationTime;
+    requestsCount_ = state.requestsCount;
+    generator_ = state.generator;
+    distribution_ = state.distribution->clone();
 }
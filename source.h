@@ -2,18 +2,31 @@
 #define SOURCE_HPP
 
 #include "buffer.h"
+#include "distribution.h"
 
 #include <random>
 #include <memory>
+#include <cstdint>
 
 namespace QueueingSystem
 {
     inline constexpr double DISTRIBUTION_RANGE{ 5.0 };
 
+    struct SourceState
+    {
+        double nextGenerationTime{};
+        int requestsCount{};
+        std::mt19937 generator{};
+        UDistribution distribution{};
+        // Position in the trace of a TraceSource
+        std::int64_t recordIndex{};
+    };
+
     class Source
     {
     public:
         Source(int sourceId, double distrRange = DISTRIBUTION_RANGE);
+        virtual ~Source() = default;
 
         const double* getNextGenerationTimePtr() const;
         const int* getRequestsCountPtr() const;
@@ -21,17 +34,27 @@ namespace QueueingSystem
         void setDistributionRange(double distrRange);
         double getDistributionRange() const;
 
-        URequest generateRequest();
+        void setDistribution(const Distribution& distribution);
 
-        void reset();
+        virtual URequest generateRequest();
 
-    private:
+        void reseed(std::mt19937& seeder);
+
+        virtual void reset();
+
+        virtual SourceState getState() const;
+        virtual void restore(const SourceState& state);
+
+    protected:
         int sourceId_;
         double nextGenerationTime_{};
         int requestsCount_{};
 
+    private:
+        double distrRange_;
+
         std::mt19937 generator_{ std::random_device{}() };
-        std::uniform_real_distribution<double> distribution_;
+        UDistribution distribution_;
     };
 
     using USource = std::unique_ptr<Source>;
@@ -0,0 +1,92 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+
+namespace QueueingSystem
+{
+    inline constexpr std::size_t CACHE_LINE_SIZE{ 64 };
+
+    // Bounded lock-free queue between one producer and one consumer thread.
+    // Each side keeps a copy of the other's position and reloads it only
+    // when the queue looks full or empty, so the shared lines are touched
+    // once per batch rather than once per message.
+    template <class Message>
+    class SpscQueue
+    {
+    public:
+        // capacity is rounded up to a power of two
+        explicit SpscQueue(std::size_t capacity):
+            messages_(getCapacity(capacity)),
+            mask_(messages_.size() - 1)
+        {}
+
+        SpscQueue(const SpscQueue&) = delete;
+        SpscQueue& operator=(const SpscQueue&) = delete;
+
+        bool tryPush(const Message& message)
+        {
+            auto tail{ tail_.load(std::memory_order_relaxed) };
+            if (tail - cachedHead_ == messages_.size())
+            {
+                cachedHead_ = head_.load(std::memory_order_acquire);
+                if (tail - cachedHead_ == messages_.size())
+                    return false;
+            }
+
+            messages_[tail & mask_] = message;
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool tryPop(Message& message)
+        {
+            auto head{ head_.load(std::memory_order_relaxed) };
+            if (head == cachedTail_)
+            {
+                cachedTail_ = tail_.load(std::memory_order_acquire);
+                if (head == cachedTail_)
+                    return false;
+            }
+
+            message = messages_[head & mask_];
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        // The message tryPop would return, nullptr when there is none yet
+        const Message* peek()
+        {
+            auto head{ head_.load(std::memory_order_relaxed) };
+            if (head == cachedTail_)
+            {
+                cachedTail_ = tail_.load(std::memory_order_acquire);
+                if (head == cachedTail_)
+                    return nullptr;
+            }
+            return &messages_[head & mask_];
+        }
+
+    private:
+        static std::size_t getCapacity(std::size_t capacity)
+        {
+            std::size_t roundedCapacity{ 1 };
+            while (roundedCapacity < capacity)
+                roundedCapacity *= 2;
+            return roundedCapacity;
+        }
+
+        std::vector<Message> messages_;
+        std::size_t mask_;
+        // Consumer side
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> head_{};
+        std::size_t cachedTail_{};
+        // Producer side
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> tail_{};
+        std::size_t cachedHead_{};
+    };
+}
+
+#endif
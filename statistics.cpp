@@ -1,21 +1,14 @@
 #include "statistics.h"
+#include "entity_pool.h"
 
 #include <numeric>
 
 namespace QS = QueueingSystem;
 
 QS::Statistics::Statistics(const std::vector<USource>& sources,
-    const std::vector<UDevice>& devices):
-    sourcesStats_(sources.size()),
-    devicesStats_(devices.size())
+    const std::vector<UDevice>& devices)
 {
-    for (int i{}; i < sources.size(); ++i)
-        sourcesStats_[i] = std::make_unique<SourceStats>(
-            SourceStats{ sources[i]->getRequestsCountPtr() }
-        );
-
-    for (int i{}; i < devices.size(); ++i)
-        devicesStats_[i] = std::make_unique<DeviceStats>();
+    resize(sources, devices);
 }
 
 void QS::Statistics::setTotalTime(double time)
@@ -35,8 +28,10 @@ void QS::Statistics::reset()
     for (const auto& sourceStats : sourcesStats_)
     {
         sourceStats->rejectionsCount = 0;
-        sourceStats->bufferTime.clear();
-        sourceStats->serviceTime.clear();
+        sourceStats->bufferTime = TimeStats{};
+        sourceStats->serviceTime = TimeStats{};
+        sourceStats->waitingTime.reset();
+        sourceStats->sojournTime.reset();
     }
 
     for (const auto& deviceStats : devicesStats_)
@@ -45,9 +40,33 @@ void QS::Statistics::reset()
         deviceStats->serviceTime = 0.0;
     }
 
+    rejectionSeries_.reset();
+    waitingTimeSeries_.reset();
+    timeWindows_.reset();
+
     implTime_ = 0.0;
 }
 
+void QS::Statistics::reserve(int sourcesCount, int devicesCount)
+{
+    sourcesStats_.reserve(sourcesCount);
+    devicesStats_.reserve(devicesCount);
+    spareSourcesStats_.reserve(sourcesCount);
+    spareDevicesStats_.reserve(devicesCount);
+}
+
+void QS::Statistics::resize(const std::vector<USource>& sources, const std::vector<UDevice>& devices)
+{
+    resizeFromPool(sourcesStats_, spareSourcesStats_, sources.size(),
+        [](std::size_t) { return std::make_unique<SourceStats>(); });
+    resizeFromPool(devicesStats_, spareDevicesStats_, devices.size(),
+        [](std::size_t) { return std::make_unique<DeviceStats>(); });
+
+    // Sources may be replaced, e.g. by trace sources
+    for (int i{}; i < sources.size(); ++i)
+        sourcesStats_[i]->requestsCount = sources[i]->getRequestsCountPtr();
+}
+
 void QS::Statistics::incSourceRejectionsCount(int sourceId) const
 {
     sourcesStats_[sourceId]->rejectionsCount++;
@@ -55,12 +74,17 @@ void QS::Statistics::incSourceRejectionsCount(int sourceId) const
 
 void QS::Statistics::addSourceBufferTime(int sourceId, double time) const
 {
-    sourcesStats_[sourceId]->bufferTime.push_back(time);
+    sourcesStats_[sourceId]->bufferTime.add(time);
 }
 
 void QS::Statistics::addSourceServiceTime(int sourceId, double time) const
 {
-    sourcesStats_[sourceId]->serviceTime.push_back(time);
+    sourcesStats_[sourceId]->serviceTime.add(time);
+}
+
+void QS::Statistics::addSourceSojournTime(int sourceId, double time) const
+{
+    sourcesStats_[sourceId]->sojournTime.record(time);
 }
 
 void QS::Statistics::addDeviceStats(int deviceId, double time) const
@@ -69,6 +93,23 @@ void QS::Statistics::addDeviceStats(int deviceId, double time) const
     devicesStats_[deviceId]->serviceTime += time;
 }
 
+void QS::Statistics::addArrival(double time, bool rejection)
+{
+    rejectionSeries_.add(rejection ? 1.0 : 0.0);
+    timeWindows_.addArrival(time, rejection);
+}
+
+void QS::Statistics::addWaitingTime(int sourceId, double time)
+{
+    waitingTimeSeries_.add(time);
+    sourcesStats_[sourceId]->waitingTime.record(time);
+}
+
+void QS::Statistics::setLevels(double time, int busyDevicesCount, int bufferOccupancy)
+{
+    timeWindows_.setLevels(time, busyDevicesCount, bufferOccupancy);
+}
+
 std::vector<QS::USourceStatus> QS::Statistics::getSourcesStatus(std::vector<const double*> sourcesEventTime) const
 {
     std::vector<USourceStatus> sourcesStatus{ sourcesStats_.size() };
@@ -142,18 +183,21 @@ QS::USourceFinalStats QS::Statistics::getSourceFinalStats(int sourceId) const
     sourceFinalStats->rejectionProbability = static_cast<double>(sourceStats.rejectionsCount) /
         sourceFinalStats->requestsCount;
 
-    sourceFinalStats->averageBufferTime = std::accumulate(sourceStats.bufferTime.cbegin(),
-        sourceStats.bufferTime.cend(), 0.0) / (*sourceStats.requestsCount - sourceStats.rejectionsCount);
-    sourceFinalStats->averageServiceTime = std::accumulate(sourceStats.serviceTime.cbegin(),
-        sourceStats.serviceTime.cend(), 0.0) / (*sourceStats.requestsCount - sourceStats.rejectionsCount);
+    sourceFinalStats->averageBufferTime = sourceStats.bufferTime.sum /
+        (*sourceStats.requestsCount - sourceStats.rejectionsCount);
+    sourceFinalStats->averageServiceTime = sourceStats.serviceTime.sum /
+        (*sourceStats.requestsCount - sourceStats.rejectionsCount);
     sourceFinalStats->averageProcessingTime = sourceFinalStats->averageBufferTime +
         sourceFinalStats->averageServiceTime;
 
-    sourceFinalStats->bufferTimeDispersion = getDispersion(sourceStats.bufferTime,
+    sourceFinalStats->bufferTimeDispersion = sourceStats.bufferTime.getDispersion(
         sourceFinalStats->averageBufferTime);
-    sourceFinalStats->serviceTimeDispersion = getDispersion(sourceStats.serviceTime,
+    sourceFinalStats->serviceTimeDispersion = sourceStats.serviceTime.getDispersion(
         sourceFinalStats->averageServiceTime);
 
+    sourceFinalStats->waitingTimeHistogram = sourceStats.waitingTime;
+    sourceFinalStats->sojournTimeHistogram = sourceStats.sojournTime;
+
     return std::move(sourceFinalStats);
 }
 
@@ -178,11 +222,67 @@ int QS::Statistics::getRejectionsCount() const
         });
 }
 
-double QS::Statistics::getDispersion(const std::vector<double>& timeVector, double averageTime) const
+QS::SteadyStateEstimate QS::Statistics::getRejectionEstimate() const
 {
-    return averageTime == 0 ? 0.0 : std::accumulate(timeVector.cbegin(), timeVector.cend(), 0.0,
-        [&](double sum, double time)
-        {
-            return sum + (time - averageTime) * (time - averageTime);
-        }) / timeVector.size();
+    return rejectionSeries_.getEstimate();
+}
+
+QS::SteadyStateEstimate QS::Statistics::getWaitingTimeEstimate() const
+{
+    return waitingTimeSeries_.getEstimate();
+}
+
+QS::Statistics::State QS::Statistics::getState() const
+{
+    State state{};
+    state.sourcesStats.reserve(sourcesStats_.size());
+    for (const auto& sourceStats : sourcesStats_)
+        state.sourcesStats.push_back(*sourceStats);
+
+    state.devicesStats.reserve(devicesStats_.size());
+    for (const auto& deviceStats : devicesStats_)
+        state.devicesStats.push_back(*deviceStats);
+
+    state.rejectionSeries = rejectionSeries_;
+    state.waitingTimeSeries = waitingTimeSeries_;
+    state.timeWindows = timeWindows_;
+    state.simTime = simTime_;
+    state.implTime = implTime_;
+    return state;
+}
+
+void QS::Statistics::restore(const State& state)
+{
+    for (std::size_t i{}; i < sourcesStats_.size(); ++i)
+        *sourcesStats_[i] = state.sourcesStats[i];
+
+    for (std::size_t i{}; i < devicesStats_.size(); ++i)
+        *devicesStats_[i] = state.devicesStats[i];
+
+    rejectionSeries_ = state.rejectionSeries;
+    waitingTimeSeries_ = state.waitingTimeSeries;
+    timeWindows_ = state.timeWindows;
+    simTime_ = state.simTime;
+    implTime_ = state.implTime;
+}
+
+QS::LatencyHistogram QS::Statistics::getWaitingTimeHistogram() const
+{
+    LatencyHistogram histogram{};
+    for (const auto& sourceStats : sourcesStats_)
+        histogram.merge(sourceStats->waitingTime);
+    return histogram;
+}
+
+QS::LatencyHistogram QS::Statistics::getSojournTimeHistogram() const
+{
+    LatencyHistogram histogram{};
+    for (const auto& sourceStats : sourcesStats_)
+        histogram.merge(sourceStats->sojournTime);
+    return histogram;
+}
+
+const std::vector<QS::TimeWindow>& QS::Statistics::getTimeWindows() const
+{
+    return timeWindows_.getWindows();
 }
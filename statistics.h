@@ -5,15 +5,67 @@
 #include "final_statistics.h"
 #include "source.h"
 #include "device.h"
+#include "output_analysis.h"
+#include "time_windows.h"
 
 #include <vector>
 #include <memory>
 
 namespace QueueingSystem
 {
+    // Running sums of the times of a series, enough for its mean and dispersion
+    struct TimeStats
+    {
+        int count{};
+        double sum{};
+        double squaresSum{};
+
+        void add(double time)
+        {
+            ++count;
+            sum += time;
+            squaresSum += time * time;
+        }
+
+        // Mean square deviation from averageTime over the added times
+        double getDispersion(double averageTime) const
+        {
+            return averageTime == 0 ? 0.0 :
+                (squaresSum - 2.0 * averageTime * sum + count * averageTime * averageTime) / count;
+        }
+    };
+
     class Statistics
     {
     public:
+        struct SourceStats
+        {
+            const int* requestsCount{};
+            int rejectionsCount{};
+            TimeStats bufferTime{};
+            TimeStats serviceTime{};
+            LatencyHistogram waitingTime{};
+            LatencyHistogram sojournTime{};
+        };
+
+        struct DeviceStats
+        {
+            int requestsCount{};
+            double serviceTime{};
+        };
+
+        // Values of all the counters, the entities are the same on restore
+        struct State
+        {
+            std::vector<SourceStats> sourcesStats{};
+            std::vector<DeviceStats> devicesStats{};
+            BatchedSeries rejectionSeries{};
+            BatchedSeries waitingTimeSeries{};
+            TimeWindowSeries timeWindows{};
+            double simTime{};
+            double implTime{};
+        };
+
         Statistics(const std::vector<USource>& sources,
             const std::vector<UDevice>& devices);
 
@@ -22,11 +74,23 @@ namespace QueueingSystem
 
         void reset();
 
+        void reserve(int sourcesCount, int devicesCount);
+        // Takes the entities of a reconfigured system, reset() has to follow
+        void resize(const std::vector<USource>& sources, const std::vector<UDevice>& devices);
+
         void incSourceRejectionsCount(int sourceId) const;
         void addSourceBufferTime(int sourceId, double time) const;
         void addSourceServiceTime(int sourceId, double time) const;
+        void addSourceSojournTime(int sourceId, double time) const;
         void addDeviceStats(int deviceId, double time) const;
 
+        // System-wide series for the steady-state estimates: one observation
+        // per arrival (1 if it caused a rejection) and per service start
+        void addArrival(double time, bool rejection);
+        void addWaitingTime(int sourceId, double time);
+        // Busy devices and buffer occupancy after the event at time
+        void setLevels(double time, int busyDevicesCount, int bufferOccupancy);
+
         std::vector<USourceStatus> getSourcesStatus(std::vector<const double*> sourcesEventTime) const;
         std::vector<UDeviceStatus> getDevicesStatus(std::vector<const double*> devicesEventTime) const;
 
@@ -38,27 +102,28 @@ namespace QueueingSystem
 
         int getRejectionsCount() const;
 
-    private:
-        struct SourceStats
-        {
-            const int* requestsCount{};
-            int rejectionsCount{};
-            std::vector<double> bufferTime{};
-            std::vector<double> serviceTime{};
-        };
+        SteadyStateEstimate getRejectionEstimate() const;
+        SteadyStateEstimate getWaitingTimeEstimate() const;
+        // System-wide, merged over the sources
+        LatencyHistogram getWaitingTimeHistogram() const;
+        LatencyHistogram getSojournTimeHistogram() const;
+        const std::vector<TimeWindow>& getTimeWindows() const;
 
-        struct DeviceStats
-        {
-            int requestsCount{};
-            double serviceTime{};
-        };
+        State getState() const;
+        // Counters are overwritten in place, pointers given out stay valid
+        void restore(const State& state);
 
+    private:
         USourceFinalStats getSourceFinalStats(int sourceId) const;
         UDeviceFinalStats getDeviceFinalStats(int deviceId) const;
-        double getDispersion(const std::vector<double>& timeVector, double averageTime) const;
 
         std::vector<std::unique_ptr<SourceStats>> sourcesStats_;
         std::vector<std::unique_ptr<DeviceStats>> devicesStats_;
+        std::vector<std::unique_ptr<SourceStats>> spareSourcesStats_;
+        std::vector<std::unique_ptr<DeviceStats>> spareDevicesStats_;
+        BatchedSeries rejectionSeries_{};
+        BatchedSeries waitingTimeSeries_{};
+        TimeWindowSeries timeWindows_{};
         double simTime_{ -1.0 };
         double implTime_{ -1.0 };
     };
@@ -0,0 +1,406 @@
+#include "surrogate_search.h"
+#include "basic_queueing_system.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <random>
+#include <set>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace QS = QueueingSystem;
+
+namespace
+{
+    constexpr int PARAMETERS_COUNT{ 5 };
+    constexpr double RIDGE{ 1e-3 };
+    constexpr double MIN_DEVIATION{ 1e-3 };
+    constexpr double LOCAL_CANDIDATES_SHARE{ 0.5 };
+    constexpr double LOCAL_STEP{ 0.03 };
+
+    using Point = std::vector<double>;
+    using ConfKey = std::tuple<int, int, int, float, float>;
+
+    double logit(double p)
+    {
+        return std::log(p / (1.0 - p));
+    }
+
+    double getNormalCdf(double z)
+    {
+        return 0.5 * std::erfc(-z / std::sqrt(2.0));
+    }
+
+    double getNormalDensity(double z)
+    {
+        return std::exp(-z * z / 2.0) / std::sqrt(2.0 * 3.14159265358979323846);
+    }
+
+    ConfKey getConfKey(const QS::SystemConfiguration& conf)
+    {
+        return ConfKey{ conf.bufferSize, conf.devicesCount, conf.sourcesCount, conf.lambda, conf.distrRange };
+    }
+
+    // Normalized coordinates over the free parameters of the space
+    class SpaceMapping
+    {
+    public:
+        SpaceMapping(const QS::SearchSpace& space, const QS::SystemConfiguration& baseConf):
+            ranges_{ space.bufferSize, space.devicesCount, space.lambda, space.sourcesCount, space.distrRange },
+            baseConf_(baseConf)
+        {
+            for (int i{}; i < PARAMETERS_COUNT; ++i)
+                if (ranges_[i].max > ranges_[i].min)
+                    free_.push_back(i);
+        }
+
+        int getDimension() const
+        {
+            return static_cast<int>(free_.size());
+        }
+
+        QS::SystemConfiguration getConfiguration(const Point& point) const
+        {
+            std::array<double, PARAMETERS_COUNT> values{};
+            for (int i{}; i < PARAMETERS_COUNT; ++i)
+                values[i] = ranges_[i].min;
+            for (int d{}; d < getDimension(); ++d)
+            {
+                const auto& range{ ranges_[free_[d]] };
+                double value{ range.min + point[d] * (range.max - range.min) };
+                if (range.step > 0.0)
+                    value = std::min(range.min + std::round((value - range.min) / range.step) * range.step, range.max);
+                values[free_[d]] = value;
+            }
+
+            auto conf{ baseConf_ };
+            conf.bufferSize = std::max(static_cast<int>(std::lround(values[0])), 1);
+            conf.devicesCount = std::max(static_cast<int>(std::lround(values[1])), 1);
+            conf.lambda = static_cast<float>(values[2]);
+            conf.sourcesCount = std::max(static_cast<int>(std::lround(values[3])), 1);
+            conf.distrRange = static_cast<float>(values[4]);
+            return conf;
+        }
+
+    private:
+        std::array<QS::ParameterRange, PARAMETERS_COUNT> ranges_;
+        QS::SystemConfiguration baseConf_;
+        std::vector<int> free_;
+    };
+
+    // 1, u_i and u_i * u_j for i <= j
+    std::vector<double> getFeatures(const Point& point)
+    {
+        std::vector<double> features{ 1.0 };
+        for (std::size_t i{}; i < point.size(); ++i)
+            features.push_back(point[i]);
+        for (std::size_t i{}; i < point.size(); ++i)
+            for (std::size_t j{ i }; j < point.size(); ++j)
+                features.push_back(point[i] * point[j]);
+        return features;
+    }
+
+    // Ridge regression y ~ features * coefficients; the deviation of a
+    // prediction is the residual deviation scaled by sqrt(f' A^-1 f) for
+    // A = X'X + RIDGE * I, kept as its Cholesky factor
+    class ResponseSurface
+    {
+    public:
+        void fit(const std::vector<std::vector<double>>& features, const std::vector<double>& values)
+        {
+            int size{ static_cast<int>(features.front().size()) };
+            std::vector<std::vector<double>> normal(size, std::vector<double>(size, 0.0));
+            std::vector<double> right(size, 0.0);
+            for (std::size_t n{}; n < features.size(); ++n)
+                for (int i{}; i < size; ++i)
+                {
+                    right[i] += features[n][i] * values[n];
+                    for (int j{}; j < size; ++j)
+                        normal[i][j] += features[n][i] * features[n][j];
+                }
+
+            for (int i{}; i < size; ++i)
+                normal[i][i] += RIDGE;
+
+            factor_ = normal;
+            for (int j{}; j < size; ++j)
+            {
+                for (int k{}; k < j; ++k)
+                    factor_[j][j] -= factor_[j][k] * factor_[j][k];
+                factor_[j][j] = std::sqrt(factor_[j][j]);
+
+                for (int i{ j + 1 }; i < size; ++i)
+                {
+                    for (int k{}; k < j; ++k)
+                        factor_[i][j] -= factor_[i][k] * factor_[j][k];
+                    factor_[i][j] /= factor_[j][j];
+                }
+            }
+
+            // L L' coefficients = X'y
+            coefficients_ = solveLower(right);
+            for (int i{ size - 1 }; i >= 0; --i)
+            {
+                for (int k{ i + 1 }; k < size; ++k)
+                    coefficients_[i] -= factor_[k][i] * coefficients_[k];
+                coefficients_[i] /= factor_[i][i];
+            }
+
+            double squaresSum{};
+            for (std::size_t n{}; n < features.size(); ++n)
+            {
+                double residual{ values[n] - predict(features[n]) };
+                squaresSum += residual * residual;
+            }
+            deviation_ = std::sqrt(squaresSum / std::max(static_cast<int>(features.size()) - size, 1));
+        }
+
+        double predict(const std::vector<double>& features) const
+        {
+            double value{};
+            for (std::size_t i{}; i < features.size(); ++i)
+                value += coefficients_[i] * features[i];
+            return value;
+        }
+
+        double getDeviation(const std::vector<double>& features) const
+        {
+            double squaredNorm{};
+            for (double value : solveLower(features))
+                squaredNorm += value * value;
+            return std::max(deviation_ * std::sqrt(squaredNorm), MIN_DEVIATION);
+        }
+
+    private:
+        std::vector<double> solveLower(std::vector<double> values) const
+        {
+            for (std::size_t i{}; i < values.size(); ++i)
+            {
+                for (std::size_t k{}; k < i; ++k)
+                    values[i] -= factor_[i][k] * values[k];
+                values[i] /= factor_[i][i];
+            }
+            return values;
+        }
+
+        std::vector<std::vector<double>> factor_;
+        std::vector<double> coefficients_;
+        double deviation_{};
+    };
+
+    template <class System>
+    class SurrogateSearch
+    {
+    public:
+        explicit SurrogateSearch(const QS::SurrogateSearchConfiguration& search):
+            search_(search),
+            mapping_(search.space, search.baseConf),
+            generator_(search.seed),
+            system_(search.baseConf),
+            rejectionFloor_(0.5 / std::max(search.baseConf.requestsLimit, 1))
+        {
+            // Candidates range up to the upper bounds of the space
+            auto capacity{ search.baseConf };
+            capacity.sourcesCount = static_cast<int>(search.space.sourcesCount.max);
+            capacity.bufferSize = static_cast<int>(search.space.bufferSize.max);
+            capacity.devicesCount = static_cast<int>(search.space.devicesCount.max);
+            system_.reserve(capacity);
+        }
+
+        QS::SurrogateSearchResult run()
+        {
+            int dimension{ mapping_.getDimension() };
+
+            // Latin hypercube: every parameter hits each of the strata once.
+            // The surfaces are fitted to at least one point.
+            int initialSize{ std::min(std::max(search_.initialDesignSize, 1), search_.simulationsBudget) };
+            std::vector<std::vector<int>> strata(dimension);
+            for (auto& order : strata)
+            {
+                order.resize(initialSize);
+                for (int i{}; i < initialSize; ++i)
+                    order[i] = i;
+                std::shuffle(order.begin(), order.end(), generator_);
+            }
+
+            std::uniform_real_distribution<double> uniform{ 0.0, 1.0 };
+            for (int i{}; i < initialSize; ++i)
+            {
+                Point point(dimension);
+                for (int d{}; d < dimension; ++d)
+                    point[d] = (strata[d][i] + uniform(generator_)) / initialSize;
+                simulate(point);
+            }
+
+            while (simulationsCount_ < search_.simulationsBudget && dimension)
+            {
+                fitSurfaces();
+
+                const Point* next{};
+                double nextScore{ -1.0 };
+                auto candidates{ makeCandidates() };
+                for (const auto& candidate : candidates)
+                {
+                    if (simulated_.count(getConfKey(mapping_.getConfiguration(candidate))))
+                        continue;
+
+                    double score{ getScore(candidate) };
+                    if (score > nextScore)
+                    {
+                        nextScore = score;
+                        next = &candidate;
+                    }
+                }
+
+                if (!next)
+                    break;
+                simulate(*next);
+            }
+
+            return QS::SurrogateSearchResult{ top_.getSorted(), simulationsCount_,
+                static_cast<int>(feasible_.size()) };
+        }
+
+    private:
+        struct Observation
+        {
+            Point point{};
+            std::vector<double> features{};
+            double rejectionResidual{};
+            double workloadResidual{};
+        };
+
+        void simulate(const Point& point)
+        {
+            auto conf{ mapping_.getConfiguration(point) };
+            if (!simulated_.insert(getConfKey(conf)).second)
+                return;
+
+            system_.reset(conf);
+            system_.run();
+            auto stats{ system_.getSystemFinalStats() };
+            ++simulationsCount_;
+
+            auto approximation{ QS::approximateSystem(conf) };
+            observations_.push_back(Observation{
+                point,
+                getFeatures(point),
+                clampedLogit(stats.rejectionProbability) - clampedLogit(approximation.rejectionProbability),
+                stats.workload - approximation.workload
+            });
+
+            if (QS::confSatisfyConstraints(stats.rejectionProbability, stats.workload))
+            {
+                feasible_.emplace(stats.workload, point);
+                top_.add(QS::SystemConfigurationStats{ conf, stats.rejectionProbability, stats.workload });
+            }
+        }
+
+        void fitSurfaces()
+        {
+            std::vector<std::vector<double>> features{};
+            std::vector<double> rejectionResiduals{};
+            std::vector<double> workloadResiduals{};
+            for (const auto& observation : observations_)
+            {
+                features.push_back(observation.features);
+                rejectionResiduals.push_back(observation.rejectionResidual);
+                workloadResiduals.push_back(observation.workloadResidual);
+            }
+
+            rejectionSurface_.fit(features, rejectionResiduals);
+            workloadSurface_.fit(features, workloadResiduals);
+        }
+
+        // Uniform points and local steps around the current top
+        std::vector<Point> makeCandidates()
+        {
+            int dimension{ mapping_.getDimension() };
+            int localCount{ feasible_.empty() ? 0 :
+                static_cast<int>(search_.candidatesCount * LOCAL_CANDIDATES_SHARE) };
+
+            std::vector<const Point*> top{};
+            for (auto it{ feasible_.crbegin() }; it != feasible_.crend() && top.size() < QS::BEST_CONFIGURATIONS_COUNT; ++it)
+                top.push_back(&it->second);
+
+            std::uniform_real_distribution<double> uniform{ 0.0, 1.0 };
+            std::normal_distribution<double> step{ 0.0, LOCAL_STEP };
+            std::uniform_int_distribution<std::size_t> center{ 0, top.empty() ? 0 : top.size() - 1 };
+
+            std::vector<Point> candidates{};
+            candidates.reserve(search_.candidatesCount);
+            for (int i{}; i < search_.candidatesCount; ++i)
+            {
+                Point point(dimension);
+                if (i < localCount)
+                {
+                    const auto& origin{ *top[center(generator_)] };
+                    for (int d{}; d < dimension; ++d)
+                        point[d] = std::clamp(origin[d] + step(generator_), 0.0, 1.0);
+                }
+                else
+                {
+                    for (auto& value : point)
+                        value = uniform(generator_);
+                }
+                candidates.push_back(std::move(point));
+            }
+            return candidates;
+        }
+
+        // Expected improvement of the workload over the last place of the top
+        // times the probability of the rejection constraint
+        double getScore(const Point& point) const
+        {
+            auto conf{ mapping_.getConfiguration(point) };
+            auto approximation{ QS::approximateSystem(conf) };
+            auto features{ getFeatures(point) };
+
+            double rejectionMean{ clampedLogit(approximation.rejectionProbability) + rejectionSurface_.predict(features) };
+            double rejectionDeviation{ rejectionSurface_.getDeviation(features) };
+            double workloadMean{ approximation.workload + workloadSurface_.predict(features) };
+            double workloadDeviation{ workloadSurface_.getDeviation(features) };
+
+            double threshold{ QS::WORKLOAD_CONSTRAINT };
+            if (feasible_.size() >= QS::BEST_CONFIGURATIONS_COUNT)
+                threshold = std::next(feasible_.crbegin(), QS::BEST_CONFIGURATIONS_COUNT - 1)->first;
+
+            double z{ (workloadMean - threshold) / workloadDeviation };
+            double improvement{ (workloadMean - threshold) * getNormalCdf(z) + workloadDeviation * getNormalDensity(z) };
+
+            double feasibility{ getNormalCdf((logit(QS::REJECT_PROB_CONSTRAINT) - rejectionMean) / rejectionDeviation) };
+            return improvement * feasibility;
+        }
+
+        // Runs of requestsLimit arrivals often reject nothing, half a
+        // rejection keeps the logit finite
+        double clampedLogit(double p) const
+        {
+            return logit(std::clamp(p, rejectionFloor_, 1.0 - rejectionFloor_));
+        }
+
+        const QS::SurrogateSearchConfiguration& search_;
+        SpaceMapping mapping_;
+        std::mt19937 generator_;
+        System system_;
+        double rejectionFloor_;
+
+        std::vector<Observation> observations_;
+        std::set<ConfKey> simulated_;
+        // Feasible points by simulated workload
+        std::multimap<double, Point> feasible_;
+        ResponseSurface rejectionSurface_{};
+        ResponseSurface workloadSurface_{};
+        int simulationsCount_{};
+        QS::TopConfigurations top_{};
+    };
+}
+
+QS::SurrogateSearchResult QS::searchBySurrogate(const SurrogateSearchConfiguration& search)
+{
+    if (search.baseConf.arrivalDistribution || search.baseConf.serviceDistribution)
+        return SurrogateSearch<DistributionQueueingSystem>{ search }.run();
+    return SurrogateSearch<DefaultQueueingSystem>{ search }.run();
+}
@@ -0,0 +1,57 @@
+#ifndef SURROGATE_SEARCH_H
+#define SURROGATE_SEARCH_H
+
+#include "queueing_system_research.h"
+
+#include <cstdint>
+
+namespace QueueingSystem
+{
+    // Equal bounds fix the parameter. A nonzero step snaps values to
+    // min + k * step; bufferSize, devicesCount and sourcesCount are whole anyway.
+    struct ParameterRange
+    {
+        double min{};
+        double max{};
+        double step{};
+    };
+
+    // The research grid by default
+    struct SearchSpace
+    {
+        ParameterRange bufferSize{ 10.0, 500.0, 10.0 };
+        ParameterRange devicesCount{ 10.0, 500.0, 10.0 };
+        ParameterRange lambda{ 0.021, 0.07, 0.001 };
+        ParameterRange sourcesCount{ 10.0, 10.0 };
+        ParameterRange distrRange{ 5.0, 5.0 };
+    };
+
+    struct SurrogateSearchConfiguration
+    {
+        SearchSpace space{};
+        // Parameters outside the space: requestsLimit, distributions
+        SystemConfiguration baseConf{};
+        int initialDesignSize{ 40 };
+        int simulationsBudget{ 300 };
+        int candidatesCount{ 2000 };
+        std::uint32_t seed{ 1 };
+    };
+
+    struct SurrogateSearchResult
+    {
+        // Best simulated configurations satisfying the constraints
+        ResearchedConfStats confStats{};
+        int simulationsCount{};
+        int feasibleCount{};
+    };
+
+    // Quadratic response surfaces of the simulation's departure from
+    // approximateSystem, logit of the rejection probability and workload, are
+    // refitted by ridge regression after every simulation. The next point
+    // maximizes the expected improvement of the workload over the
+    // BEST_CONFIGURATIONS_COUNT-th best feasible one times the probability of
+    // satisfying both constraints. The first points are a Latin hypercube.
+    SurrogateSearchResult searchBySurrogate(const SurrogateSearchConfiguration& search);
+}
+
+#endif
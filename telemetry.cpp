@@ -0,0 +1,388 @@
+#include "telemetry.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <thread>
+#include <iomanip>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace QS = QueueingSystem;
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+    "Telemetry words are shared between processes and must not hide a lock");
+
+namespace
+{
+    // A snapshot of a live process not updated for this long is shown as stale
+    constexpr std::int64_t STALE_AFTER_MS{ 5000 };
+    constexpr int READ_ATTEMPTS{ 64 };
+
+    std::int64_t getEpochMilliseconds()
+    {
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    void storeSnapshot(QS::TelemetryBlock& block, const QS::TelemetrySnapshot& snapshot)
+    {
+        std::uint64_t words[QS::TELEMETRY_WORDS_COUNT];
+        std::memcpy(words, &snapshot, sizeof(words));
+
+        auto sequence{ block.sequence.load(std::memory_order_relaxed) };
+        block.sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (int i{}; i < QS::TELEMETRY_WORDS_COUNT; ++i)
+            block.words[i].store(words[i], std::memory_order_relaxed);
+        block.sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    bool loadSnapshot(const QS::TelemetryBlock& block, QS::TelemetrySnapshot& snapshot)
+    {
+        if (block.magic != QS::TELEMETRY_MAGIC || block.version != QS::TELEMETRY_VERSION)
+            return false;
+
+        std::uint64_t words[QS::TELEMETRY_WORDS_COUNT];
+        for (int attempt{}; attempt < READ_ATTEMPTS; ++attempt)
+        {
+            auto sequence{ block.sequence.load(std::memory_order_acquire) };
+            if (sequence & 1)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            for (int i{}; i < QS::TELEMETRY_WORDS_COUNT; ++i)
+                words[i] = block.words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+
+            if (block.sequence.load(std::memory_order_relaxed) == sequence)
+            {
+                std::memcpy(&snapshot, words, sizeof(words));
+                return true;
+            }
+        }
+        return false;
+    }
+}
+
+#ifdef _WIN32
+
+std::string QS::getTelemetrySegmentName(int slot)
+{
+    return "Local\\qs_telemetry_" + std::to_string(slot);
+}
+
+bool QS::isTelemetryEnabled()
+{
+    // A longer value does not fit and its required size comes back instead
+    char value[2]{};
+    auto length{ GetEnvironmentVariableA(TELEMETRY_ENVIRONMENT_VARIABLE, value, sizeof(value)) };
+    return length > 0 && !(length == 1 && value[0] == '0');
+}
+
+namespace
+{
+    std::int64_t getProcessId()
+    {
+        return static_cast<std::int64_t>(GetCurrentProcessId());
+    }
+
+    // The mutex of a dead owner is abandoned and taken over. A mutex is owned
+    // by a thread, so the publisher is released on the thread that claimed it.
+    std::intptr_t claimSlot(const std::string& name)
+    {
+        HANDLE mutex{ CreateMutexA(nullptr, FALSE, (name + "_owner").c_str()) };
+        if (!mutex)
+            return -1;
+
+        auto result{ WaitForSingleObject(mutex, 0) };
+        if (result != WAIT_OBJECT_0 && result != WAIT_ABANDONED)
+        {
+            CloseHandle(mutex);
+            return -1;
+        }
+        return reinterpret_cast<std::intptr_t>(mutex);
+    }
+
+    void releaseSlot(std::intptr_t claim)
+    {
+        ReleaseMutex(reinterpret_cast<HANDLE>(claim));
+        CloseHandle(reinterpret_cast<HANDLE>(claim));
+    }
+
+    // Backed by the paging file; the mapping lives while a handle to it is open
+    QS::TelemetryBlock* createSegment(const std::string& name, std::intptr_t& handle)
+    {
+        HANDLE mapping{ CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE,
+            0, sizeof(QS::TelemetryBlock), name.c_str()) };
+        if (!mapping)
+            return nullptr;
+
+        void* data{ MapViewOfFile(mapping, FILE_MAP_WRITE, 0, 0, sizeof(QS::TelemetryBlock)) };
+        if (!data)
+        {
+            CloseHandle(mapping);
+            return nullptr;
+        }
+        handle = reinterpret_cast<std::intptr_t>(mapping);
+        return static_cast<QS::TelemetryBlock*>(data);
+    }
+
+    const QS::TelemetryBlock* openSegment(const std::string& name, std::intptr_t& handle)
+    {
+        HANDLE mapping{ OpenFileMappingA(FILE_MAP_READ, FALSE, name.c_str()) };
+        if (!mapping)
+            return nullptr;
+
+        void* data{ MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, sizeof(QS::TelemetryBlock)) };
+        if (!data)
+        {
+            CloseHandle(mapping);
+            return nullptr;
+        }
+        handle = reinterpret_cast<std::intptr_t>(mapping);
+        return static_cast<const QS::TelemetryBlock*>(data);
+    }
+
+    void closeSegment(const QS::TelemetryBlock* block, std::intptr_t handle)
+    {
+        if (block)
+            UnmapViewOfFile(block);
+        if (handle != -1)
+            CloseHandle(reinterpret_cast<HANDLE>(handle));
+    }
+}
+
+#else
+
+std::string QS::getTelemetrySegmentName(int slot)
+{
+    return "/qs_telemetry_" + std::to_string(slot);
+}
+
+bool QS::isTelemetryEnabled()
+{
+    const char* value{ std::getenv(TELEMETRY_ENVIRONMENT_VARIABLE) };
+    return value && *value && std::strcmp(value, "0") != 0;
+}
+
+namespace
+{
+    std::int64_t getProcessId()
+    {
+        return static_cast<std::int64_t>(getpid());
+    }
+
+    // The lock goes away with its descriptor, a crashed owner frees the slot
+    std::intptr_t claimSlot(const std::string& name)
+    {
+        int fd{ shm_open(name.c_str(), O_CREAT | O_RDWR, 0644) };
+        if (fd == -1)
+            return -1;
+
+        if (flock(fd, LOCK_EX | LOCK_NB) == -1)
+        {
+            close(fd);
+            return -1;
+        }
+        return fd;
+    }
+
+    void releaseSlot(std::intptr_t claim)
+    {
+        close(static_cast<int>(claim));
+    }
+
+    // The segment outlives the process, so the last state of a finished or
+    // crashed run stays readable until the slot is taken again
+    QS::TelemetryBlock* createSegment(const std::string& name, std::intptr_t& handle)
+    {
+        int fd{ shm_open(name.c_str(), O_CREAT | O_RDWR, 0644) };
+        if (fd == -1)
+            return nullptr;
+
+        if (ftruncate(fd, sizeof(QS::TelemetryBlock)) == -1)
+        {
+            close(fd);
+            return nullptr;
+        }
+
+        void* data{ mmap(nullptr, sizeof(QS::TelemetryBlock), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) };
+        close(fd);
+        if (data == MAP_FAILED)
+            return nullptr;
+        handle = 0;
+        return static_cast<QS::TelemetryBlock*>(data);
+    }
+
+    const QS::TelemetryBlock* openSegment(const std::string& name, std::intptr_t& handle)
+    {
+        int fd{ shm_open(name.c_str(), O_RDONLY, 0) };
+        if (fd == -1)
+            return nullptr;
+
+        struct stat status{};
+        if (fstat(fd, &status) == -1 || status.st_size < static_cast<off_t>(sizeof(QS::TelemetryBlock)))
+        {
+            close(fd);
+            return nullptr;
+        }
+
+        void* data{ mmap(nullptr, sizeof(QS::TelemetryBlock), PROT_READ, MAP_SHARED, fd, 0) };
+        close(fd);
+        if (data == MAP_FAILED)
+            return nullptr;
+        handle = 0;
+        return static_cast<const QS::TelemetryBlock*>(data);
+    }
+
+    void closeSegment(const QS::TelemetryBlock* block, std::intptr_t)
+    {
+        if (block)
+            munmap(const_cast<QS::TelemetryBlock*>(block), sizeof(QS::TelemetryBlock));
+    }
+}
+
+#endif
+
+QS::TelemetryPublisher::TelemetryPublisher(int slot):
+    publishedTime_(std::chrono::steady_clock::now())
+{
+    if (!isTelemetryEnabled())
+        return;
+
+    auto name{ getTelemetrySegmentName(slot) };
+    claim_ = claimSlot(name);
+    if (claim_ == -1)
+        return;
+
+    block_ = createSegment(name, handle_);
+    if (!block_)
+    {
+        releaseSlot(claim_);
+        return;
+    }
+
+    // The sequence of a reused segment carries on, rounded up to even in case
+    // its last writer died in the middle of a publication
+    auto sequence{ block_->sequence.load(std::memory_order_relaxed) };
+    block_->sequence.store(sequence + (sequence & 1), std::memory_order_release);
+    block_->magic = TELEMETRY_MAGIC;
+    block_->version = TELEMETRY_VERSION;
+    snapshot_.processId = getProcessId();
+    publish();
+}
+
+QS::TelemetryPublisher::~TelemetryPublisher()
+{
+    if (!block_)
+        return;
+
+    snapshot_.finished = 1;
+    publish();
+    closeSegment(block_, handle_);
+    releaseSlot(claim_);
+}
+
+bool QS::TelemetryPublisher::isOpen() const
+{
+    return block_;
+}
+
+QS::TelemetrySnapshot& QS::TelemetryPublisher::getSnapshot()
+{
+    return snapshot_;
+}
+
+void QS::TelemetryPublisher::publish()
+{
+    if (!block_)
+        return;
+
+    auto now{ std::chrono::steady_clock::now() };
+    std::chrono::duration<double> elapsed{ now - publishedTime_ };
+    if (elapsed.count() > 0.0 && snapshot_.eventsCount > publishedEventsCount_)
+    {
+        snapshot_.eventsPerSecond = (snapshot_.eventsCount - publishedEventsCount_) / elapsed.count();
+        publishedEventsCount_ = snapshot_.eventsCount;
+        publishedTime_ = now;
+    }
+    snapshot_.updateTime = getEpochMilliseconds();
+
+    storeSnapshot(*block_, snapshot_);
+}
+
+QS::TelemetryReader::TelemetryReader(int slot)
+{
+    block_ = openSegment(getTelemetrySegmentName(slot), handle_);
+}
+
+QS::TelemetryReader::~TelemetryReader()
+{
+    closeSegment(block_, handle_);
+}
+
+bool QS::TelemetryReader::isOpen() const
+{
+    return block_;
+}
+
+bool QS::TelemetryReader::read(TelemetrySnapshot& snapshot) const
+{
+    return block_ && loadSnapshot(*block_, snapshot);
+}
+
+int QS::runTelemetryTop(std::ostream& out, int slotsCount, int refreshesCount)
+{
+    for (int refresh{}; !refreshesCount || refresh < refreshesCount; ++refresh)
+    {
+        // Clear the screen and go home, as top redraws in place
+        out << "\x1b[2J\x1b[H";
+        out << std::left << std::setw(6) << "slot" << std::setw(9) << "pid" << std::setw(9) << "state"
+            << std::setw(19) << "sweep point" << std::setw(21) << "requests"
+            << std::setw(13) << "events/s" << std::setw(12) << "rejection" << "workload\n";
+
+        auto now{ getEpochMilliseconds() };
+        for (int slot{}; slot < slotsCount; ++slot)
+        {
+            // Reopened every time, a slot may appear or be recreated between refreshes
+            TelemetryReader reader{ slot };
+            TelemetrySnapshot snapshot{};
+            out << std::setw(6) << slot;
+            if (!reader.read(snapshot))
+            {
+                out << "-\n";
+                continue;
+            }
+
+            const char* state{ snapshot.finished ? "done" :
+                now - snapshot.updateTime > STALE_AFTER_MS ? "stale" : "running" };
+            out << std::setw(9) << snapshot.processId << std::setw(9) << state
+                << std::setw(19) << (std::to_string(snapshot.sweepPoint) + " [" +
+                    std::to_string(snapshot.sweepBegin) + ", " + std::to_string(snapshot.sweepEnd) + ")")
+                << std::setw(21) << (std::to_string(snapshot.requestsCount) + " / " +
+                    std::to_string(snapshot.requestsLimit))
+                << std::setw(13) << std::fixed << std::setprecision(0) << snapshot.eventsPerSecond
+                << std::setw(12) << std::setprecision(5) << snapshot.rejectionProbability
+                << std::setprecision(5) << snapshot.workload << '\n';
+            out.unsetf(std::ios::fixed);
+        }
+        out.flush();
+
+        if (refreshesCount && refresh + 1 == refreshesCount)
+            break;
+        std::this_thread::sleep_for(TELEMETRY_REFRESH_INTERVAL);
+    }
+    return 0;
+}
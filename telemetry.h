@@ -0,0 +1,111 @@
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include <atomic>
+#include <string>
+#include <chrono>
+#include <ostream>
+#include <cstdint>
+
+namespace QueueingSystem
+{
+    inline constexpr const char* TELEMETRY_TOP_FLAG{ "--telemetry-top" };
+    inline constexpr std::uint32_t TELEMETRY_MAGIC{ 0x4D545351 }; // "QSTM"
+    inline constexpr std::uint32_t TELEMETRY_VERSION{ 1 };
+    // Events simulated between two publications
+    inline constexpr long long TELEMETRY_PUBLISH_PERIOD{ 1 << 14 };
+    inline constexpr std::chrono::milliseconds TELEMETRY_REFRESH_INTERVAL{ 1000 };
+    inline constexpr const char* TELEMETRY_ENVIRONMENT_VARIABLE{ "QS_TELEMETRY" };
+
+    // Slot 0 belongs to the coordinator or a single-process sweep, sweep
+    // worker or simulation service worker w publishes in slot w + 1
+    std::string getTelemetrySegmentName(int slot);
+
+    // Publishing is opt-in: TELEMETRY_ENVIRONMENT_VARIABLE set to anything but 0
+    bool isTelemetryEnabled();
+
+    // Every field is 8 bytes wide, so the snapshot copies word by word
+    struct TelemetrySnapshot
+    {
+        std::int64_t processId{};
+        std::int64_t sweepPoint{};
+        std::int64_t sweepBegin{};
+        std::int64_t sweepEnd{};
+        std::int64_t requestsCount{};
+        std::int64_t requestsLimit{};
+        std::int64_t eventsCount{};
+        double eventsPerSecond{};
+        double rejectionProbability{};
+        double workload{};
+        // Milliseconds since the epoch, tells a segment left by a dead process
+        std::int64_t updateTime{};
+        std::int64_t finished{};
+    };
+
+    inline constexpr int TELEMETRY_WORDS_COUNT{ sizeof(TelemetrySnapshot) / sizeof(std::uint64_t) };
+
+    // Layout of the shared segment. A seqlock: the writer makes the sequence
+    // odd, stores the words and makes it even again; a reader copies the
+    // words between two loads of the same even sequence, or retries. The
+    // words are relaxed atomics, so a torn copy is detected, never undefined.
+    struct TelemetryBlock
+    {
+        std::uint32_t magic;
+        std::uint32_t version;
+        std::atomic<std::uint64_t> sequence;
+        std::atomic<std::uint64_t> words[TELEMETRY_WORDS_COUNT];
+    };
+
+    // Writes never wait on readers. A slot has a single publisher across the
+    // processes, the publisher of a slot already claimed stays closed like
+    // one whose segment cannot be created or one created with telemetry
+    // disabled: publish does nothing and the run goes on unobserved.
+    class TelemetryPublisher
+    {
+    public:
+        explicit TelemetryPublisher(int slot);
+        ~TelemetryPublisher();
+
+        TelemetryPublisher(const TelemetryPublisher&) = delete;
+        TelemetryPublisher& operator=(const TelemetryPublisher&) = delete;
+
+        bool isOpen() const;
+
+        // Filled by the simulation between publications
+        TelemetrySnapshot& getSnapshot();
+        // Adds the process, the rate of events since the last publication and the time
+        void publish();
+
+    private:
+        TelemetryBlock* block_{};
+        std::intptr_t handle_{ -1 };
+        std::intptr_t claim_{ -1 };
+        TelemetrySnapshot snapshot_{};
+        std::int64_t publishedEventsCount_{};
+        std::chrono::steady_clock::time_point publishedTime_{};
+    };
+
+    class TelemetryReader
+    {
+    public:
+        explicit TelemetryReader(int slot);
+        ~TelemetryReader();
+
+        TelemetryReader(const TelemetryReader&) = delete;
+        TelemetryReader& operator=(const TelemetryReader&) = delete;
+
+        bool isOpen() const;
+        // False for a segment of another layout or one that kept changing
+        bool read(TelemetrySnapshot& snapshot) const;
+
+    private:
+        const TelemetryBlock* block_{};
+        std::intptr_t handle_{ -1 };
+    };
+
+    // Table of the slots up to slotsCount refreshed in place, like top;
+    // refreshesCount 0 refreshes until the process is stopped
+    int runTelemetryTop(std::ostream& out, int slotsCount, int refreshesCount = 0);
+}
+
+#endif
@@ -0,0 +1,117 @@
+#include "time_windows.h"
+
+namespace QS = QueueingSystem;
+
+double QS::TimeWindow::getRejectionRate() const
+{
+    return arrivalsCount ? static_cast<double>(rejectionsCount) / arrivalsCount : 0.0;
+}
+
+double QS::TimeWindow::getUtilization(int devicesCount) const
+{
+    return duration > 0.0 ? busyTime / (duration * devicesCount) : 0.0;
+}
+
+double QS::TimeWindow::getMeanOccupancy() const
+{
+    return duration > 0.0 ? occupancyTime / duration : 0.0;
+}
+
+QS::TimeWindowSeries::TimeWindowSeries(int capacity):
+    capacity_(capacity)
+{
+    windows_.reserve(capacity);
+    reset();
+}
+
+void QS::TimeWindowSeries::reset()
+{
+    windows_.assign(1, TimeWindow{});
+    windowWidth_ = 0.0;
+    time_ = 0.0;
+    busyDevicesCount_ = 0;
+    bufferOccupancy_ = 0;
+}
+
+void QS::TimeWindowSeries::setLevels(double time, int busyDevicesCount, int bufferOccupancy)
+{
+    advance(time);
+    busyDevicesCount_ = busyDevicesCount;
+    bufferOccupancy_ = bufferOccupancy;
+}
+
+void QS::TimeWindowSeries::addArrival(double time, bool rejection)
+{
+    advance(time);
+    auto& window{ windows_.back() };
+    ++window.arrivalsCount;
+    if (rejection)
+        ++window.rejectionsCount;
+
+    // Until the width is known the first window stays open
+    if (windowWidth_ == 0.0 && window.arrivalsCount >= TIME_WINDOW_ARRIVALS && time > 0.0)
+        windowWidth_ = time;
+}
+
+double QS::TimeWindowSeries::getWindowWidth() const
+{
+    return windowWidth_;
+}
+
+const std::vector<QS::TimeWindow>& QS::TimeWindowSeries::getWindows() const
+{
+    return windows_;
+}
+
+void QS::TimeWindowSeries::advance(double time)
+{
+    while (true)
+    {
+        auto& window{ windows_.back() };
+        double windowEnd{ window.start + windowWidth_ };
+        bool inWindow{ windowWidth_ == 0.0 || time < windowEnd };
+        double end{ inWindow ? time : windowEnd };
+
+        window.busyTime += busyDevicesCount_ * (end - time_);
+        window.occupancyTime += bufferOccupancy_ * (end - time_);
+        window.duration += end - time_;
+        time_ = end;
+        if (inWindow)
+            return;
+
+        if (static_cast<int>(windows_.size()) == capacity_)
+            decimate();
+        windows_.push_back(TimeWindow{ windowEnd });
+    }
+}
+
+void QS::TimeWindowSeries::decimate()
+{
+    // Windows start on multiples of the width, so the merged ones start on
+    // multiples of the doubled width
+    int merged{ static_cast<int>(windows_.size()) / 2 };
+    for (int i{ 0 }; i < merged; ++i)
+    {
+        const auto& first{ windows_[2 * i] };
+        const auto& second{ windows_[2 * i + 1] };
+        windows_[i] = TimeWindow{
+            first.start,
+            first.duration + second.duration,
+            first.arrivalsCount + second.arrivalsCount,
+            first.rejectionsCount + second.rejectionsCount,
+            first.busyTime + second.busyTime,
+            first.occupancyTime + second.occupancyTime
+        };
+    }
+    windows_.resize(merged);
+    windowWidth_ *= 2.0;
+}
+
+void QS::writeTimeWindowsCsv(std::ostream& out, const std::vector<TimeWindow>& windows, int devicesCount)
+{
+    out << "start,duration,arrivals,rejections,rejection_rate,utilization,mean_buffer_occupancy\n";
+    for (const auto& window : windows)
+        out << window.start << ',' << window.duration << ',' << window.arrivalsCount << ',' <<
+            window.rejectionsCount << ',' << window.getRejectionRate() << ',' <<
+            window.getUtilization(devicesCount) << ',' << window.getMeanOccupancy() << '\n';
+}
@@ -0,0 +1,64 @@
+#ifndef TIME_WINDOWS_H
+#define TIME_WINDOWS_H
+
+#include <vector>
+#include <ostream>
+
+namespace QueueingSystem
+{
+    inline constexpr int TIME_WINDOWS_CAPACITY{ 512 };
+    // The window width is the time the first arrivals took
+    inline constexpr int TIME_WINDOW_ARRIVALS{ 100 };
+    inline constexpr const char* TIME_WINDOWS_CSV_PATH{ "time_windows.csv" };
+
+    // Sums over a span of the model time; the busy and the occupancy time are
+    // integrals of the busy devices count and of the buffer occupancy
+    struct TimeWindow
+    {
+        double start{};
+        double duration{};
+        long long arrivalsCount{};
+        long long rejectionsCount{};
+        double busyTime{};
+        double occupancyTime{};
+
+        double getRejectionRate() const;
+        double getUtilization(int devicesCount) const;
+        double getMeanOccupancy() const;
+    };
+
+    // Consecutive windows of one width over the run, the last one in
+    // progress. A full series merges neighbouring windows and doubles the
+    // width, as BatchedSeries does with its batches, so the windows keep
+    // covering the whole run evenly and memory stays bounded on any length.
+    class TimeWindowSeries
+    {
+    public:
+        explicit TimeWindowSeries(int capacity = TIME_WINDOWS_CAPACITY);
+
+        void reset();
+
+        // Levels in force from time on
+        void setLevels(double time, int busyDevicesCount, int bufferOccupancy);
+        void addArrival(double time, bool rejection);
+
+        double getWindowWidth() const;
+        const std::vector<TimeWindow>& getWindows() const;
+
+    private:
+        // Integrates the levels up to time, opening the windows it reaches
+        void advance(double time);
+        void decimate();
+
+        std::vector<TimeWindow> windows_;
+        int capacity_;
+        double windowWidth_{};
+        double time_{};
+        int busyDevicesCount_{};
+        int bufferOccupancy_{};
+    };
+
+    void writeTimeWindowsCsv(std::ostream& out, const std::vector<TimeWindow>& windows, int devicesCount);
+}
+
+#endif
@@ -0,0 +1,263 @@
+#include "trace.h"
+
+#include <fstream>
+#include <string>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <stdexcept>
+#include <cstdlib>
+#include <cstring>
+#include <cctype>
+#include <utility>
+
+namespace QS = QueueingSystem;
+namespace fs = std::filesystem;
+
+namespace
+{
+    struct TraceRecord
+    {
+        double time{};
+        long sourceId{};
+    };
+
+    bool parseTraceRecord(const std::string& line, TraceRecord& record)
+    {
+        const char* begin{ line.c_str() };
+        char* end{};
+
+        record.time = std::strtod(begin, &end);
+        if (end == begin)
+            return false;
+
+        while (*end == ',' || *end == ';' || std::isspace(static_cast<unsigned char>(*end)))
+            ++end;
+
+        begin = end;
+        record.sourceId = std::strtol(begin, &end, 10);
+        return end != begin && record.sourceId >= 0;
+    }
+
+    template <class Handler>
+    void readCsvTrace(const fs::path& csvPath, Handler handler)
+    {
+        std::ifstream in{ csvPath };
+        if (!in)
+            throw std::runtime_error{ "Cannot open " + csvPath.string() };
+
+        std::string line{};
+        long long lineNumber{};
+        TraceRecord record{};
+        while (std::getline(in, line))
+        {
+            ++lineNumber;
+            if (line.find_first_not_of(" \t\r") == std::string::npos)
+                continue;
+
+            if (!parseTraceRecord(line, record))
+            {
+                if (lineNumber == 1)
+                    continue;
+                throw std::invalid_argument{ csvPath.string() + ':' + std::to_string(lineNumber) +
+                    ": expected \"time,sourceId\"" };
+            }
+
+            handler(record, lineNumber);
+        }
+    }
+
+    std::size_t getTimesOffset(std::uint32_t sourcesCount)
+    {
+        return sizeof(QS::TraceHeader) + (static_cast<std::size_t>(sourcesCount) + 1) * sizeof(std::uint64_t);
+    }
+}
+
+QS::TraceFile::TraceFile(const fs::path& path):
+    file_(path)
+{
+    if (file_.getSize() < sizeof(TraceHeader))
+        throw std::runtime_error{ "Invalid trace file " + path.string() };
+
+    header_ = reinterpret_cast<const TraceHeader*>(file_.getData());
+    offsets_ = reinterpret_cast<const std::uint64_t*>(header_ + 1);
+    times_ = reinterpret_cast<const double*>(file_.getData() + getTimesOffset(header_->sourcesCount));
+
+    if (std::memcmp(header_->magic, TRACE_MAGIC, sizeof(TRACE_MAGIC)) ||
+        file_.getSize() < getTimesOffset(header_->sourcesCount) ||
+        file_.getSize() != getTimesOffset(header_->sourcesCount) + getRecordsCount() * sizeof(double))
+        throw std::runtime_error{ "Invalid trace file " + path.string() };
+
+    // The offsets are checked here, the times as the sources read them, so
+    // opening a trace does not read it through
+    if (offsets_[0] != 0 || !std::is_sorted(offsets_, offsets_ + header_->sourcesCount + 1))
+        throw std::runtime_error{ "Invalid trace file " + path.string() };
+    if (!header_->sourcesCount || !getRecordsCount())
+        throw std::runtime_error{ "Empty trace file " + path.string() };
+
+    file_.adviseSequential();
+}
+
+int QS::TraceFile::getSourcesCount() const
+{
+    return static_cast<int>(header_->sourcesCount);
+}
+
+std::int64_t QS::TraceFile::getRecordsCount() const
+{
+    return static_cast<std::int64_t>(offsets_[header_->sourcesCount]);
+}
+
+std::int64_t QS::TraceFile::getSourceRecordsCount(int sourceId) const
+{
+    return static_cast<std::int64_t>(offsets_[sourceId + 1] - offsets_[sourceId]);
+}
+
+double QS::TraceFile::getArrivalTime(int sourceId, std::int64_t recordIndex) const
+{
+    return times_[offsets_[sourceId] + recordIndex] - header_->startTime;
+}
+
+void QS::TraceFile::prefetch(int sourceId, std::int64_t recordIndex) const
+{
+    constexpr std::size_t windowSize{ TRACE_PREFETCH_RECORDS * sizeof(double) };
+
+    std::size_t offset{ getTimesOffset(header_->sourcesCount) +
+        (offsets_[sourceId] + recordIndex) * sizeof(double) };
+    std::size_t sourceBegin{ getTimesOffset(header_->sourcesCount) + offsets_[sourceId] * sizeof(double) };
+    std::size_t sourceEnd{ getTimesOffset(header_->sourcesCount) + offsets_[sourceId + 1] * sizeof(double) };
+
+    file_.prefetch(offset, std::min(2 * windowSize, sourceEnd - offset));
+    if (offset >= sourceBegin + windowSize)
+        file_.release(offset - windowSize, windowSize);
+}
+
+void QS::convertCsvTrace(const fs::path& csvPath, const fs::path& tracePath)
+{
+    std::vector<std::uint64_t> counts{};
+    std::vector<double> lastTimes{};
+    double startTime{ std::numeric_limits<double>::infinity() };
+
+    readCsvTrace(csvPath, [&](const TraceRecord& record, long long lineNumber)
+        {
+            if (record.sourceId >= static_cast<long>(counts.size()))
+            {
+                counts.resize(record.sourceId + 1, 0);
+                lastTimes.resize(record.sourceId + 1, -std::numeric_limits<double>::infinity());
+            }
+
+            if (record.time < lastTimes[record.sourceId])
+                throw std::invalid_argument{ csvPath.string() + ':' + std::to_string(lineNumber) +
+                    ": arrival times of a source must not decrease" };
+
+            lastTimes[record.sourceId] = record.time;
+            ++counts[record.sourceId];
+            startTime = std::min(startTime, record.time);
+        });
+
+    TraceHeader header{};
+    std::memcpy(header.magic, TRACE_MAGIC, sizeof(TRACE_MAGIC));
+    header.sourcesCount = static_cast<std::uint32_t>(counts.size());
+    header.startTime = counts.empty() ? 0.0 : startTime;
+
+    std::vector<std::uint64_t> offsets(counts.size() + 1, 0);
+    for (std::size_t i{ 0 }; i < counts.size(); ++i)
+        offsets[i + 1] = offsets[i] + counts[i];
+
+    {
+        std::ofstream out{ tracePath, std::ios::binary | std::ios::trunc };
+        if (!out)
+            throw std::runtime_error{ "Cannot create " + tracePath.string() };
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(std::uint64_t));
+    }
+    fs::resize_file(tracePath, getTimesOffset(header.sourcesCount) + offsets.back() * sizeof(double));
+
+    if (!offsets.back())
+        return;
+
+    MappedFile file{ tracePath, MappingMode::readWrite };
+    auto times{ reinterpret_cast<double*>(file.getData() + getTimesOffset(header.sourcesCount)) };
+
+    auto cursors{ offsets };
+    readCsvTrace(csvPath, [&](const TraceRecord& record, long long)
+        {
+            times[cursors[record.sourceId]++] = record.time;
+        });
+}
+
+QS::STraceFile QS::openTrace(const fs::path& path)
+{
+    if (path.extension() != ".csv")
+        return std::make_shared<const TraceFile>(path);
+
+    auto tracePath{ fs::path{ path }.replace_extension(".qstrace") };
+    if (!fs::exists(tracePath) || fs::last_write_time(tracePath) < fs::last_write_time(path))
+        convertCsvTrace(path, tracePath);
+
+    return std::make_shared<const TraceFile>(tracePath);
+}
+
+QS::TraceSource::TraceSource(int sourceId, STraceFile trace):
+    Source(sourceId),
+    trace_(std::move(trace))
+{
+    readNextGenerationTime();
+}
+
+std::unique_ptr<QS::Request> QS::TraceSource::generateRequest()
+{
+    Request newRequest{
+        RequestId{
+            sourceId_,
+            requestsCount_++
+        },
+        nextGenerationTime_
+    };
+
+    ++recordIndex_;
+    readNextGenerationTime();
+
+    return std::make_unique<Request>(newRequest);
+}
+
+void QS::TraceSource::reset()
+{
+    requestsCount_ = 0;
+    recordIndex_ = 0;
+    readNextGenerationTime();
+}
+
+QS::SourceState QS::TraceSource::getState() const
+{
+    // Arrivals come from the trace, the generator is not used
+    SourceState state{};
+    state.nextGenerationTime = nextGenerationTime_;
+    state.requestsCount = requestsCount_;
+    state.recordIndex = recordIndex_;
+    return state;
+}
+
+void QS::TraceSource::restore(const SourceState& state)
+{
+    nextGenerationTime_ = state.nextGenerationTime;
+    requestsCount_ = state.requestsCount;
+    recordIndex_ = state.recordIndex;
+}
+
+void QS::TraceSource::readNextGenerationTime()
+{
+    if (recordIndex_ >= trace_->getSourceRecordsCount(sourceId_))
+    {
+        nextGenerationTime_ = std::numeric_limits<double>::infinity();
+        return;
+    }
+
+    if (recordIndex_ % TRACE_PREFETCH_RECORDS == 0)
+        trace_->prefetch(sourceId_, recordIndex_);
+
+    double lastTime{ recordIndex_ ? nextGenerationTime_ : 0.0 };
+    nextGenerationTime_ = trace_->getArrivalTime(sourceId_, recordIndex_);
+    if (!(nextGenerationTime_ >= lastTime))
+        throw std::runtime_error{ "Arrival times of trace source " + std::to_string(sourceId_) + " decrease" };
+}
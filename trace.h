@@ -0,0 +1,83 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "source.h"
+#include "mapped_file.h"
+
+#include <filesystem>
+#include <memory>
+#include <cstdint>
+
+namespace QueueingSystem
+{
+    inline constexpr char TRACE_MAGIC[8]{ 'Q', 'S', 'T', 'R', 'A', 'C', 'E', '1' };
+    inline constexpr std::int64_t TRACE_PREFETCH_RECORDS{ 1 << 16 };
+
+    // Binary trace layout: TraceHeader, sourcesCount + 1 record offsets, then the
+    // ascending arrival times of every source stored source after source, so
+    // each source reads its own segment sequentially.
+    struct TraceHeader
+    {
+        char magic[8];
+        std::uint32_t sourcesCount;
+        std::uint32_t reserved;
+        double startTime;
+    };
+
+    class TraceFile
+    {
+    public:
+        // Throws std::runtime_error for an empty trace or one whose offsets
+        // do not ascend; the times are checked by TraceSource as it reads them
+        explicit TraceFile(const std::filesystem::path& path);
+
+        int getSourcesCount() const;
+        std::int64_t getRecordsCount() const;
+        std::int64_t getSourceRecordsCount(int sourceId) const;
+
+        // Arrival time counted from the first arrival of the trace
+        double getArrivalTime(int sourceId, std::int64_t recordIndex) const;
+
+        // Loads the window after recordIndex and drops the one before it
+        void prefetch(int sourceId, std::int64_t recordIndex) const;
+
+    private:
+        MappedFile file_;
+        const TraceHeader* header_{};
+        const std::uint64_t* offsets_{};
+        const double* times_{};
+    };
+
+    using STraceFile = std::shared_ptr<const TraceFile>;
+
+    // CSV lines are "time,sourceId" with times ascending within every source,
+    // a non-numeric first line is taken as a header. Two passes over the CSV,
+    // so it is never loaded into memory as a whole.
+    void convertCsvTrace(const std::filesystem::path& csvPath, const std::filesystem::path& tracePath);
+
+    // Opens a binary trace; a .csv path is converted next to it first
+    STraceFile openTrace(const std::filesystem::path& path);
+
+    // Throws std::runtime_error on reading an arrival time earlier than the
+    // one before it
+    class TraceSource : public Source
+    {
+    public:
+        TraceSource(int sourceId, STraceFile trace);
+
+        URequest generateRequest() override;
+
+        void reset() override;
+
+        SourceState getState() const override;
+        void restore(const SourceState& state) override;
+
+    private:
+        void readNextGenerationTime();
+
+        STraceFile trace_;
+        std::int64_t recordIndex_{};
+    };
+}
+
+#endif